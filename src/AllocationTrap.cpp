@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    AllocationTrap.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Catches heap allocations made on the audio thread
+
+  ==============================================================================
+*/
+
+#include "AllocationTrap.h"
+
+#include <cstdlib>
+#include <new>
+
+#if SAMPLER_ALLOCATION_TRAP && JUCE_MSVC && defined(_DEBUG)
+ #include <crtdbg.h>
+#endif
+
+//==============================================================================
+#if SAMPLER_ALLOCATION_TRAP
+
+namespace
+{
+    void noteAllocation()
+    {
+        if (! AllocationTrap::isInRealtimeSection())
+            return;
+
+        AllocationTrap::numTrapped.fetch_add(1, std::memory_order_relaxed);
+
+        if (AllocationTrap::assertsEnabled.load(std::memory_order_relaxed))
+        {
+            // The assertion's own logging allocates
+            const AllocationTrap::ScopedSuspend suspend;
+            jassertfalse;  // Heap allocation on the audio thread: see the call stack
+        }
+    }
+}
+
+#if defined(__GLIBC__)
+
+//==============================================================================
+// glibc lets the executable interpose the malloc family, and libstdc++'s
+// operator new allocates through malloc, so these four see everything:
+// new, HeapBlock, and the JUCE containers built on it. The real allocator is
+// still reached through glibc's own entry points.
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* p, size_t size);
+    void __libc_free(void* p);
+
+    void* malloc(size_t size) noexcept
+    {
+        noteAllocation();
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) noexcept
+    {
+        noteAllocation();
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* p, size_t size) noexcept
+    {
+        noteAllocation();
+        return __libc_realloc(p, size);
+    }
+
+    void free(void* p) noexcept { __libc_free(p); }
+}
+
+bool AllocationTrap::isWatchingMalloc() noexcept { return true; }
+
+#elif JUCE_MSVC && defined(_DEBUG)
+
+//==============================================================================
+// The debug CRT calls a hook before every allocation and reallocation, and
+// operator new goes through the same heap, so the hook sees everything. The
+// release CRT has no such hook, which is why the trap is a Debug build tool
+// on Windows.
+namespace
+{
+    _CRT_ALLOC_HOOK previousHook = nullptr;
+
+    int __cdecl allocationHook(int allocType, void* userData, size_t size, int blockType,
+                               long requestNumber, const unsigned char* fileName, int lineNumber)
+    {
+        if (allocType != _HOOK_FREE)
+            noteAllocation();
+
+        return previousHook != nullptr
+                 ? previousHook(allocType, userData, size, blockType, requestNumber, fileName, lineNumber)
+                 : TRUE;
+    }
+
+    const struct HookInstaller
+    {
+        HookInstaller() { previousHook = _CrtSetAllocHook(allocationHook); }
+    } hookInstaller;
+}
+
+bool AllocationTrap::isWatchingMalloc() noexcept { return true; }
+
+#else
+
+//==============================================================================
+// No allocator hook to use here (macOS, or a release CRT), so only
+// operator new is replaced; the array and nothrow forms call it. HeapBlock,
+// and the containers built on it, use malloc directly and go unseen.
+// Aligned allocations keep the library's own, since nothing on the audio
+// thread makes them.
+void* operator new(std::size_t size)
+{
+    noteAllocation();
+
+    if (auto* p = std::malloc(size != 0 ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+bool AllocationTrap::isWatchingMalloc() noexcept { return false; }
+
+#endif
+
+#else
+
+bool AllocationTrap::isWatchingMalloc() noexcept { return false; }
+
+#endif
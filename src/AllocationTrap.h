@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    AllocationTrap.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Catches heap allocations made on the audio thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+
+#include <atomic>
+
+// Build with SAMPLER_ALLOCATION_TRAP=1 (the CMake option of the same name)
+// to check every heap allocation: through the malloc family where the
+// platform lets us hook it (glibc, and the MSVC debug CRT), otherwise
+// through a replaced operator new only
+#ifndef SAMPLER_ALLOCATION_TRAP
+ #define SAMPLER_ALLOCATION_TRAP 0
+#endif
+
+//==============================================================================
+// The engine marks the code that runs on the audio thread, and on the render
+// pool's helpers, with a ScopedRealtimeSection. With the trap built in, any
+// heap allocation made inside a section is counted and stops at an assertion
+// in debug builds, so a run under load shows the engine allocation-free
+// rather than assuming it - as far as isWatchingMalloc says the trap can see.
+// Without the trap the sections cost a thread-local increment and nothing
+// checks them.
+namespace AllocationTrap
+{
+    inline thread_local int realtimeDepth = 0;
+    inline std::atomic<int64> numTrapped { 0 };
+    inline std::atomic<bool> assertsEnabled { true };
+
+    inline bool isInRealtimeSection() noexcept { return realtimeDepth > 0; }
+
+    // Allocations caught since the program started; always 0 without the trap
+    inline int64 getNumTrapped() noexcept { return numTrapped.load(std::memory_order_relaxed); }
+
+    // Count without stopping, for tools that report the total (the benchmark)
+    inline void setAssertsEnabled(bool shouldAssert) noexcept { assertsEnabled.store(shouldAssert, std::memory_order_relaxed); }
+
+    // True when malloc, calloc and realloc are checked too, and with them
+    // HeapBlock and every JUCE container that grows through it (Array,
+    // MidiBuffer, AudioBuffer::setSize). False means only operator new is
+    // seen, or the trap isn't built in.
+    bool isWatchingMalloc() noexcept;
+
+    struct ScopedRealtimeSection
+    {
+        ScopedRealtimeSection() noexcept { ++realtimeDepth; }
+        ~ScopedRealtimeSection() noexcept { --realtimeDepth; }
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedRealtimeSection)
+    };
+
+    // Lets a section allocate on purpose, e.g. to report what it caught
+    struct ScopedSuspend
+    {
+        ScopedSuspend() noexcept : savedDepth(realtimeDepth) { realtimeDepth = 0; }
+        ~ScopedSuspend() noexcept { realtimeDepth = savedDepth; }
+
+        const int savedDepth;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedSuspend)
+    };
+}
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    EngineSettings.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Per-instance engine parameters and the per-block snapshot voices read
+
+  ==============================================================================
+*/
+
+#include "EngineSettings.h"
+
+//==============================================================================
+namespace
+{
+    const StringArray modeNames { "One-Shot", "Gate", "Loop", "Toggle" };
+
+    String padModeId(int pad) { return "padMode" + String(pad + 1); }
+}
+
+EngineSettings::EngineSettings(AudioProcessor& processor)
+    : parameters(processor, nullptr, stateType, createLayout())
+{
+    defaultMode = dynamic_cast<AudioParameterChoice*>(parameters.getParameter("playMode"));
+    defaultModeValue = parameters.getRawParameterValue("playMode");
+
+    for (int pad = 0; pad < numPads; ++pad)
+    {
+        padModes[pad] = dynamic_cast<AudioParameterChoice*>(parameters.getParameter(padModeId(pad)));
+        padModeValues[pad] = parameters.getRawParameterValue(padModeId(pad));
+        padNotes[pad].store(PadLayout::getDefaultNote(pad));
+    }
+
+    jassert(defaultMode != nullptr && defaultModeValue != nullptr);
+}
+
+AudioProcessorValueTreeState::ParameterLayout EngineSettings::createLayout()
+{
+    AudioProcessorValueTreeState::ParameterLayout layout;
+
+    layout.add(std::make_unique<AudioParameterChoice>(ParameterID { "playMode", 1 }, "Play Mode", modeNames,
+                                                      static_cast<int>(PlaybackMode::oneShot)));
+
+    StringArray padChoices { "Kit" };
+    padChoices.addArray(modeNames);
+
+    for (int pad = 0; pad < numPads; ++pad)
+        layout.add(std::make_unique<AudioParameterChoice>(ParameterID { padModeId(pad), 1 },
+                                                          "Pad " + PadLayout::getPadName(pad) + " Mode", padChoices, 0));
+
+    return layout;
+}
+
+//==============================================================================
+void EngineSettings::setDefaultMode(PlaybackMode mode)
+{
+    *defaultMode = static_cast<int>(mode);
+}
+
+PlaybackMode EngineSettings::getDefaultMode() const noexcept
+{
+    return toMode(defaultModeValue->load(std::memory_order_relaxed));
+}
+
+void EngineSettings::setPadMode(int pad, PlaybackMode mode)
+{
+    if (isPositiveAndBelow(pad, numPads))
+        *padModes[pad] = static_cast<int>(mode) + 1;
+}
+
+void EngineSettings::clearPadMode(int pad)
+{
+    if (isPositiveAndBelow(pad, numPads))
+        *padModes[pad] = 0;
+}
+
+bool EngineSettings::hasPadMode(int pad) const noexcept
+{
+    return isPositiveAndBelow(pad, numPads) && padModeValues[pad]->load(std::memory_order_relaxed) >= 0.5f;
+}
+
+PlaybackMode EngineSettings::getPadMode(int pad) const noexcept
+{
+    return hasPadMode(pad) ? toMode(padModeValues[pad]->load(std::memory_order_relaxed) - 1.0f) : getDefaultMode();
+}
+
+void EngineSettings::setPadNote(int pad, int midiNote) noexcept
+{
+    if (isPositiveAndBelow(pad, numPads))
+        padNotes[pad].store(midiNote, std::memory_order_relaxed);
+}
+
+void EngineSettings::fillSnapshot(EngineSnapshot& snapshot) const noexcept
+{
+    const PlaybackMode kitMode = getDefaultMode();
+
+    for (auto& mode : snapshot.noteModes)
+        mode = kitMode;
+
+    for (int pad = 0; pad < numPads; ++pad)
+    {
+        const int note = padNotes[pad].load(std::memory_order_relaxed);
+
+        if (hasPadMode(pad) && isPositiveAndBelow(note, EngineSnapshot::numNotes))
+            snapshot.noteModes[note] = getPadMode(pad);
+    }
+}
+
+//==============================================================================
+std::unique_ptr<XmlElement> EngineSettings::createXml()
+{
+    return parameters.copyState().createXml();
+}
+
+void EngineSettings::restoreFromXml(const XmlElement& xml)
+{
+    if (isSettingsXml(xml))
+        parameters.replaceState(ValueTree::fromXml(xml));
+}
+
+String EngineSettings::modeToString(PlaybackMode mode)
+{
+    switch (mode)
+    {
+        case PlaybackMode::oneShot: return "oneShot";
+        case PlaybackMode::gate:    return "gate";
+        case PlaybackMode::loop:    return "loop";
+        case PlaybackMode::toggle:  return "toggle";
+    }
+
+    return "gate";
+}
+
+PlaybackMode EngineSettings::modeFromString(const String& name, PlaybackMode defaultMode)
+{
+    for (auto candidate : { PlaybackMode::oneShot, PlaybackMode::gate, PlaybackMode::loop, PlaybackMode::toggle })
+        if (name.equalsIgnoreCase(modeToString(candidate)))
+            return candidate;
+
+    return defaultMode;
+}
@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    EngineSettings.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Per-instance engine parameters and the per-block snapshot voices read
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+#include "PadLayout.h"
+
+#include <atomic>
+
+//==============================================================================
+// What a note does with its note-off
+enum class PlaybackMode : uint8
+{
+    oneShot = 0,    // Ignores note-off and plays to the end
+    gate,           // Plays while held, then releases
+    loop,           // Loops while held, then releases
+    toggle          // Ignores note-off; the next hit on the note releases it
+};
+
+// The settings the audio thread needs, copied once at the start of every
+// block. Voices and the synth read this copy, never the parameters, so a
+// change lands between blocks and costs nothing per voice.
+struct alignas(64) EngineSnapshot
+{
+    static constexpr int numNotes = 128;
+
+    PlaybackMode noteModes[numNotes] = {};
+
+    PlaybackMode getMode(int midiNote) const noexcept
+    {
+        return isPositiveAndBelow(midiNote, numNotes) ? noteModes[midiNote] : PlaybackMode::gate;
+    }
+};
+
+//==============================================================================
+// A SamplerPlugin's parameters, held in an AudioProcessorValueTreeState so
+// the host sees, automates and saves them: the kit's playback mode, and an
+// optional mode per pad that overrides it for the note the pad plays.
+// Notes without a pad use the kit's mode.
+//
+// Set from the message thread (or by the host); the audio thread only calls
+// fillSnapshot, which reads the parameters' atomic values.
+class EngineSettings
+{
+public:
+    static constexpr int numPads = PadLayout::numPads;
+
+    explicit EngineSettings(AudioProcessor& processor);
+
+    void setDefaultMode(PlaybackMode mode);
+    PlaybackMode getDefaultMode() const noexcept;
+
+    // A pad with no mode of its own follows the kit's
+    void setPadMode(int pad, PlaybackMode mode);
+    void clearPadMode(int pad);
+    bool hasPadMode(int pad) const noexcept;
+    PlaybackMode getPadMode(int pad) const noexcept;  // Its own mode, or the kit's
+
+    // Any thread: the note each pad plays, which its mode applies to
+    void setPadNote(int pad, int midiNote) noexcept;
+
+    // Audio thread, at the start of every block
+    void fillSnapshot(EngineSnapshot& snapshot) const noexcept;
+
+    // Parameter state for get/setStateInformation
+    std::unique_ptr<XmlElement> createXml();
+    void restoreFromXml(const XmlElement& xml);
+    static bool isSettingsXml(const XmlElement& xml) { return xml.hasTagName(stateType); }
+
+    static String modeToString(PlaybackMode mode);
+    static PlaybackMode modeFromString(const String& name, PlaybackMode defaultMode);
+
+private:
+    static constexpr const char* stateType = "EngineSettings";
+
+    static AudioProcessorValueTreeState::ParameterLayout createLayout();
+    static PlaybackMode toMode(float index) noexcept { return static_cast<PlaybackMode>(jlimit(0, 3, roundToInt(index))); }
+
+    AudioProcessorValueTreeState parameters;
+
+    AudioParameterChoice* defaultMode = nullptr;
+    AudioParameterChoice* padModes[numPads] = {};   // Choice 0 follows the kit, then the modes
+    std::atomic<float>* defaultModeValue = nullptr;
+    std::atomic<float>* padModeValues[numPads] = {};
+
+    std::atomic<int> padNotes[numPads];
+
+    JUCE_DECLARE_NON_COPYABLE(EngineSettings)
+};
@@ -13,25 +13,12 @@
 #include "juce.h"
 #include "SamplerPlugin.h"
 #include "SamplerEditor.h"
+#include "OfflineRender.h"
 
-// Debug logging to file (same directory as executable)
-static File getLogFile() { return File::getSpecialLocation(File::currentExecutableFile).getParentDirectory().getChildFile("debug.log"); }
-static void logMessage(const String& msg)
-{
-    File logFile = getLogFile();
-    logFile.appendText(Time::getCurrentTime().toString(true, true, true, true) + ": " + msg + "\n");
-}
-
-#define DEBUG_MIDI(msg) logMessage(msg)
+#include <iostream>
 
-//==============================================================================
-String getMidiNoteName(int noteNumber)
-{
-    static const char* notes[] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
-    int octave = noteNumber / 12 - 1;
-    int note = noteNumber % 12;
-    return String(notes[note]) + String(octave);
-}
+// Debug log file (same directory as executable), written by the SamplerLog writer thread
+static File getLogFile() { return File::getSpecialLocation(File::currentExecutableFile).getParentDirectory().getChildFile("debug.log"); }
 
 //==============================================================================
 class SettingsDialog : public DialogWindow
@@ -43,7 +30,7 @@ public:
         setContentOwned(new AudioDeviceSelectorComponent(
             dm,
             0, 2,
-            0, 2,
+            0, 2 * SamplerPlugin::numOutputBuses,
             true,
             true,
             true,
@@ -60,6 +47,146 @@ public:
     }
 };
 
+//==============================================================================
+// Headless batch rendering, started by --render on the command line: loads
+// the kit, waits for its samples to finish loading, renders the MIDI file on
+// a background thread and quits with 0 on success.
+class OfflineRenderJob : private Timer,
+                         private Thread
+{
+public:
+    explicit OfflineRenderJob(const ArgumentList& args)
+        : Thread("Offline Render")
+    {
+        auto file = [&args](const char* option)
+        {
+            const String path = args.getValueForOption(option);
+            return path.isNotEmpty() ? File::getCurrentWorkingDirectory().getChildFile(path) : File();
+        };
+
+        auto number = [&args](const char* option, double defaultValue)
+        {
+            const String text = args.getValueForOption(option);
+            return text.isNotEmpty() ? text.getDoubleValue() : defaultValue;
+        };
+
+        midiFile = file("--render");
+        kitFile = file("--kit");
+        outputFile = file("--output");
+
+        if (outputFile == File())
+            outputFile = midiFile.withFileExtension("wav");
+
+        settings.sampleRate = number("--sample-rate", settings.sampleRate);
+        settings.blockSize = static_cast<int>(number("--block-size", settings.blockSize));
+        settings.renderThreads = jlimit(0, VoiceRenderPool::maxWorkers, static_cast<int>(number("--render-threads", 0)));
+        settings.tailSeconds = number("--tail", settings.tailSeconds);
+        settings.bitsPerSample = static_cast<int>(number("--bits", settings.bitsPerSample));
+    }
+
+    ~OfflineRenderJob() override
+    {
+        stopTimer();
+        stopThread(10000);
+        editor.reset();
+    }
+
+    static bool isRenderCommand(const ArgumentList& args) { return args.containsOption("--render"); }
+
+    static void printUsage()
+    {
+        std::cout << "TostEngineJucePocketSampler --render=<midi file> --kit=<json|tskit> [options]\n"
+                     "  --output=<file>         .wav or .flac (default: the MIDI file's name as .wav)\n"
+                     "  --sample-rate=<hz>      Default: 48000\n"
+                     "  --block-size=<n>        Samples per processBlock (default: 512)\n"
+                     "  --render-threads=<n>    Parallel voice rendering helpers (default: 0)\n"
+                     "  --tail=<seconds>        Rendered after the last event (default: 2)\n"
+                     "  --bits=<n>              16, 24 or 32 (32 is float WAV; default: 24)\n";
+    }
+
+    // Loads the kit and starts rendering once it's in; false if that can't start
+    bool start()
+    {
+        if (!midiFile.existsAsFile() || !kitFile.existsAsFile())
+        {
+            std::cerr << "A MIDI file (--render) and a kit (--kit) are both needed\n";
+            printUsage();
+            return false;
+        }
+
+        plugin = std::make_unique<SamplerPlugin>();
+
+        // Decoded straight into memory: a render goes faster than the disk
+        // streamer's read-ahead is sized for
+        plugin->setStreamingThreshold(0);
+
+        plugin->setNonRealtime(true);
+        plugin->setPlayConfigDetails(0, 2, settings.sampleRate, settings.blockSize);
+        plugin->prepareToPlay(settings.sampleRate, settings.blockSize);
+
+        bool loaded = false;
+
+        if (SampleBundle::isBundleFile(kitFile))
+        {
+            loaded = plugin->loadBundle(kitFile);
+        }
+        else if (auto* samplerEditor = dynamic_cast<SamplerEditor*>(plugin->createEditorIfNeeded()))
+        {
+            // JSON kits are read by the editor, which owns that format
+            editor.reset(samplerEditor);
+            loaded = samplerEditor->loadKitFile(kitFile);
+        }
+
+        if (!loaded)
+        {
+            std::cerr << "Could not load kit " << kitFile.getFullPathName() << "\n";
+            return false;
+        }
+
+        std::cout << "Loading " << kitFile.getFileName() << "...\n";
+        startTimer(50);
+        return true;
+    }
+
+private:
+    void timerCallback() override
+    {
+        if (plugin->isLoadingSamples())
+            return;
+
+        stopTimer();
+        std::cout << "Rendering " << midiFile.getFileName() << " to " << outputFile.getFullPathName() << "...\n";
+        startThread();
+    }
+
+    void run() override
+    {
+        result = OfflineRender::render(*plugin, midiFile, outputFile, settings);
+        MessageManager::callAsync([this] { finish(); });
+    }
+
+    void finish()
+    {
+        if (result.succeeded)
+            std::cout << "Rendered " << String(result.audioSeconds, 2) << " s of audio in "
+                      << String(result.renderSeconds, 2) << " s (" << String(result.getRealtimeFactor(), 1) << "x real time)\n";
+        else
+            std::cerr << "Render failed: " << result.error << "\n";
+
+        JUCEApplication::getInstance()->setApplicationReturnValue(result.succeeded ? 0 : 1);
+        JUCEApplication::quit();
+    }
+
+    File midiFile, kitFile, outputFile;
+    OfflineRender::Settings settings;
+    OfflineRender::Result result;
+
+    std::unique_ptr<SamplerPlugin> plugin;
+    std::unique_ptr<AudioProcessorEditor> editor;  // Only for JSON kits; goes before the plugin
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineRenderJob)
+};
+
 //==============================================================================
 class SamplerApp : public JUCEApplication
 {
@@ -70,8 +197,28 @@ public:
     const String getApplicationVersion() override    { return "1.0.0"; }
     bool moreThanOneInstanceAllowed() override       { return true; }
 
-    void initialise(const String&) override
+    void initialise(const String& commandLine) override
     {
+        // Log level can be chosen at startup with --log-level=off|error|info|debug
+        auto levelArg = commandLine.fromFirstOccurrenceOf("--log-level=", false, false)
+                                   .upToFirstOccurrenceOf(" ", false, false)
+                                   .unquoted();
+        SamplerLog::setLevel(SamplerLog::levelFromString(levelArg, SamplerLog::getLevel()));
+        SamplerLog::start(getLogFile());
+
+        // Batch rendering: no window and no audio device
+        const ArgumentList args(getApplicationName(), getCommandLineParameterArray());
+        if (OfflineRenderJob::isRenderCommand(args))
+        {
+            renderJob = std::make_unique<OfflineRenderJob>(args);
+            if (!renderJob->start())
+            {
+                setApplicationReturnValue(1);
+                quit();
+            }
+            return;
+        }
+
         DEBUG_MIDI("SamplerApp::initialise - starting");
         deviceManager.initialiseWithDefaultDevices(0, 2);
 
@@ -84,9 +231,11 @@ public:
 
     void shutdown() override
     {
+        renderJob = nullptr;
         mainWindow = nullptr;
         deviceManager.closeAudioDevice();
         LookAndFeel::setDefaultLookAndFeel(nullptr);
+        SamplerLog::stop();
     }
 
     void systemRequestedQuit() override
@@ -101,7 +250,8 @@ public:
 
     class MainWindow : public DocumentWindow,
                        public MenuBarModel,
-                       public MidiInputCallback
+                       public MidiInputCallback,
+                       private ChangeListener
     {
     public:
         MainWindow(String name, AudioDeviceManager& dm)
@@ -121,16 +271,17 @@ public:
             {
                 editor = std::unique_ptr<AudioProcessorEditor>(editorPtr);
                 setContentOwned(editor.get(), true);
-                editor->setSize(500, 560);
+                editor->setSize(500, 600);
             }
 
-            // Prepare the plugin for playback (44100 Hz sample rate, 512 samples per block)
-            plugin->prepareToPlay(44100.0, 512);
-            DEBUG_MIDI("MainWindow: Plugin prepared for playback");
-
-            // Connect the plugin to the audio device for playback
+            // Connect the plugin to the audio device for playback. The player
+            // prepares it with the device's real sample rate and block size,
+            // and again every time the device restarts with new settings -
+            // which re-prepares the MIDI queue, voice pool and rate caches.
             processorPlayer.setProcessor(plugin.get());
             deviceManager.addAudioCallback(&processorPlayer);
+            deviceManager.addChangeListener(this);
+            logDeviceSetup();
             DEBUG_MIDI("MainWindow: Audio processor player connected");
 
             // Open all available MIDI input devices
@@ -143,6 +294,7 @@ public:
 
         ~MainWindow()
         {
+            deviceManager.removeChangeListener(this);
             setMenuBar(nullptr);
             closeAllDevices();
             closeSettings();
@@ -200,57 +352,30 @@ public:
             JUCEApplication::quit();
         }
 
-        // MidiInputCallback
+        // MidiInputCallback. Runs on the MIDI driver's thread, so it only
+        // hands the message on: to the audio thread first, then MIDI thru,
+        // then the editor's queue. Logging is a binary record formatted by
+        // the log writer; the editor does its UI work on its own timer.
         void handleIncomingMidiMessage(MidiInput* source, const MidiMessage& message) override
         {
-            DEBUG_MIDI("MainWindow::handleIncomingMidiMessage - received MIDI from: " + (source ? source->getName() : "unknown"));
+            (void)source;
 
-            if (message.isNoteOn())
-            {
-                DEBUG_MIDI("NOTE ON: ch=" + String(message.getChannel()) +
-                          " note=" + String(message.getNoteNumber()) +
-                          " (" + getMidiNoteName(message.getNoteNumber()) + ")" +
-                          " vel=" + String(int(message.getVelocity() * 127)));
-            }
-            else if (message.isNoteOff())
-            {
-                DEBUG_MIDI("NOTE OFF: ch=" + String(message.getChannel()) +
-                          " note=" + String(message.getNoteNumber()));
-            }
-            else if (message.isController())
-            {
-                DEBUG_MIDI("CONTROLLER: ch=" + String(message.getChannel()) +
-                          " ctrl=" + String(message.getControllerNumber()) +
-                          " val=" + String(message.getControllerValue()));
-            }
-            else if (message.isAftertouch())
-            {
-                DEBUG_MIDI("AFTERTOUCH: ch=" + String(message.getChannel()));
-            }
-            else
-            {
-                DEBUG_MIDI("OTHER MIDI: " + String(message.getRawDataSize()) + " bytes");
-            }
+            if (plugin == nullptr)
+                return;
 
-            if (plugin != nullptr)
-            {
-                plugin->getMidiCollector().addMessageToQueue(message);
+            plugin->getMidiInputQueue().addMessageToQueue(message);
 
-                // Update MIDI status display in editor
-                if (editor != nullptr)
-                {
-                    auto* samplerEditor = dynamic_cast<SamplerEditor*>(editor.get());
-                    if (samplerEditor != nullptr)
-                    {
-                        samplerEditor->getMidiStatus().showMidiMessage(message);
-                        samplerEditor->handleMidiMessage(message);
-                    }
-                }
+            if (midiOutput != nullptr)
+                midiOutput->sendMessageNow(message);
 
-                if (midiOutput != nullptr)
-                {
-                    midiOutput->sendMessageNow(message);
-                }
+            plugin->getMidiUiQueue().push(message);
+
+            if (message.getRawDataSize() <= 3)
+            {
+                const uint8* data = message.getRawData();
+                const int size = message.getRawDataSize();
+                SamplerLog::event(SamplerLog::Level::debug, SamplerLog::Event::midiIn,
+                                  data[0], size > 1 ? data[1] : 0, size > 2 ? data[2] : 0);
             }
         }
 
@@ -269,6 +394,87 @@ public:
                 settingsItem.action = [this]() { showSettings(); };
                 menu.addItem(settingsItem);
 
+                PopupMenu::Item lowLatencyItem("Low-Latency Mode");
+                lowLatencyItem.setTicked(lowLatencyMode);
+                lowLatencyItem.action = [this]() { setLowLatencyMode(!lowLatencyMode); };
+                menu.addItem(lowLatencyItem);
+
+                PopupMenu::Item convertItem("Convert Samples To Device Rate On Load");
+                convertItem.setTicked(plugin != nullptr && plugin->getConvertOnLoad());
+                convertItem.action = [this]()
+                {
+                    if (plugin != nullptr)
+                        plugin->setConvertOnLoad(!plugin->getConvertOnLoad());
+                };
+                menu.addItem(convertItem);
+
+                PopupMenu storageMenu;
+                for (auto format : { SampleFormat::float32, SampleFormat::int16,
+                                     SampleFormat::int24, SampleFormat::float16 })
+                {
+                    PopupMenu::Item formatItem(SampleData::formatToString(format));
+                    formatItem.setTicked(plugin != nullptr && plugin->getSampleFormat() == format);
+                    formatItem.action = [this, format]()
+                    {
+                        if (plugin != nullptr)
+                            plugin->setSampleFormat(format);
+                    };
+                    storageMenu.addItem(formatItem);
+                }
+                menu.addSubMenu("Sample Storage Format", storageMenu);
+
+                PopupMenu voicesMenu;
+                for (int count = SamplerPlugin::minVoices; count <= SamplerPlugin::maxVoices; count *= 2)
+                {
+                    PopupMenu::Item countItem(String(count) + " Voices");
+                    countItem.setTicked(plugin != nullptr && plugin->getNumVoices() == count);
+                    countItem.action = [this, count]()
+                    {
+                        if (plugin != nullptr)
+                            plugin->setNumVoices(count);
+                    };
+                    voicesMenu.addItem(countItem);
+                }
+                voicesMenu.addSeparator();
+                for (auto policy : { VoiceStealing::oldest, VoiceStealing::quietest, VoiceStealing::sameNoteFirst })
+                {
+                    PopupMenu::Item policyItem("Steal " + SamplerSynth::voiceStealingToString(policy));
+                    policyItem.setTicked(plugin != nullptr && plugin->getVoiceStealing() == policy);
+                    policyItem.action = [this, policy]()
+                    {
+                        if (plugin != nullptr)
+                            plugin->setVoiceStealing(policy);
+                    };
+                    voicesMenu.addItem(policyItem);
+                }
+                menu.addSubMenu("Polyphony", voicesMenu);
+
+                PopupMenu threadsMenu;
+                const int maxThreads = jmin(VoiceRenderPool::maxWorkers, SystemStats::getNumCpus() - 1);
+                for (int count = 0; count <= maxThreads; ++count)
+                {
+                    PopupMenu::Item threadsItem(count == 0 ? String("Off (Audio Thread Only)") : String(count) + " Extra Threads");
+                    threadsItem.setTicked(plugin != nullptr && plugin->getRenderThreads() == count);
+                    threadsItem.action = [this, count]()
+                    {
+                        if (plugin != nullptr)
+                            plugin->setRenderThreads(count);
+                    };
+                    threadsMenu.addItem(threadsItem);
+                }
+                menu.addSubMenu("Parallel Voice Rendering", threadsMenu);
+
+                PopupMenu logMenu;
+                for (auto level : { SamplerLog::Level::off, SamplerLog::Level::error,
+                                    SamplerLog::Level::info, SamplerLog::Level::debug })
+                {
+                    PopupMenu::Item levelItem(SamplerLog::levelToString(level));
+                    levelItem.setTicked(SamplerLog::getLevel() == level);
+                    levelItem.action = [level]() { SamplerLog::setLevel(level); };
+                    logMenu.addItem(levelItem);
+                }
+                menu.addSubMenu("Debug Log Level", logMenu);
+
                 PopupMenu::Item githubItem("GitHub Repository...");
                 githubItem.action = [this]() { URL("https://github.com/camenduru/TostEngine-juce-pocket-sampler").launchInDefaultBrowser(); };
                 menu.addItem(githubItem);
@@ -284,6 +490,95 @@ public:
         }
 
     private:
+        // Smallest buffer the low-latency preset asks for
+        static constexpr int lowLatencyMinBufferSize = 32;
+
+        void changeListenerCallback(ChangeBroadcaster*) override
+        {
+            // AudioProcessorPlayer has already re-prepared the plugin if the device restarted
+            logDeviceSetup();
+        }
+
+        void logDeviceSetup()
+        {
+            if (auto* device = deviceManager.getCurrentAudioDevice())
+                DEBUG_MIDI("Audio device: " + device->getName() + " (" + device->getTypeName() + ") "
+                           + String(device->getCurrentSampleRate()) + " Hz, "
+                           + String(device->getCurrentBufferSizeSamples()) + " samples, "
+                           + String(device->getOutputLatencyInSamples()) + " samples output latency");
+            else
+                DEBUG_MIDI("Audio device: NONE");
+        }
+
+        bool hasDeviceType(const String& typeName)
+        {
+            for (auto* type : deviceManager.getAvailableDeviceTypes())
+                if (type->getTypeName() == typeName)
+                    return true;
+            return false;
+        }
+
+        // Low-latency preset: a driver type that bypasses the system mixer
+        // when one is available (ASIO, then exclusive WASAPI), and the
+        // smallest buffer the device offers from 32 samples up. Turning it
+        // off restores the setup from before.
+        void setLowLatencyMode(bool shouldEnable)
+        {
+            if (shouldEnable == lowLatencyMode)
+                return;
+
+            String error;
+
+            if (shouldEnable)
+            {
+                savedDeviceType = deviceManager.getCurrentAudioDeviceType();
+                savedSetup = deviceManager.getAudioDeviceSetup();
+
+                for (const char* typeName : { "ASIO", "Windows Audio (Exclusive Mode)", "Windows Audio (Low Latency Mode)" })
+                {
+                    if (hasDeviceType(typeName))
+                    {
+                        if (deviceManager.getCurrentAudioDeviceType() != typeName)
+                            deviceManager.setCurrentAudioDeviceType(typeName, true);
+                        break;
+                    }
+                }
+
+                if (auto* device = deviceManager.getCurrentAudioDevice())
+                {
+                    int bufferSize = device->getDefaultBufferSize();
+                    for (int size : device->getAvailableBufferSizes())
+                        if (size >= lowLatencyMinBufferSize && size < bufferSize)
+                            bufferSize = size;
+
+                    auto setup = deviceManager.getAudioDeviceSetup();
+                    setup.bufferSize = bufferSize;
+                    error = deviceManager.setAudioDeviceSetup(setup, true);
+                }
+                else
+                {
+                    error = "No audio device is open";
+                }
+            }
+            else
+            {
+                if (savedDeviceType.isNotEmpty() && deviceManager.getCurrentAudioDeviceType() != savedDeviceType)
+                    deviceManager.setCurrentAudioDeviceType(savedDeviceType, true);
+
+                error = deviceManager.setAudioDeviceSetup(savedSetup, true);
+            }
+
+            lowLatencyMode = shouldEnable && error.isEmpty();
+
+            if (error.isNotEmpty())
+            {
+                DEBUG_MIDI("Low-latency mode: " + error);
+                AlertWindow::showMessageBoxAsync(MessageBoxIconType::WarningIcon, "Low-Latency Mode", error);
+            }
+
+            logDeviceSetup();
+        }
+
         void showSettings()
         {
             settingsDialog = std::make_unique<SettingsDialog>(deviceManager);
@@ -317,12 +612,18 @@ public:
         String midiOutputDeviceId;
         int selectedMidiOutputIndex = -1;
 
+        // Setup to return to when low-latency mode is turned off
+        bool lowLatencyMode = false;
+        String savedDeviceType;
+        AudioDeviceManager::AudioDeviceSetup savedSetup;
+
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainWindow)
     };
 
 private:
     AudioDeviceManager deviceManager;
     std::unique_ptr<MainWindow> mainWindow;
+    std::unique_ptr<OfflineRenderJob> renderJob;
 };
 
 START_JUCE_APPLICATION(SamplerApp)
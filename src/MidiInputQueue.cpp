@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    MidiInputQueue.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Lock-free, sample-accurate queue for live MIDI input
+
+  ==============================================================================
+*/
+
+#include "MidiInputQueue.h"
+
+//==============================================================================
+MidiInputQueue::MidiInputQueue()
+    : slots(new Slot[capacity])
+{
+    static_assert((capacity & mask) == 0, "Capacity must be a power of two");
+
+    for (size_t i = 0; i < capacity; ++i)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+void MidiInputQueue::addMessageToQueue(const MidiMessage& message, double gateSeconds) noexcept
+{
+    const int size = message.getRawDataSize();
+
+    if (size <= 0 || size > 3)
+    {
+        ++numDropped;
+        return;
+    }
+
+    Event event;
+    event.time = message.getTimeStamp() != 0 ? message.getTimeStamp()
+                                             : Time::getMillisecondCounterHiRes() * 0.001;
+    event.gateSeconds = message.isNoteOn() ? static_cast<float>(jmax(0.0, gateSeconds)) : 0.0f;
+    event.size = static_cast<uint8>(size);
+    std::memcpy(event.data, message.getRawData(), static_cast<size_t>(size));
+
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        auto& slot = slots[pos & mask];
+        auto diff = (intptr_t) slot.sequence.load(std::memory_order_acquire) - (intptr_t) pos;
+
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                slot.event = event;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Full: the audio thread has stalled, so losing events is the lesser evil
+            ++numDropped;
+            return;
+        }
+        else
+        {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool MidiInputQueue::pop(Event& result) noexcept
+{
+    auto& slot = slots[dequeuePos & mask];
+
+    if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+        return false;
+
+    result = slot.event;
+    slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+    ++dequeuePos;
+    return true;
+}
+
+bool MidiInputQueue::isEmpty() const noexcept
+{
+    return slots[dequeuePos & mask].sequence.load(std::memory_order_acquire) != dequeuePos + 1;
+}
+
+//==============================================================================
+void MidiInputQueue::reset(double newSampleRate) noexcept
+{
+    jassert(newSampleRate > 0);
+    sampleRate = newSampleRate;
+
+    Event discarded;
+    while (pop(discarded)) {}
+
+    numGates = 0;
+}
+
+double MidiInputQueue::removeNextBlockOfMessages(MidiBuffer& dest, int numSamples) noexcept
+{
+    if (numSamples <= 0)
+        return -1.0;
+
+    // This callback covers the block period that has just ended
+    const double now = Time::getMillisecondCounterHiRes() * 0.001;
+    const double windowStart = now - numSamples / sampleRate;
+
+    double worstLatency = -1.0;
+
+    Event event;
+    while (pop(event))
+    {
+        // Late arrivals (scheduling jitter) land at the start of the block
+        const double position = (event.time - windowStart) * sampleRate;
+        const int offset = static_cast<int>(jlimit(0.0, static_cast<double>(numSamples - 1), position));
+        dest.addEvent(event.data, event.size, offset);
+
+        if (event.size == 3 && (event.data[0] & 0xf0) == 0x90 && event.data[2] != 0)
+        {
+            worstLatency = jmax(worstLatency, now + offset / sampleRate - event.time);
+
+            // With every gate in use the note-off goes at the end of the block
+            if (event.gateSeconds > 0)
+            {
+                const auto status = static_cast<uint8>(0x80 | (event.data[0] & 0x0f));
+
+                if (numGates < maxGates)
+                {
+                    const auto length = jmax((int64) 1, static_cast<int64>(event.gateSeconds * sampleRate));
+                    gates[numGates++] = { offset + length, status, event.data[1] };
+                }
+                else
+                {
+                    const uint8 noteOff[] = { status, event.data[1], 0 };
+                    dest.addEvent(noteOff, 3, numSamples - 1);
+                }
+            }
+        }
+    }
+
+    // Gates closing in this block
+    for (int i = 0; i < numGates;)
+    {
+        auto& gate = gates[i];
+
+        if (gate.samplesLeft < numSamples)
+        {
+            const uint8 noteOff[] = { gate.status, gate.note, 0 };
+            dest.addEvent(noteOff, 3, static_cast<int>(gate.samplesLeft));
+            gate = gates[--numGates];
+            continue;
+        }
+
+        gate.samplesLeft -= numSamples;
+        ++i;
+    }
+
+    return worstLatency;
+}
@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    MidiInputQueue.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Lock-free, sample-accurate queue for live MIDI input
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+
+#include <atomic>
+#include <memory>
+
+//==============================================================================
+// Replaces MidiMessageCollector for MIDI that doesn't come from the host:
+// device input callbacks and pad clicks in the editor.
+//
+// Producers on the MIDI and message threads push short messages into a
+// bounded ring without locking or allocating (same scheme as the log
+// ring). Once per block the audio thread drains it. Each event is placed at
+// the sample offset matching when it arrived during the block period that
+// has just ended, so triggering has one block of constant latency and
+// no jitter, however short the buffers are.
+//
+// A note-on can carry a gate length, in which case the queue schedules its
+// note-off itself, that many samples after the note-on (pad clicks).
+class MidiInputQueue
+{
+public:
+    MidiInputQueue();
+
+    // Any thread. Messages without a timestamp are stamped on arrival;
+    // timestamps are in seconds on the Time::getMillisecondCounterHiRes()
+    // clock, as MidiInput delivers them. SysEx is not supported and dropped.
+    // A note-on with gateSeconds > 0 is followed by a matching note-off.
+    void addMessageToQueue(const MidiMessage& message, double gateSeconds = 0) noexcept;
+
+    // Audio thread (prepareToPlay): discards anything pending
+    void reset(double newSampleRate) noexcept;
+
+    // Audio thread: adds every queued event to dest at its sample position
+    // within a block of numSamples. Never allocates while dest has room.
+    // Returns the longest time in seconds any note-on waited between arrival
+    // and its place in the block, or -1 if there were none.
+    double removeNextBlockOfMessages(MidiBuffer& dest, int numSamples) noexcept;
+
+    // Audio thread: false while nothing is queued and no gate is waiting
+    // to close
+    bool hasPendingEvents() const noexcept { return numGates > 0 || !isEmpty(); }
+
+    bool isEmpty() const noexcept;
+    int getNumDropped() const noexcept { return numDropped.load(); }
+
+private:
+    struct Event
+    {
+        double time = 0;
+        float gateSeconds = 0;
+        uint8 data[3] = {};
+        uint8 size = 0;
+    };
+
+    // A scheduled note-off, counted down by the audio thread
+    struct Gate
+    {
+        int64 samplesLeft = 0;  // From the start of the next block
+        uint8 status = 0x80;
+        uint8 note = 0;
+    };
+
+    struct Slot
+    {
+        std::atomic<size_t> sequence { 0 };
+        Event event;
+    };
+
+    bool pop(Event& result) noexcept;
+
+    static constexpr size_t capacity = 1024;
+    static constexpr size_t mask = capacity - 1;
+
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<size_t> enqueuePos { 0 };
+    alignas(64) size_t dequeuePos = 0;
+
+    double sampleRate = 44100.0;
+    std::atomic<int> numDropped { 0 };
+
+    // Audio thread only
+    static constexpr int maxGates = 64;
+    Gate gates[maxGates];
+    int numGates = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(MidiInputQueue)
+};
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    MidiUiQueue.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Lock-free hand-over of incoming MIDI to the editor
+
+  ==============================================================================
+*/
+
+#include "MidiUiQueue.h"
+
+//==============================================================================
+bool MidiUiQueue::push(const MidiMessage& message) noexcept
+{
+    const int size = message.getRawDataSize();
+
+    if (size <= 0 || size > 3)
+    {
+        numDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const SpinLock::ScopedLockType producer(producerLock);
+
+    {
+        // Published to the reader when the scope ends
+        const auto scope = fifo.write(1);
+
+        if (scope.blockSize1 == 0)
+        {
+            numDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        auto& event = events[scope.startIndex1];
+        std::memcpy(event.data, message.getRawData(), static_cast<size_t>(size));
+        event.size = static_cast<uint8>(size);
+    }
+
+    if (listener != nullptr)
+        listener->triggerAsyncUpdate();
+
+    return true;
+}
+
+bool MidiUiQueue::pop(Event& event) noexcept
+{
+    const auto scope = fifo.read(1);
+
+    if (scope.blockSize1 == 0)
+        return false;
+
+    event = events[scope.startIndex1];
+    return true;
+}
+
+void MidiUiQueue::clear() noexcept
+{
+    Event discarded;
+    while (pop(discarded)) {}
+}
+
+void MidiUiQueue::setListener(AsyncUpdater* newListener) noexcept
+{
+    const SpinLock::ScopedLockType producer(producerLock);
+    listener = newListener;
+}
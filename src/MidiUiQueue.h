@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    MidiUiQueue.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Lock-free hand-over of incoming MIDI to the editor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+
+#include <atomic>
+
+//==============================================================================
+// Carries live MIDI from the MIDI input callback to the message thread.
+//
+// The input callback copies each short message into a fixed ring and returns;
+// the editor drains the ring in its vblank frame updates and does all the UI
+// work there (status bar, pad lights, MIDI learn). Nothing on the input side allocates,
+// formats strings or touches components, so dense input can't hold up MIDI
+// delivery to the audio thread.
+//
+// Single producer, single consumer. Several input devices may call back on
+// different threads, so producers are serialised by a spin lock held only
+// for the copy. A listener, if set, is woken with triggerAsyncUpdate, which
+// is what starts the editor's frame updates; there is no timer, so nothing
+// runs while the input is quiet.
+class MidiUiQueue
+{
+public:
+    static constexpr int capacity = 1024;
+
+    // Three bytes or fewer: channel voice, mode and system common messages
+    struct Event
+    {
+        uint8 data[3] = {};
+        uint8 size = 0;
+
+        MidiMessage toMessage() const { return MidiMessage(data, size); }
+    };
+
+    // MIDI input threads. Returns false (and counts it) if the message is too
+    // long or the editor hasn't drained the ring for a while.
+    bool push(const MidiMessage& message) noexcept;
+
+    // Message thread
+    bool pop(Event& event) noexcept;
+    void clear() noexcept;
+
+    // Message thread: woken after each push, nullptr for none. Once this
+    // returns no push can still be waking the previous listener.
+    void setListener(AsyncUpdater* newListener) noexcept;
+
+    uint32 getNumDropped() const noexcept { return numDropped.load(std::memory_order_relaxed); }
+
+private:
+    AbstractFifo fifo { capacity };
+    Event events[capacity];
+    SpinLock producerLock;
+    AsyncUpdater* listener = nullptr;  // Guarded by producerLock
+    std::atomic<uint32> numDropped { 0 };
+};
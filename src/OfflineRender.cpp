@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+
+    OfflineRender.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Faster-than-real-time rendering of a MIDI file to an audio file
+
+  ==============================================================================
+*/
+
+#include "OfflineRender.h"
+#include "SamplerPlugin.h"
+
+//==============================================================================
+namespace
+{
+    // Samples the writer thread can fall behind by before the render waits
+    constexpr int writerFifoSamples = 1 << 17;
+
+    std::unique_ptr<AudioFormat> createFormatFor(const File& file)
+    {
+        if (file.hasFileExtension("flac"))
+            return std::make_unique<FlacAudioFormat>();
+
+        if (file.hasFileExtension("wav;wave"))
+            return std::make_unique<WavAudioFormat>();
+
+        return nullptr;
+    }
+}
+
+//==============================================================================
+bool OfflineRender::readMidiFile(const File& file, MidiMessageSequence& sequence)
+{
+    FileInputStream stream(file);
+    MidiFile midi;
+
+    if (!stream.openedOk() || !midi.readFrom(stream))
+        return false;
+
+    midi.convertTimestampTicksToSeconds();
+    sequence.clear();
+
+    for (int track = 0; track < midi.getNumTracks(); ++track)
+        for (const auto* event : *midi.getTrack(track))
+            if (!event->message.isMetaEvent() && !event->message.isSysEx())
+                sequence.addEvent(event->message);
+
+    sequence.sort();
+    return true;
+}
+
+OfflineRender::Result OfflineRender::render(SamplerPlugin& plugin, const File& midiFile,
+                                            const File& outputFile, const Settings& settings)
+{
+    Result result;
+
+    MidiMessageSequence sequence;
+    if (!readMidiFile(midiFile, sequence))
+    {
+        result.error = "Could not read MIDI file " + midiFile.getFullPathName();
+        return result;
+    }
+
+    auto format = createFormatFor(outputFile);
+    if (format == nullptr)
+    {
+        result.error = "Output must be a .wav or .flac file";
+        return result;
+    }
+
+    const double sampleRate = settings.sampleRate;
+    const int blockSize = jmax(1, settings.blockSize);
+    const int bits = settings.bitsPerSample;
+
+    if (!format->getPossibleBitDepths().contains(bits) || !format->getPossibleSampleRates().contains((int) sampleRate))
+    {
+        result.error = format->getFormatName() + " can't store " + String(bits) + "-bit audio at " + String(sampleRate) + " Hz";
+        return result;
+    }
+
+    outputFile.deleteFile();
+    auto stream = outputFile.createOutputStream();
+
+    if (stream == nullptr || stream->failedToOpen())
+    {
+        result.error = "Could not create " + outputFile.getFullPathName();
+        return result;
+    }
+
+    std::unique_ptr<AudioFormatWriter> writer(format->createWriterFor(stream.get(), sampleRate, 2,
+                                                                      bits, {}, 0));
+    if (writer == nullptr)
+    {
+        result.error = "Could not create a " + format->getFormatName() + " writer";
+        return result;
+    }
+
+    stream.release();  // Owned by the writer now
+
+    plugin.setNonRealtime(true);
+    plugin.setRenderThreads(settings.renderThreads);
+    plugin.setPlayConfigDetails(0, 2, sampleRate, blockSize);
+    plugin.prepareToPlay(sampleRate, blockSize);
+
+    const double lastEventSeconds = sequence.getNumEvents() > 0 ? sequence.getEndTime() : 0.0;
+    const int64 length = static_cast<int64>(std::ceil((lastEventSeconds + jmax(0.0, settings.tailSeconds)) * sampleRate));
+
+    AudioBuffer<float> buffer(jmax(2, plugin.getTotalNumOutputChannels()), blockSize);
+    MidiBuffer midi;
+    midi.ensureSize(4096);
+
+    TimeSliceThread writerThread("Offline Render Writer");
+    writerThread.startThread();
+
+    {
+        AudioFormatWriter::ThreadedWriter threadedWriter(writer.release(), writerThread, writerFifoSamples);
+
+        const int64 startTicks = Time::getHighResolutionTicks();
+        int next = 0;
+
+        for (int64 blockStart = 0; blockStart < length; blockStart += blockSize)
+        {
+            const int numSamples = static_cast<int>(jmin((int64) blockSize, length - blockStart));
+            const int64 blockEnd = blockStart + numSamples;
+
+            midi.clear();
+
+            for (; next < sequence.getNumEvents(); ++next)
+            {
+                const auto& message = sequence.getEventPointer(next)->message;
+                const auto position = static_cast<int64>(message.getTimeStamp() * sampleRate);
+
+                if (position >= blockEnd)
+                    break;
+
+                midi.addEvent(message, static_cast<int>(jmax((int64) 0, position - blockStart)));
+            }
+
+            buffer.setSize(buffer.getNumChannels(), numSamples, false, false, true);
+            plugin.processBlock(buffer, midi);
+
+            const float* const channels[] = { buffer.getReadPointer(0), buffer.getReadPointer(1) };
+
+            // A full FIFO means the disk is behind; give the writer thread a turn
+            while (!threadedWriter.write(channels, numSamples))
+                Thread::sleep(1);
+        }
+
+        result.renderSeconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+    }
+
+    // The threaded writer has flushed and closed the file by now
+    writerThread.stopThread(5000);
+    plugin.releaseResources();
+
+    result.audioSeconds = static_cast<double>(length) / sampleRate;
+    result.succeeded = true;
+    return result;
+}
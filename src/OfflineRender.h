@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    OfflineRender.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Faster-than-real-time rendering of a MIDI file to an audio file
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+
+class SamplerPlugin;
+
+//==============================================================================
+// Plays a MIDI file through SamplerPlugin::processBlock as fast as the
+// machine allows and writes the main output to a WAV or FLAC file (chosen by
+// the output's extension).
+//
+// The plugin is switched to non-realtime (offline quality resampling) and
+// prepared at the requested rate and block size; the kit must already be
+// loaded. Every track of the file is merged into one stream, so notes
+// trigger whatever they are mapped to as if played live. Encoding happens on
+// a writer thread behind a FIFO, so the render loop only waits on it when
+// the disk can't keep up. Rendering stops at the file's last event plus the
+// tail, which gives releases and one-shots time to ring out.
+class OfflineRender
+{
+public:
+    struct Settings
+    {
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        int renderThreads = 0;      // SamplerPlugin::setRenderThreads
+        double tailSeconds = 2.0;
+        int bitsPerSample = 24;     // 16, 24, or 32 (float, WAV only)
+    };
+
+    struct Result
+    {
+        bool succeeded = false;
+        String error;
+        double audioSeconds = 0;
+        double renderSeconds = 0;
+
+        double getRealtimeFactor() const { return renderSeconds > 0 ? audioSeconds / renderSeconds : 0.0; }
+    };
+
+    static Result render(SamplerPlugin& plugin, const File& midiFile, const File& outputFile, const Settings& settings);
+
+    // Note-ons, note-offs and controllers from every track, in seconds
+    static bool readMidiFile(const File& file, MidiMessageSequence& sequence);
+};
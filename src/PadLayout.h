@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    PadLayout.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    How many pads there are and how they are grouped into banks
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+
+//==============================================================================
+// The sampler has one pad per MIDI note, grouped into banks the size of the
+// editor's 4x4 grid. Every pad is live all the time: it plays whatever note
+// it is mapped to, from MIDI input in any bank. Switching banks only changes
+// which pads the grid shows and clicks play, so nothing is reloaded.
+namespace PadLayout
+{
+    constexpr int gridSize = 4;
+    constexpr int padsPerBank = gridSize * gridSize;
+    constexpr int numBanks = 8;
+    constexpr int numPads = padsPerBank * numBanks;
+
+    static_assert(numPads <= 128, "Pads are mapped to MIDI notes");
+
+    // Bank A starts at C2 (36) like the original 16 pads; later banks carry
+    // on up and wrap around to the bottom of the range
+    constexpr int getDefaultNote(int pad) noexcept { return (36 + pad) % 128; }
+
+    constexpr int getBank(int pad) noexcept { return pad / padsPerBank; }
+    constexpr int getFirstPad(int bank) noexcept { return bank * padsPerBank; }
+
+    inline String getBankName(int bank) { return String::charToString(static_cast<juce_wchar>('A' + bank)); }
+
+    // "A1" to "H16"
+    inline String getPadName(int pad) { return getBankName(getBank(pad)) + String(pad % padsPerBank + 1); }
+}
@@ -0,0 +1,206 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Audio-thread load, xrun and trigger latency counters
+
+  ==============================================================================
+*/
+
+#include "PerformanceMonitor.h"
+
+//==============================================================================
+PerformanceMonitor::PerformanceMonitor()
+{
+    for (auto& bin : histogram)
+        bin.store(0);
+}
+
+void PerformanceMonitor::clearCounters() noexcept
+{
+    loadSum = 0;
+    latencySum = 0;
+
+    numBlocks.store(0, std::memory_order_relaxed);
+    lastLoad.store(0, std::memory_order_relaxed);
+    averageLoad.store(0, std::memory_order_relaxed);
+    peakLoad.store(0, std::memory_order_relaxed);
+    numOverruns.store(0, std::memory_order_relaxed);
+    numLateBlocks.store(0, std::memory_order_relaxed);
+    peakVoices.store(0, std::memory_order_relaxed);
+    numTriggers.store(0, std::memory_order_relaxed);
+    lastLatency.store(0, std::memory_order_relaxed);
+    averageLatency.store(0, std::memory_order_relaxed);
+    maxLatency.store(0, std::memory_order_relaxed);
+
+    for (auto& bin : histogram)
+        bin.store(0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void PerformanceMonitor::beginBlock(int numSamples, double sampleRate) noexcept
+{
+    const int64 now = Time::getHighResolutionTicks();
+
+    if (resetRequested.exchange(false, std::memory_order_relaxed))
+        clearCounters();
+
+    // A callback that comes well after the previous block's period means the
+    // device missed one
+    if (restartRequested.exchange(false, std::memory_order_relaxed))
+        lastBlockStartTicks = 0;
+
+    if (lastBlockStartTicks != 0 && blockPeriod > 0
+        && Time::highResolutionTicksToSeconds(now - lastBlockStartTicks) > 1.5 * blockPeriod)
+        numLateBlocks.fetch_add(1, std::memory_order_relaxed);
+
+    lastBlockStartTicks = now;
+    blockStartTicks = now;
+    blockPeriod = sampleRate > 0 ? numSamples / sampleRate : 0;
+}
+
+void PerformanceMonitor::endBlock(int numActiveVoices) noexcept
+{
+    if (blockPeriod <= 0)
+        return;
+
+    const double elapsed = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - blockStartTicks);
+    const double load = elapsed / blockPeriod;
+    const int64 blocks = numBlocks.load(std::memory_order_relaxed) + 1;
+
+    loadSum += load;
+
+    numBlocks.store(blocks, std::memory_order_relaxed);
+    lastLoad.store(load, std::memory_order_relaxed);
+    averageLoad.store(loadSum / static_cast<double>(blocks), std::memory_order_relaxed);
+
+    if (load > peakLoad.load(std::memory_order_relaxed))
+        peakLoad.store(load, std::memory_order_relaxed);
+
+    if (load > 1.0)
+        numOverruns.fetch_add(1, std::memory_order_relaxed);
+
+    const int bin = jmin(numLoadBins - 1, static_cast<int>(load / loadBinWidth));
+    histogram[bin].fetch_add(1, std::memory_order_relaxed);
+
+    activeVoices.store(numActiveVoices, std::memory_order_relaxed);
+    if (numActiveVoices > peakVoices.load(std::memory_order_relaxed))
+        peakVoices.store(numActiveVoices, std::memory_order_relaxed);
+}
+
+void PerformanceMonitor::addTriggerLatency(double seconds) noexcept
+{
+    const int triggers = numTriggers.load(std::memory_order_relaxed) + 1;
+    latencySum += seconds;
+
+    numTriggers.store(triggers, std::memory_order_relaxed);
+    lastLatency.store(seconds, std::memory_order_relaxed);
+    averageLatency.store(latencySum / triggers, std::memory_order_relaxed);
+
+    if (seconds > maxLatency.load(std::memory_order_relaxed))
+        maxLatency.store(seconds, std::memory_order_relaxed);
+}
+
+//==============================================================================
+PerformanceMonitor::Snapshot PerformanceMonitor::getSnapshot() const noexcept
+{
+    Snapshot s;
+
+    s.numBlocks = numBlocks.load(std::memory_order_relaxed);
+    s.lastLoad = lastLoad.load(std::memory_order_relaxed);
+    s.averageLoad = averageLoad.load(std::memory_order_relaxed);
+    s.peakLoad = peakLoad.load(std::memory_order_relaxed);
+    s.numOverruns = numOverruns.load(std::memory_order_relaxed);
+    s.numLateBlocks = numLateBlocks.load(std::memory_order_relaxed);
+    s.activeVoices = activeVoices.load(std::memory_order_relaxed);
+    s.peakVoices = peakVoices.load(std::memory_order_relaxed);
+    s.numTriggers = numTriggers.load(std::memory_order_relaxed);
+    s.lastLatencyMs = 1000.0 * lastLatency.load(std::memory_order_relaxed);
+    s.averageLatencyMs = 1000.0 * averageLatency.load(std::memory_order_relaxed);
+    s.maxLatencyMs = 1000.0 * maxLatency.load(std::memory_order_relaxed);
+
+    uint64 total = 0;
+    for (int i = 0; i < numLoadBins; ++i)
+    {
+        s.histogram[i] = histogram[i].load(std::memory_order_relaxed);
+        total += s.histogram[i];
+    }
+
+    // Percentiles to the upper edge of the bin they fall in
+    auto percentile = [&s, total](double fraction)
+    {
+        const auto target = static_cast<uint64>(std::ceil(fraction * static_cast<double>(total)));
+        uint64 count = 0;
+
+        for (int i = 0; i < numLoadBins; ++i)
+        {
+            count += s.histogram[i];
+            if (count >= target && count > 0)
+                return (i + 1) * loadBinWidth;
+        }
+        return 0.0;
+    };
+
+    s.p50Load = percentile(0.50);
+    s.p95Load = percentile(0.95);
+    s.p99Load = percentile(0.99);
+
+    return s;
+}
+
+bool PerformanceMonitor::exportToFile(const File& file) const
+{
+    const auto s = getSnapshot();
+
+    struct Field { const char* name; var value; };
+    const Field fields[] =
+    {
+        { "blocks",             s.numBlocks },
+        { "loadLast",           s.lastLoad },
+        { "loadAverage",        s.averageLoad },
+        { "loadPeak",           s.peakLoad },
+        { "loadP50",            s.p50Load },
+        { "loadP95",            s.p95Load },
+        { "loadP99",            s.p99Load },
+        { "overruns",           s.numOverruns },
+        { "lateCallbacks",      s.numLateBlocks },
+        { "activeVoices",       s.activeVoices },
+        { "peakVoices",         s.peakVoices },
+        { "triggers",           s.numTriggers },
+        { "latencyLastMs",      s.lastLatencyMs },
+        { "latencyAverageMs",   s.averageLatencyMs },
+        { "latencyMaxMs",       s.maxLatencyMs },
+    };
+
+    String text;
+
+    if (file.hasFileExtension("csv"))
+    {
+        text << "name,value\n";
+        for (const auto& field : fields)
+            text << field.name << "," << field.value.toString() << "\n";
+
+        text << "\nloadFrom,loadTo,blocks\n";
+        for (int i = 0; i < numLoadBins; ++i)
+            text << String(i * loadBinWidth, 2) << "," << String((i + 1) * loadBinWidth, 2) << "," << String(s.histogram[i]) << "\n";
+    }
+    else
+    {
+        auto* root = new DynamicObject();
+        for (const auto& field : fields)
+            root->setProperty(field.name, field.value);
+
+        Array<var> bins;
+        for (int i = 0; i < numLoadBins; ++i)
+            bins.add(static_cast<int64>(s.histogram[i]));
+
+        root->setProperty("loadBinWidth", loadBinWidth);
+        root->setProperty("loadHistogram", bins);
+        text = JSON::toString(var(root));
+    }
+
+    return file.replaceWithText(text);
+}
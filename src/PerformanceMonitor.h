@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Audio-thread load, xrun and trigger latency counters
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+
+#include <atomic>
+
+//==============================================================================
+// Counters for how close the engine is to dropping out.
+//
+// The audio thread is the only writer: it times each processBlock against
+// the block's own duration, bins the resulting load into a histogram,
+// counts blocks that overran their budget or arrived late (a missed
+// callback), and records how long live note-ons took from arrival to their
+// place in the output. Everything is published through relaxed atomics, so
+// the UI can read a snapshot at any time without locking. A reset is only
+// requested by other threads and carried out by the audio thread.
+class PerformanceMonitor
+{
+public:
+    static constexpr int numLoadBins = 100;
+    static constexpr double loadBinWidth = 0.02;  // 2 % of the block period; the last bin holds 198 % and up
+
+    PerformanceMonitor();
+
+    // Audio thread: bracket each processBlock
+    void beginBlock(int numSamples, double sampleRate) noexcept;
+    void endBlock(int numActiveVoices) noexcept;
+
+    // Audio thread: seconds from a live note-on's arrival to its place in
+    // the rendered block, not counting the device's own output latency
+    void addTriggerLatency(double seconds) noexcept;
+
+    // Any thread. restart: the gap before the next block (device restart)
+    // isn't a late callback. reset: clear everything at the next block.
+    void restart() noexcept { restartRequested.store(true); }
+    void reset() noexcept { resetRequested.store(true); }
+
+    struct Snapshot
+    {
+        int64 numBlocks = 0;
+        double lastLoad = 0, averageLoad = 0, peakLoad = 0;  // 1.0 = the whole block period
+        double p50Load = 0, p95Load = 0, p99Load = 0;
+        int numOverruns = 0;    // Blocks that took longer than their own duration
+        int numLateBlocks = 0;  // Callbacks more than 1.5 periods after the previous one
+        int activeVoices = 0, peakVoices = 0;
+        int numTriggers = 0;
+        double lastLatencyMs = 0, averageLatencyMs = 0, maxLatencyMs = 0;
+        uint32 histogram[numLoadBins] = {};
+    };
+
+    Snapshot getSnapshot() const noexcept;
+
+    // Message thread: snapshot and histogram as CSV for a .csv file, JSON otherwise
+    bool exportToFile(const File& file) const;
+
+private:
+    void clearCounters() noexcept;
+
+    // Audio thread only
+    int64 blockStartTicks = 0;
+    int64 lastBlockStartTicks = 0;
+    double blockPeriod = 0;
+    double loadSum = 0;
+    double latencySum = 0;
+
+    std::atomic<bool> resetRequested { false };
+    std::atomic<bool> restartRequested { true };
+
+    std::atomic<int64> numBlocks { 0 };
+    std::atomic<double> lastLoad { 0 }, averageLoad { 0 }, peakLoad { 0 };
+    std::atomic<int> numOverruns { 0 }, numLateBlocks { 0 };
+    std::atomic<int> activeVoices { 0 }, peakVoices { 0 };
+    std::atomic<int> numTriggers { 0 };
+    std::atomic<double> lastLatency { 0 }, averageLatency { 0 }, maxLatency { 0 };
+    std::atomic<uint32> histogram[numLoadBins];
+
+    JUCE_DECLARE_NON_COPYABLE(PerformanceMonitor)
+};
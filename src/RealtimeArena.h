@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    RealtimeArena.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Preallocated bump allocator for audio-thread scratch memory
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+
+#include <type_traits>
+
+//==============================================================================
+// One block of memory, reserved before the threads that use it start (a
+// VoiceRenderPool being configured), that scratch buffers are carved out of. Carving
+// just moves an offset along, so it is safe anywhere; nothing is ever freed
+// on its own, only everything at once by the next reset or reserve.
+//
+// Every allocation starts on a cache line, so buffers used by different
+// threads never share one. For now only the render pool's helper scratch
+// lives here; the rest of the engine's real-time state is sized up front in
+// its own members.
+class RealtimeArena
+{
+public:
+    static constexpr size_t alignment = 64;
+
+    // Bytes count Types take up in the arena, padding included
+    template <typename Type>
+    static constexpr size_t bytesFor(size_t count) noexcept
+    {
+        return (count * sizeof(Type) + alignment - 1) & ~(alignment - 1);
+    }
+
+    // Drops every allocation and makes room for bytes more. The block is
+    // only replaced if it is too small, so nothing carved from it before may
+    // still be in use.
+    void reserve(size_t bytes)
+    {
+        reset();
+
+        if (bytes <= capacity)
+            return;
+
+        storage.allocate(bytes + alignment, true);
+        base = reinterpret_cast<char*>((reinterpret_cast<pointer_sized_uint>(storage.get()) + alignment - 1)
+                                       & ~static_cast<pointer_sized_uint>(alignment - 1));
+        capacity = bytes;
+    }
+
+    void reset() noexcept { used = 0; }
+
+    // Uninitialised, apart from being zeroed when the block was first
+    // reserved. Null (and an assertion) once the arena is full, which means
+    // reserve was given too little.
+    template <typename Type>
+    Type* allocate(size_t count) noexcept
+    {
+        static_assert(std::is_trivially_destructible_v<Type>, "Arena memory is never destroyed");
+
+        const size_t bytes = bytesFor<Type>(count);
+
+        if (bytes > capacity - used)
+        {
+            jassertfalse;
+            return nullptr;
+        }
+
+        auto* result = reinterpret_cast<Type*>(base + used);
+        used += bytes;
+        return result;
+    }
+
+    size_t getCapacity() const noexcept { return capacity; }
+    size_t getBytesUsed() const noexcept { return used; }
+
+private:
+    HeapBlock<char> storage;
+    char* base = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+};
@@ -0,0 +1,500 @@
+/*
+  ==============================================================================
+
+    SampleBundle.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Single-file kit bundles with pre-decoded audio
+
+  ==============================================================================
+*/
+
+#include "SampleBundle.h"
+
+//==============================================================================
+namespace
+{
+    const char bundleMagic[4] = { 'T', 'S', 'K', 'B' };
+    constexpr int bundleVersion = 6;   // 2 added zones, 3 envelopes, 4 loops, 5 banks, 6 modes; older files still load
+    constexpr int oneShotFlag = 1;     // All that version 5 and earlier record of the kit's mode
+    constexpr int padFollowsKit = -1;  // Pad mode of a pad without its own
+
+    constexpr int version4PadNotes = 16;
+
+    int getNumPadNotes(int version) noexcept
+    {
+        return version >= 5 ? SampleBundle::numPads : version4PadNotes;
+    }
+
+    // magic, version, flags, sample rate, entry count, pad notes, then from
+    // version 6 the kit's mode and the pad modes
+    int getHeaderSize(int version) noexcept
+    {
+        return 4 + 4 + 4 + 8 + 4 + 4 * getNumPadNotes(version)
+                 + (version >= 6 ? 4 + 4 * SampleBundle::numPads : 0);
+    }
+
+    PlaybackMode toMode(int index) noexcept
+    {
+        return static_cast<PlaybackMode>(jlimit(0, 3, index));
+    }
+
+    const int headerSize = getHeaderSize(bundleVersion);  // What write produces
+
+    // note, quality, bus, pan, choke group, format, channels, frames,
+    // sample rate, path offset, path bytes, compressed, data offset, data
+    // bytes, then from version 2 zone, velocity range and selection, and
+    // from version 3 attack, decay, sustain and release, and from version 4
+    // loop start, end and crossfade
+    constexpr int version1EntrySize = 8 * 4 + 8 + 8 + 4 + 4 + 8 + 8;
+    constexpr int version2EntrySize = version1EntrySize + 4 * 4;
+    constexpr int version3EntrySize = version2EntrySize + 4 * 4;
+    constexpr int entrySize = version3EntrySize + 3 * 4;
+
+    int getEntrySize(int version) noexcept
+    {
+        return version == 1 ? version1EntrySize
+             : version == 2 ? version2EntrySize
+             : version == 3 ? version3EntrySize : entrySize;
+    }
+
+    // Deflate never shrinks data by more than about 1032:1, so a compressed
+    // block claiming to inflate to more than this is corrupt
+    constexpr int64 maxInflateRatio = 1032;
+    constexpr int64 inflateOverhead = 1024;
+    constexpr size_t inflateChunkBytes = size_t(1) << 30;   // Per read call, which takes an int
+
+    bool inflateBlock(InputStream& source, uint8* dest, size_t numBytes)
+    {
+        for (size_t done = 0; done < numBytes;)
+        {
+            const int chunk = static_cast<int>(jmin(inflateChunkBytes, numBytes - done));
+
+            if (source.read(dest + done, chunk) != chunk)
+                return false;
+
+            done += static_cast<size_t>(chunk);
+        }
+
+        return true;
+    }
+
+    constexpr int64 blockAlignment = 64;
+    constexpr int maxChannels = 64;
+    constexpr double attackSeconds = 0.5;
+
+    int64 alignUp(int64 offset) noexcept
+    {
+        return (offset + blockAlignment - 1) & ~(blockAlignment - 1);
+    }
+
+    // Bounds-checked little-endian reads from the mapped file
+    class Cursor
+    {
+    public:
+        Cursor(const uint8* start, int64 size, int64 offset) : data(start), end(size), position(offset) {}
+
+        bool isValid() const noexcept { return valid; }
+
+        int readInt() noexcept
+        {
+            const uint8* p = take(4);
+            return p != nullptr ? static_cast<int>(ByteOrder::littleEndianInt(p)) : 0;
+        }
+
+        int64 readInt64() noexcept
+        {
+            const uint8* p = take(8);
+            return p != nullptr ? static_cast<int64>(ByteOrder::littleEndianInt64(p)) : 0;
+        }
+
+        float readFloat() noexcept
+        {
+            const auto bits = static_cast<uint32>(readInt());
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        double readDouble() noexcept
+        {
+            const auto bits = static_cast<uint64>(readInt64());
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+    private:
+        const uint8* take(int64 numBytes) noexcept
+        {
+            if (!valid || position + numBytes > end)
+            {
+                valid = false;
+                return nullptr;
+            }
+
+            const uint8* p = data + position;
+            position += numBytes;
+            return p;
+        }
+
+        const uint8* data;
+        int64 end;
+        int64 position;
+        bool valid = true;
+    };
+
+    // Every entry's record, written once with placeholder offsets and again
+    // once the audio blocks are in place
+    struct Record
+    {
+        const SampleBundle::Entry* entry = nullptr;
+        SampleFormat format = SampleFormat::float32;
+        int numChannels = 0;
+        int numFrames = 0;
+        double sampleRate = 0;
+        int64 pathOffset = 0;
+        int pathBytes = 0;
+        bool compressed = false;
+        int64 dataOffset = 0;
+        int64 dataBytes = 0;
+    };
+
+    bool writeRecord(OutputStream& out, const Record& record)
+    {
+        const auto& entry = *record.entry;
+        const auto* loop = entry.sample != nullptr ? entry.sample->getLoop() : nullptr;
+        const LoopPoints loopPoints = loop != nullptr ? loop->points : LoopPoints();
+
+        return out.writeInt(entry.midiNote)
+            && out.writeInt(static_cast<int>(entry.quality))
+            && out.writeInt(entry.outputBus)
+            && out.writeFloat(entry.pan)
+            && out.writeInt(entry.chokeGroup)
+            && out.writeInt(static_cast<int>(record.format))
+            && out.writeInt(record.numChannels)
+            && out.writeInt(record.numFrames)
+            && out.writeDouble(record.sampleRate)
+            && out.writeInt64(record.pathOffset)
+            && out.writeInt(record.pathBytes)
+            && out.writeInt(record.compressed ? 1 : 0)
+            && out.writeInt64(record.dataOffset)
+            && out.writeInt64(record.dataBytes)
+            && out.writeInt(entry.zone)
+            && out.writeInt(entry.lowVelocity)
+            && out.writeInt(entry.highVelocity)
+            && out.writeInt(entry.selection)
+            && out.writeFloat(entry.envelope.attack)
+            && out.writeFloat(entry.envelope.decay)
+            && out.writeFloat(entry.envelope.sustain)
+            && out.writeFloat(entry.envelope.release)
+            && out.writeInt(loopPoints.start)
+            && out.writeInt(loopPoints.end)
+            && out.writeInt(loopPoints.crossfade);
+    }
+
+    bool writePadding(OutputStream& out, int64 targetPosition)
+    {
+        while (out.getPosition() < targetPosition)
+            if (!out.writeByte(0))
+                return false;
+        return true;
+    }
+
+    // The sample's audio as packed values, reusing them when the sample is
+    // already packed in the right format
+    const uint8* getPackedValues(const SampleData& sample, SampleFormat format, std::unique_ptr<SampleData>& packedCopy)
+    {
+        if (sample.getPackedValues() != nullptr && sample.format == format)
+            return sample.getPackedValues();
+
+        AudioSampleBuffer audio(sample.getNumChannels(), sample.getTotalLength());
+        sample.readFrames(0, audio.getNumSamples(), audio.getArrayOfWritePointers(), audio.getNumChannels());
+
+        packedCopy = std::make_unique<SampleData>(audio, sample.sampleRate, format);
+        return packedCopy->getPackedValues();
+    }
+
+    // Reads a byte from every page of each channel's first half second, so
+    // the first hit doesn't wait on the disk
+    void touchAttack(const uint8* values, size_t channelBytes, int numChannels, size_t attackBytes) noexcept
+    {
+        volatile uint8 sink = 0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const uint8* channel = values + channelBytes * static_cast<size_t>(ch);
+            for (size_t i = 0; i < jmin(channelBytes, attackBytes); i += 4096)
+                sink = static_cast<uint8>(sink + channel[i]);
+        }
+
+        ignoreUnused(sink);
+    }
+}
+
+//==============================================================================
+bool SampleBundle::write(const File& file, const Kit& kit, SampleFormat format, bool compress)
+{
+    Array<Record> records;
+    MemoryOutputStream paths;
+
+    const int64 pathsStart = headerSize + static_cast<int64>(entrySize) * kit.entries.size();
+
+    for (auto& entry : kit.entries)
+    {
+        Record record;
+        record.entry = &entry;
+        record.pathOffset = pathsStart + static_cast<int64>(paths.getDataSize());
+        record.pathBytes = static_cast<int>(entry.filePath.getNumBytesAsUTF8());
+        paths.write(entry.filePath.toRawUTF8(), static_cast<size_t>(record.pathBytes));
+
+        if (entry.sample != nullptr)
+        {
+            // Streamed samples would only contribute their attack
+            jassert(!entry.sample->isStreamed());
+
+            record.format = format;
+            record.numChannels = entry.sample->getNumChannels();
+            record.numFrames = entry.sample->getTotalLength();
+            record.sampleRate = entry.sample->sampleRate;
+            record.compressed = compress;
+        }
+
+        records.add(record);
+    }
+
+    TemporaryFile temp(file);
+
+    {
+        FileOutputStream out(temp.getFile());
+
+        if (out.failedToOpen())
+            return false;
+
+        bool ok = out.write(bundleMagic, sizeof(bundleMagic))
+               && out.writeInt(bundleVersion)
+               && out.writeInt(kit.defaultMode == PlaybackMode::oneShot ? oneShotFlag : 0)
+               && out.writeDouble(kit.sampleRate)
+               && out.writeInt(records.size());
+
+        for (int note : kit.noteMapping)
+            ok = ok && out.writeInt(note);
+
+        ok = ok && out.writeInt(static_cast<int>(kit.defaultMode));
+
+        for (int pad = 0; pad < SampleBundle::numPads; ++pad)
+            ok = ok && out.writeInt(kit.padHasMode[pad] ? static_cast<int>(kit.padModes[pad]) : padFollowsKit);
+
+        for (auto& record : records)
+            ok = ok && writeRecord(out, record);
+
+        ok = ok && out.write(paths.getData(), paths.getDataSize());
+
+        // Audio blocks, each on an aligned offset
+        for (auto& record : records)
+        {
+            if (!ok)
+                return false;
+
+            if (record.entry->sample == nullptr)
+                continue;
+
+            std::unique_ptr<SampleData> packedCopy;
+            const uint8* values = getPackedValues(*record.entry->sample, format, packedCopy);
+            const size_t numBytes = SampleData::getBytesPerValue(format)
+                                  * static_cast<size_t>(record.numFrames) * static_cast<size_t>(record.numChannels);
+
+            record.dataOffset = alignUp(out.getPosition());
+            ok = writePadding(out, record.dataOffset);
+
+            if (record.compressed)
+            {
+                GZIPCompressorOutputStream zipped(out, 6);
+                ok = ok && zipped.write(values, numBytes);
+                zipped.flush();
+            }
+            else
+            {
+                ok = ok && out.write(values, numBytes);
+            }
+
+            record.dataBytes = out.getPosition() - record.dataOffset;
+        }
+
+        // Now that every block's place is known, fill in the entry table
+        ok = ok && out.setPosition(headerSize);
+
+        for (auto& record : records)
+            ok = ok && writeRecord(out, record);
+
+        out.flush();
+
+        if (!ok || out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+bool SampleBundle::read(const File& file, Kit& kit)
+{
+    auto mapping = std::make_shared<const MemoryMappedFile>(file, MemoryMappedFile::readOnly);
+
+    const auto* data = static_cast<const uint8*>(mapping->getData());
+    const auto size = static_cast<int64>(mapping->getSize());
+
+    if (data == nullptr || size < getHeaderSize(1) || std::memcmp(data, bundleMagic, sizeof(bundleMagic)) != 0)
+        return false;
+
+    Cursor header(data, size, sizeof(bundleMagic));
+
+    const int version = header.readInt();
+
+    if (version < 1 || version > bundleVersion)
+        return false;
+
+    const int flags = header.readInt();
+    kit.sampleRate = header.readDouble();
+    const int numEntries = header.readInt();
+
+    // Older files only have the first bank; the others get the default notes
+    const int numPadNotes = getNumPadNotes(version);
+
+    for (int pad = 0; pad < SampleBundle::numPads; ++pad)
+        kit.noteMapping[pad] = pad < numPadNotes ? jlimit(0, 127, header.readInt()) : PadLayout::getDefaultNote(pad);
+
+    // Older files only say whether the kit is one-shot, and every pad
+    // follows it
+    if (version >= 6)
+    {
+        kit.defaultMode = toMode(header.readInt());
+
+        for (int pad = 0; pad < SampleBundle::numPads; ++pad)
+        {
+            const int mode = header.readInt();
+            kit.padHasMode[pad] = mode != padFollowsKit;
+            kit.padModes[pad] = kit.padHasMode[pad] ? toMode(mode) : kit.defaultMode;
+        }
+    }
+    else
+    {
+        kit.defaultMode = (flags & oneShotFlag) != 0 ? PlaybackMode::oneShot : PlaybackMode::gate;
+
+        for (int pad = 0; pad < SampleBundle::numPads; ++pad)
+        {
+            kit.padHasMode[pad] = false;
+            kit.padModes[pad] = kit.defaultMode;
+        }
+    }
+
+    const int64 recordsStart = getHeaderSize(version);
+
+    if (!header.isValid() || numEntries < 0 || recordsStart + static_cast<int64>(getEntrySize(version)) * numEntries > size)
+        return false;
+
+    kit.entries.clearQuick();
+
+    Cursor records(data, size, recordsStart);
+
+    for (int i = 0; i < numEntries; ++i)
+    {
+        Entry entry;
+        entry.midiNote = records.readInt();
+        entry.quality = static_cast<ResampleQuality>(jlimit(0, 2, records.readInt()));
+        entry.outputBus = records.readInt();
+        entry.pan = records.readFloat();
+        entry.chokeGroup = records.readInt();
+
+        const int formatIndex = records.readInt();
+        const int numChannels = records.readInt();
+        const int numFrames = records.readInt();
+        const double sampleRate = records.readDouble();
+        const int64 pathOffset = records.readInt64();
+        const int pathBytes = records.readInt();
+        const bool compressed = records.readInt() != 0;
+        const int64 dataOffset = records.readInt64();
+        const int64 dataBytes = records.readInt64();
+
+        if (version >= 2)
+        {
+            entry.zone = records.readInt();
+            entry.lowVelocity = jlimit(0, 127, records.readInt());
+            entry.highVelocity = jlimit(entry.lowVelocity, 127, records.readInt());
+            entry.selection = records.readInt();
+        }
+
+        if (version >= 3)
+        {
+            entry.envelope.attack = records.readFloat();
+            entry.envelope.decay = records.readFloat();
+            entry.envelope.sustain = records.readFloat();
+            entry.envelope.release = records.readFloat();
+        }
+
+        // Loop tails aren't stored; they are rebuilt from the audio
+        LoopPoints loop;
+
+        if (version >= 4)
+        {
+            loop.start = records.readInt();
+            loop.end = records.readInt();
+            loop.crossfade = records.readInt();
+        }
+
+        if (!records.isValid() || entry.midiNote < 0 || entry.midiNote > 127 || entry.zone < 0
+            || pathOffset < 0 || pathBytes < 0 || pathOffset + pathBytes > size)
+            return false;
+
+        entry.filePath = String::fromUTF8(reinterpret_cast<const char*>(data + pathOffset), pathBytes);
+
+        if (dataBytes > 0)
+        {
+            if (formatIndex < 0 || formatIndex > static_cast<int>(SampleFormat::float16)
+                || numChannels <= 0 || numChannels > maxChannels || numFrames <= 0 || sampleRate <= 0
+                || dataOffset < 0 || dataOffset + dataBytes > size)
+                return false;
+
+            const auto format = static_cast<SampleFormat>(formatIndex);
+            const size_t channelBytes = SampleData::getBytesPerValue(format) * static_cast<size_t>(numFrames);
+            const size_t numBytes = channelBytes * static_cast<size_t>(numChannels);
+
+            if (compressed)
+            {
+                // Checked before allocating, so a corrupt record can't ask for
+                // more memory than its block could ever hold
+                if (static_cast<uint64>(numBytes) > static_cast<uint64>(dataBytes * maxInflateRatio + inflateOverhead))
+                    return false;
+
+                MemoryInputStream block(data + dataOffset, static_cast<size_t>(dataBytes), false);
+                GZIPDecompressorInputStream unzipped(block);
+
+                HeapBlock<uint8> values(numBytes);
+                if (!inflateBlock(unzipped, values, numBytes))
+                    return false;
+
+                auto* sample = new SampleData(std::move(values), format, numChannels, numFrames, sampleRate);
+                if (loop.isValid())
+                    sample->setLoop(SampleLoop::create(*sample, loop));
+                entry.sample = sample;
+            }
+            else
+            {
+                if (static_cast<size_t>(dataBytes) != numBytes)
+                    return false;
+
+                touchAttack(data + dataOffset, channelBytes, numChannels,
+                            SampleData::getBytesPerValue(format) * static_cast<size_t>(sampleRate * attackSeconds));
+
+                auto* sample = new SampleData(mapping, data + dataOffset, format, numChannels, numFrames, sampleRate);
+                if (loop.isValid())
+                    sample->setLoop(SampleLoop::create(*sample, loop));
+                entry.sample = sample;
+            }
+        }
+
+        kit.entries.add(entry);
+    }
+
+    return true;
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    SampleBundle.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Single-file kit bundles with pre-decoded audio
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+#include "SampleData.h"
+#include "SampleResampler.h"
+#include "VoiceEnvelope.h"
+#include "EngineSettings.h"
+#include "PadLayout.h"
+
+//==============================================================================
+// A whole kit in one file: the settings, the pad-to-note table and every
+// sample's audio, already decoded, resampled to the rate the kit was saved
+// at and packed in the engine's sample format.
+//
+// Layout (little-endian):
+//  - header:  magic "TSKB", version, flags, sample rate, entry count, the
+//             pad notes (every bank's from version 5, the first 16 before),
+//             then from version 6 the kit's playback mode and each pad's
+//             own (or -1 where the pad follows the kit)
+//  - entries: one fixed-size record per MIDI note sample and extra zone,
+//             with its routing, velocity range, envelope, loop points,
+//             format, length and where its audio block is
+//  - paths:   the original file of each entry, UTF-8
+//  - audio:   one block per entry, starting on a 64-byte boundary, holding
+//             each channel's packed values in turn
+//
+// Loading maps the file once and hands out samples that read straight from
+// the mapping, so nothing is decoded or copied. Blocks written compressed
+// (zlib) are inflated into memory instead, trading load time for size.
+// The packed values are in the byte order of the machine that wrote them.
+class SampleBundle
+{
+public:
+    static constexpr const char* fileExtension = ".tskit";
+    static constexpr int numPads = PadLayout::numPads;
+
+    struct Entry
+    {
+        int midiNote = 0;
+        String filePath;            // The file the sample was loaded from
+        ResampleQuality quality = ResampleQuality::hermite;
+        int outputBus = 0;
+        float pan = 0.0f;
+        int chokeGroup = 0;
+        int zone = 0;               // 0 for the note's main sample, then its extra zones
+        int lowVelocity = 0;
+        int highVelocity = 127;
+        int selection = 0;          // ZoneSelection; the main sample's entry sets it
+        EnvelopeSettings envelope;  // Likewise
+        SampleData::Ptr sample;     // Null for notes that only carry settings
+    };
+
+    struct Kit
+    {
+        double sampleRate = 0;   // The rate the audio was saved at
+        PlaybackMode defaultMode = PlaybackMode::gate;
+        PlaybackMode padModes[numPads] = {};
+        bool padHasMode[numPads] = {};  // False where the pad follows defaultMode
+        int noteMapping[numPads] = {};
+        Array<Entry> entries;
+    };
+
+    // Packs and writes every entry's sample, which must already be at the
+    // kit's rate (each block records its own rate regardless). Writes to a
+    // temporary file first, so a failed save leaves any old bundle intact.
+    static bool write(const File& file, const Kit& kit, SampleFormat format, bool compress);
+
+    // Maps file and fills kit from it. False if it isn't a bundle this
+    // version understands or is truncated.
+    static bool read(const File& file, Kit& kit);
+
+    static bool isBundleFile(const File& file) { return file.hasFileExtension(fileExtension); }
+};
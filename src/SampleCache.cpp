@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    SampleCache.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Process-wide cache of decoded samples, shared between pads
+
+  ==============================================================================
+*/
+
+#include "SampleCache.h"
+
+//==============================================================================
+bool SampleCache::Key::operator==(const Key& other) const
+{
+    // Two paths to the same file (a link, or a different case on Windows)
+    // share one entry when the OS can identify the file
+    const bool sameFile = fileIdentifier != 0 ? fileIdentifier == other.fileIdentifier
+                                              : path == other.path;
+
+    return sameFile && modificationTime == other.modificationTime
+        && size == other.size && settings == other.settings;
+}
+
+SampleCache::Key SampleCache::makeKey(const File& file, const String& decodeSettings)
+{
+    const File target = file.getLinkedTarget();
+
+    Key key;
+    key.path = target.getFullPathName();
+    key.fileIdentifier = target.getFileIdentifier();
+    key.modificationTime = target.getLastModificationTime().toMilliseconds();
+    key.size = target.getSize();
+    key.settings = decodeSettings;
+    return key;
+}
+
+//==============================================================================
+SampleData::Ptr SampleCache::find(const Key& key)
+{
+    const ScopedLock sl(lock);
+
+    for (auto& entry : entries)
+    {
+        if (entry.key == key)
+        {
+            entry.lastUsed = ++useCounter;
+            return entry.sample;
+        }
+    }
+
+    return nullptr;
+}
+
+SampleData::Ptr SampleCache::add(const Key& key, SampleData::Ptr sample)
+{
+    // Released samples are freed once the lock is let go
+    Array<SampleData::Ptr> released;
+    SampleData::Ptr result;
+
+    {
+        const ScopedLock sl(lock);
+
+        for (auto& entry : entries)
+        {
+            if (entry.key == key)
+            {
+                entry.lastUsed = ++useCounter;
+                released.add(sample);
+                return entry.sample;
+            }
+        }
+
+        Entry entry;
+        entry.key = key;
+        entry.sample = sample;
+        entry.numBytes = static_cast<int64>(sample->getNumBytesInMemory());
+        entry.lastUsed = ++useCounter;
+        entries.add(entry);
+
+        result = sample;
+        trimLocked(released);
+    }
+
+    return result;
+}
+
+//==============================================================================
+void SampleCache::setBudget(int64 bytes)
+{
+    budget.store(jmax((int64) 0, bytes));
+    trim();
+}
+
+int64 SampleCache::getNumBytesCached() const
+{
+    const ScopedLock sl(lock);
+
+    int64 total = 0;
+    for (auto& entry : entries)
+        total += entry.numBytes;
+    return total;
+}
+
+void SampleCache::trim()
+{
+    Array<SampleData::Ptr> released;
+
+    const ScopedLock sl(lock);
+    trimLocked(released);
+}
+
+void SampleCache::trimLocked(Array<SampleData::Ptr>& released)
+{
+    int64 total = 0;
+    for (auto& entry : entries)
+        total += entry.numBytes;
+
+    const int64 limit = budget.load();
+
+    while (total > limit || entries.size() > maxEntries)
+    {
+        // Least recently used entry that only the cache refers to
+        int oldest = -1;
+
+        for (int i = 0; i < entries.size(); ++i)
+        {
+            const auto& entry = entries.getReference(i);
+
+            if (entry.sample->getReferenceCount() == 1
+                && (oldest < 0 || entry.lastUsed < entries.getReference(oldest).lastUsed))
+                oldest = i;
+        }
+
+        if (oldest < 0)
+            break;
+
+        total -= entries.getReference(oldest).numBytes;
+        released.add(entries.getReference(oldest).sample);
+        entries.remove(oldest);
+    }
+}
@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    SampleCache.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Process-wide cache of decoded samples, shared between pads
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+#include "SampleData.h"
+
+#include <atomic>
+
+//==============================================================================
+// Decoded samples keyed by file identity, so a file used on several pads
+// or notes is held once, and one that was recently dropped comes back
+// without decoding it again.
+//
+// A key is the file's identifier (its path where the OS has none), its
+// modification time and size, and the decode settings it was read with,
+// since those decide how the audio is stored. Handles are plain
+// SampleData references. Entries nothing outside the cache refers to are
+// idle; once the cache holds more than its budget, idle entries are
+// dropped least recently used first. Samples still in use are never
+// dropped, so the budget can be exceeded while they are. Mapped files
+// take no process memory, so the number of entries is bounded as well,
+// which also bounds the open file mappings.
+//
+// One instance per process (through SharedResourcePointer), used from the
+// message and loader threads, never from the audio thread.
+class SampleCache
+{
+public:
+    static constexpr int64 defaultBudget = 256 * 1024 * 1024;
+    static constexpr int maxEntries = 512;
+
+    struct Key
+    {
+        String path;
+        uint64 fileIdentifier = 0;
+        int64 modificationTime = 0;
+        int64 size = 0;
+        String settings;
+
+        bool operator==(const Key& other) const;
+    };
+
+    static Key makeKey(const File& file, const String& decodeSettings);
+
+    SampleCache() = default;
+
+    // The cached sample for key, or nullptr
+    SampleData::Ptr find(const Key& key);
+
+    // Caches sample under key and returns it. If another thread got there
+    // first, its copy is returned and this one is dropped.
+    SampleData::Ptr add(const Key& key, SampleData::Ptr sample);
+
+    // Bytes of audio the cache may keep in memory, counting samples in use
+    void setBudget(int64 bytes);
+    int64 getBudget() const noexcept { return budget.load(); }
+    int64 getNumBytesCached() const;
+
+    // Drops idle entries, oldest first, until the cache is within budget
+    void trim();
+
+private:
+    struct Entry
+    {
+        Key key;
+        SampleData::Ptr sample;
+        int64 numBytes = 0;
+        uint32 lastUsed = 0;
+    };
+
+    void trimLocked(Array<SampleData::Ptr>& released);
+
+    CriticalSection lock;
+    Array<Entry> entries;
+    uint32 useCounter = 0;
+    std::atomic<int64> budget { defaultBudget };
+
+    JUCE_DECLARE_NON_COPYABLE(SampleCache)
+};
@@ -0,0 +1,282 @@
+/*
+  ==============================================================================
+
+    SampleData.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Immutable, reference-counted sample audio
+
+  ==============================================================================
+*/
+
+#include "SampleData.h"
+
+//==============================================================================
+namespace
+{
+    constexpr float int16Scale = 32767.0f;
+    constexpr float int24Scale = 8388607.0f;
+
+    // IEEE 754 binary16, rounded to nearest; out-of-range values clip to the
+    // largest finite half rather than becoming infinity
+    uint16 floatToHalf(float value) noexcept
+    {
+        uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        const uint16 sign = static_cast<uint16>((bits >> 16) & 0x8000);
+        const int exponent = static_cast<int>((bits >> 23) & 0xff) - 127 + 15;
+        uint32 mantissa = bits & 0x7fffff;
+
+        if (((bits >> 23) & 0xff) == 0xff)
+            return static_cast<uint16>(sign | (mantissa != 0 ? 0x7e00 : 0x7bff));
+
+        if (exponent >= 31)
+            return static_cast<uint16>(sign | 0x7bff);
+
+        if (exponent <= 0)
+        {
+            if (exponent < -10)
+                return sign;
+
+            // Subnormal half
+            mantissa |= 0x800000;
+            const int shift = 14 - exponent;
+            uint32 half = mantissa >> shift;
+            if ((mantissa >> (shift - 1)) & 1)
+                ++half;
+            return static_cast<uint16>(sign | half);
+        }
+
+        // A carry out of the mantissa correctly bumps the exponent
+        uint32 half = (static_cast<uint32>(exponent) << 10) | (mantissa >> 13);
+        if (mantissa & 0x1000)
+            ++half;
+        return static_cast<uint16>(sign | jmin(half, (uint32) 0x7bff));
+    }
+
+    float halfToFloat(uint16 half) noexcept
+    {
+        const uint32 sign = static_cast<uint32>(half & 0x8000) << 16;
+        const uint32 exponent = (half >> 10) & 0x1f;
+        const uint32 mantissa = half & 0x3ff;
+
+        if (exponent == 0)
+        {
+            // Zero or subnormal: mantissa * 2^-24
+            const float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+            return sign != 0 ? -magnitude : magnitude;
+        }
+
+        const uint32 bits = exponent == 31 ? (sign | 0x7f800000 | (mantissa << 13))
+                                           : (sign | ((exponent + 112) << 23) | (mantissa << 13));
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    void pack(SampleFormat format, const float* source, uint8* dest, int numValues) noexcept
+    {
+        switch (format)
+        {
+            case SampleFormat::int16:
+            {
+                auto* out = reinterpret_cast<int16*>(dest);
+                for (int i = 0; i < numValues; ++i)
+                    out[i] = static_cast<int16>(roundToInt(jlimit(-1.0f, 1.0f, source[i]) * int16Scale));
+                break;
+            }
+
+            case SampleFormat::int24:
+                for (int i = 0; i < numValues; ++i)
+                {
+                    const int value = roundToInt(jlimit(-1.0f, 1.0f, source[i]) * int24Scale);
+                    dest[3 * i]     = static_cast<uint8>(value);
+                    dest[3 * i + 1] = static_cast<uint8>(value >> 8);
+                    dest[3 * i + 2] = static_cast<uint8>(value >> 16);
+                }
+                break;
+
+            case SampleFormat::float16:
+            {
+                auto* out = reinterpret_cast<uint16*>(dest);
+                for (int i = 0; i < numValues; ++i)
+                    out[i] = floatToHalf(source[i]);
+                break;
+            }
+
+            case SampleFormat::float32:
+                std::memcpy(dest, source, sizeof(float) * static_cast<size_t>(numValues));
+                break;
+        }
+    }
+
+    // The widening loops are kept branch-free so the compiler can vectorise them
+    void unpack(SampleFormat format, const uint8* source, float* dest, int numValues) noexcept
+    {
+        switch (format)
+        {
+            case SampleFormat::int16:
+            {
+                auto* in = reinterpret_cast<const int16*>(source);
+                for (int i = 0; i < numValues; ++i)
+                    dest[i] = static_cast<float>(in[i]) * (1.0f / int16Scale);
+                break;
+            }
+
+            case SampleFormat::int24:
+                for (int i = 0; i < numValues; ++i)
+                {
+                    const int value = static_cast<int>(source[3 * i])
+                                    | (static_cast<int>(source[3 * i + 1]) << 8)
+                                    | (static_cast<int>(static_cast<int8>(source[3 * i + 2])) * 65536);
+                    dest[i] = static_cast<float>(value) * (1.0f / int24Scale);
+                }
+                break;
+
+            case SampleFormat::float16:
+            {
+                auto* in = reinterpret_cast<const uint16*>(source);
+                for (int i = 0; i < numValues; ++i)
+                    dest[i] = halfToFloat(in[i]);
+                break;
+            }
+
+            case SampleFormat::float32:
+                std::memcpy(dest, source, sizeof(float) * static_cast<size_t>(numValues));
+                break;
+        }
+    }
+}
+
+//==============================================================================
+size_t SampleData::getBytesPerValue(SampleFormat sampleFormat) noexcept
+{
+    switch (sampleFormat)
+    {
+        case SampleFormat::int16:   return 2;
+        case SampleFormat::int24:   return 3;
+        case SampleFormat::float16: return 2;
+        case SampleFormat::float32: break;
+    }
+    return sizeof(float);
+}
+
+SampleData::SampleData(std::unique_ptr<MemoryMappedAudioFormatReader> mappedReader)
+    : sampleRate(mappedReader->sampleRate),
+      sourceFile(mappedReader->getFile()),
+      totalLength(static_cast<int>(mappedReader->lengthInSamples)),
+      numChannels(static_cast<int>(mappedReader->numChannels)),
+      storage(Storage::mapped),
+      reader(std::move(mappedReader))
+{
+}
+
+SampleData::SampleData(const AudioSampleBuffer& audio, double rate, SampleFormat packedFormat)
+    : sampleRate(rate),
+      totalLength(audio.getNumSamples()),
+      numChannels(audio.getNumChannels()),
+      storage(Storage::packed),
+      format(packedFormat),
+      bytesPerValue(getBytesPerValue(packedFormat))
+{
+    const size_t channelBytes = bytesPerValue * static_cast<size_t>(totalLength);
+    packedData.malloc(channelBytes * static_cast<size_t>(jmax(1, numChannels)));
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        pack(format, audio.getReadPointer(ch), packedData + channelBytes * static_cast<size_t>(ch), totalLength);
+
+    values = packedData;
+}
+
+SampleData::SampleData(HeapBlock<uint8>&& packedValues, SampleFormat packedFormat, int channels, int length, double rate)
+    : sampleRate(rate),
+      totalLength(length),
+      numChannels(channels),
+      storage(Storage::packed),
+      format(packedFormat),
+      packedData(std::move(packedValues)),
+      bytesPerValue(getBytesPerValue(packedFormat))
+{
+    values = packedData;
+}
+
+SampleData::SampleData(std::shared_ptr<const MemoryMappedFile> bundle, const uint8* bundleValues,
+                       SampleFormat packedFormat, int channels, int length, double rate)
+    : sampleRate(rate),
+      totalLength(length),
+      numChannels(channels),
+      storage(Storage::mapped),
+      format(packedFormat),
+      bundleMapping(std::move(bundle)),
+      values(bundleValues),
+      bytesPerValue(getBytesPerValue(packedFormat))
+{
+}
+
+size_t SampleData::getNumBytesInMemory() const noexcept
+{
+    if (storage == Storage::packed)
+        return bytesPerValue * static_cast<size_t>(totalLength) * static_cast<size_t>(numChannels);
+
+    return sizeof(float) * static_cast<size_t>(buffer.getNumSamples()) * static_cast<size_t>(buffer.getNumChannels());
+}
+
+String SampleData::formatToString(SampleFormat sampleFormat)
+{
+    switch (sampleFormat)
+    {
+        case SampleFormat::int16:   return "int16";
+        case SampleFormat::int24:   return "int24";
+        case SampleFormat::float16: return "float16";
+        case SampleFormat::float32: break;
+    }
+    return "float32";
+}
+
+SampleFormat SampleData::formatFromString(const String& name, SampleFormat defaultFormat)
+{
+    for (auto candidate : { SampleFormat::float32, SampleFormat::int16, SampleFormat::int24, SampleFormat::float16 })
+        if (name.equalsIgnoreCase(formatToString(candidate)))
+            return candidate;
+
+    return defaultFormat;
+}
+
+void SampleData::readFrames(int startFrame, int numFrames, float* const* dest, int numDestChannels) const noexcept
+{
+    jassert(numDestChannels <= numChannels);
+
+    if (reader != nullptr)
+    {
+        // Converts straight from the mapped PCM, silencing anything outside
+        // the file, without allocating
+        reader->read(dest, numDestChannels, startFrame, numFrames);
+        return;
+    }
+
+    // Float, packed and bundled audio: convert the part that exists and
+    // silence the rest
+
+    const int available = values != nullptr ? totalLength : buffer.getNumSamples();
+    const int first = jlimit(0, numFrames, -startFrame);
+    const int last = jlimit(first, numFrames, available - startFrame);
+    const size_t channelBytes = bytesPerValue * static_cast<size_t>(totalLength);
+
+    for (int ch = 0; ch < numDestChannels; ++ch)
+    {
+        FloatVectorOperations::clear(dest[ch], first);
+
+        if (last > first)
+        {
+            if (values != nullptr)
+                unpack(format, values + channelBytes * static_cast<size_t>(ch) + bytesPerValue * static_cast<size_t>(startFrame + first),
+                       dest[ch] + first, last - first);
+            else
+                FloatVectorOperations::copy(dest[ch] + first, buffer.getReadPointer(ch, startFrame + first), last - first);
+        }
+
+        FloatVectorOperations::clear(dest[ch] + last, numFrames - last);
+    }
+}
@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    SampleData.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Immutable, reference-counted sample audio
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+#include "SampleLoop.h"
+
+//==============================================================================
+// How a packed sample stores each value in memory
+enum class SampleFormat : int
+{
+    float32 = 0,    // Full precision, as decoded
+    int16,          // Half the memory of float
+    int24,          // Three bytes per value, for 24-bit sources
+    float16         // Half-float: half the memory, more headroom than int16
+};
+
+//==============================================================================
+// Decoded audio and the rate it is stored at. Never modified after
+// construction, so any thread holding a reference may read it freely.
+//
+// Audio is stored one of four ways:
+//  - memory:   all of it, as float, in buffer
+//  - streamed: buffer holds the first few hundred milliseconds; voices read
+//              the rest from sourceFile through SampleStreamer
+//  - mapped:   an uncompressed PCM file, or a block of a kit bundle
+//              (SampleBundle), mapped into memory
+//  - packed:   all of it in memory as int16, packed int24 or half-float
+// Voices read mapped and packed samples through readFrames, converting just
+// the frames they need to float as they play. Any storage may carry a
+// SampleLoop, attached by whoever creates the sample before sharing it.
+//
+// Shared by ButtonSample, ButtonSampleSound, MidiSamplerVoice and the
+// sample-rate cache. The last reference is only ever dropped away from the
+// audio thread: voices are kept alive by their sound, and replaced sounds
+// go through SampleReclaimer.
+class SampleData : public ReferenceCountedObject
+{
+public:
+    using Ptr = ReferenceCountedObjectPtr<SampleData>;
+
+    enum class Storage { memory, streamed, mapped, packed };
+
+    SampleData(AudioSampleBuffer&& audio, double rate)
+        : buffer(std::move(audio)), sampleRate(rate), totalLength(buffer.getNumSamples()),
+          numChannels(buffer.getNumChannels()), storage(Storage::memory)
+    {
+    }
+
+    // Streamed: audio holds the preloaded start of a file that is length samples long
+    SampleData(AudioSampleBuffer&& preload, double rate, const File& file, int length)
+        : buffer(std::move(preload)), sampleRate(rate), sourceFile(file), totalLength(length),
+          numChannels(buffer.getNumChannels()), storage(Storage::streamed)
+    {
+    }
+
+    // Mapped: takes a reader whose whole file is already mapped
+    explicit SampleData(std::unique_ptr<MemoryMappedAudioFormatReader> mappedReader);
+
+    // Packed: a compact copy of audio in the given format
+    SampleData(const AudioSampleBuffer& audio, double rate, SampleFormat format);
+
+    // Packed: takes values that are already packed, one run per channel
+    SampleData(HeapBlock<uint8>&& values, SampleFormat format, int numChannels, int length, double rate);
+
+    // Mapped: packed values inside a mapped kit bundle, which stays mapped
+    // for as long as any of its samples are alive
+    SampleData(std::shared_ptr<const MemoryMappedFile> bundle, const uint8* values,
+               SampleFormat format, int numChannels, int length, double rate);
+
+    int getNumSamples() const noexcept { return buffer.getNumSamples(); }   // Float samples held in buffer
+    int getNumChannels() const noexcept { return numChannels; }
+    int getTotalLength() const noexcept { return totalLength; }
+    bool isStreamed() const noexcept { return storage == Storage::streamed; }
+    bool isMapped() const noexcept { return storage == Storage::mapped; }
+    bool needsConversion() const noexcept { return storage == Storage::mapped || storage == Storage::packed; }
+
+    // Audio held in process memory (mapped files are paged by the OS instead)
+    size_t getNumBytesInMemory() const noexcept;
+
+    // Packed values, one run per channel (packed and bundled samples only)
+    const uint8* getPackedValues() const noexcept { return values; }
+    static size_t getBytesPerValue(SampleFormat format) noexcept;
+
+    static String formatToString(SampleFormat format);
+    static SampleFormat formatFromString(const String& name, SampleFormat defaultFormat);
+
+    // Converts frames [startFrame, startFrame + numFrames) of the first
+    // numDestChannels channels to float. Frames outside the sample are
+    // silence. Real-time safe for mapped samples, though the OS may have to
+    // page the file in.
+    void readFrames(int startFrame, int numFrames, float* const* dest, int numDestChannels) const noexcept;
+
+    // Sustain loop, for loop playback; null if the sample has none
+    const SampleLoop* getLoop() const noexcept { return loop.get(); }
+
+    // Only before the sample is shared: attaches its loop
+    void setLoop(std::unique_ptr<SampleLoop> newLoop) noexcept { loop = std::move(newLoop); }
+
+    const AudioSampleBuffer buffer;
+    const double sampleRate;
+    const File sourceFile;      // Only set for streamed samples and mapped files
+    const int totalLength;
+    const int numChannels;
+    const Storage storage;
+    const SampleFormat format = SampleFormat::float32;
+
+private:
+    std::unique_ptr<MemoryMappedAudioFormatReader> reader;  // Mapped files only
+    std::shared_ptr<const MemoryMappedFile> bundleMapping;  // Bundled samples only
+    HeapBlock<uint8> packedData;                            // Packed samples only, one run per channel
+    const uint8* values = nullptr;                          // packedData, or the bundle's copy
+    std::unique_ptr<const SampleLoop> loop;
+    size_t bytesPerValue = sizeof(float);
+
+    JUCE_DECLARE_NON_COPYABLE(SampleData)
+};
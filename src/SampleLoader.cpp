@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    SampleLoader.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Background sample decoding on a thread pool
+
+  ==============================================================================
+*/
+
+#include "SampleLoader.h"
+
+//==============================================================================
+SampleLoader::SampleLoader(int slots, DecodeFunction decodeFunction, std::function<void()> resultsReadyCallback)
+    : decode(std::move(decodeFunction)),
+      resultsReady(std::move(resultsReadyCallback)),
+      pool(jlimit(1, 4, SystemStats::getNumCpus() - 1)),
+      generations(new std::atomic<uint32>[static_cast<size_t>(slots)]),
+      numSlots(slots)
+{
+    for (int i = 0; i < numSlots; ++i)
+        generations[i].store(0);
+}
+
+SampleLoader::~SampleLoader()
+{
+    pool.removeAllJobs(true, 10000);
+}
+
+//==============================================================================
+void SampleLoader::queue(int slot, const File& file, ResampleQuality quality)
+{
+    jassert(isPositiveAndBelow(slot, numSlots));
+
+    // A batch that has completely finished starts the progress count again
+    if (!isBusy())
+    {
+        numQueued.store(0);
+        numFinished.store(0);
+    }
+
+    const uint32 generation = ++generations[slot];
+    ++numQueued;
+
+    pool.addJob([this, slot, file, quality, generation]
+    {
+        auto result = std::make_unique<Result>();
+        result->slot = slot;
+        result->file = file;
+        result->quality = quality;
+
+        // Skip the decode entirely if a newer request has already arrived
+        if (generations[slot].load() == generation)
+            result->succeeded = decode(file, result->decoded);
+
+        {
+            const ScopedLock sl(resultLock);
+            results.emplace_back(generation, std::move(result));
+        }
+
+        if (resultsReady != nullptr)
+            resultsReady();
+    });
+}
+
+void SampleLoader::cancel(int slot)
+{
+    jassert(isPositiveAndBelow(slot, numSlots));
+    ++generations[slot];
+}
+
+bool SampleLoader::popResult(Result& result)
+{
+    for (;;)
+    {
+        std::pair<uint32, std::unique_ptr<Result>> next;
+
+        {
+            const ScopedLock sl(resultLock);
+            if (results.empty())
+                return false;
+
+            next = std::move(results.front());
+            results.erase(results.begin());
+        }
+
+        ++numFinished;
+
+        // Stale results are dropped here; their buffers are freed with them
+        if (next.first == generations[next.second->slot].load())
+        {
+            result = std::move(*next.second);
+            return true;
+        }
+    }
+}
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    SampleLoader.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Background sample decoding on a thread pool
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+#include "SampleData.h"
+#include "SampleResampler.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+// Audio decoded away from the message thread, ready to be committed to a pad
+struct DecodedSample
+{
+    SampleData::Ptr sourceSample;      // At the file's own rate, unless converted
+    SampleData::Ptr convertedSample;   // At the device rate (convert-on-load)
+    double sourceSampleRate = 0;
+};
+
+//==============================================================================
+// Decodes files in parallel on a small thread pool. Finished results are
+// queued and handed back on the message thread, where the owner commits
+// them and publishes the new sounds to the synth.
+//
+// Each slot (a pad or a MIDI note) has a generation counter, so a load that
+// has been superseded by a newer one, or cancelled, is thrown away.
+class SampleLoader
+{
+public:
+    using DecodeFunction = std::function<bool(const File&, DecodedSample&)>;
+
+    struct Result
+    {
+        int slot = -1;
+        File file;
+        ResampleQuality quality = ResampleQuality::hermite;
+        bool succeeded = false;
+        DecodedSample decoded;
+    };
+
+    // decode runs on the pool threads; resultsReady may be called from any
+    // thread and should schedule a call to popResult on the message thread
+    SampleLoader(int numSlots, DecodeFunction decode, std::function<void()> resultsReady);
+    ~SampleLoader();
+
+    // Message thread
+    void queue(int slot, const File& file, ResampleQuality quality);
+    void cancel(int slot);
+    bool popResult(Result& result);
+
+    // Progress of the current batch; both reset once everything has finished
+    int getNumQueued() const noexcept { return numQueued.load(); }
+    int getNumFinished() const noexcept { return numFinished.load(); }
+    bool isBusy() const noexcept { return getNumFinished() < getNumQueued(); }
+
+private:
+    DecodeFunction decode;
+    std::function<void()> resultsReady;
+    ThreadPool pool;
+
+    std::unique_ptr<std::atomic<uint32>[]> generations;
+    int numSlots;
+
+    CriticalSection resultLock;
+    std::vector<std::pair<uint32, std::unique_ptr<Result>>> results;
+
+    std::atomic<int> numQueued { 0 };
+    std::atomic<int> numFinished { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(SampleLoader)
+};
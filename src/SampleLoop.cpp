@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    SampleLoop.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Sustain loop points and their precomputed crossfade tail
+
+  ==============================================================================
+*/
+
+#include "SampleLoop.h"
+#include "SampleData.h"
+
+//==============================================================================
+LoopPoints LoopPoints::scaled(double ratio) const noexcept
+{
+    LoopPoints result;
+    result.start = roundToInt(start * ratio);
+    result.end = roundToInt(end * ratio);
+    result.crossfade = roundToInt(crossfade * ratio);
+    return result;
+}
+
+LoopPoints LoopPoints::fromMetadata(const StringPairArray& metadata, int length, int crossfade)
+{
+    LoopPoints result;
+
+    if (metadata.getValue("NumSampleLoops", "0").getIntValue() <= 0)
+        return result;
+
+    // smpl loop ends are inclusive
+    result.start = metadata.getValue("Loop0Start", "0").getIntValue();
+    result.end = jmin(length, metadata.getValue("Loop0End", "0").getIntValue() + 1);
+    result.crossfade = jmax(0, crossfade);
+
+    if (!result.isValid())
+        return {};
+
+    return result;
+}
+
+//==============================================================================
+SampleLoop::SampleLoop(const LoopPoints& loopPoints, AudioSampleBuffer&& tailFrames)
+    : points(loopPoints), tail(std::move(tailFrames))
+{
+}
+
+std::unique_ptr<SampleLoop> SampleLoop::create(const SampleData& sample, LoopPoints points, AudioFormatReader* reader)
+{
+    points.end = jmin(points.end, sample.getTotalLength());
+
+    if (!points.isValid())
+        return nullptr;
+
+    points.crossfade = jlimit(0, jmin(points.start, points.end - points.start), points.crossfade);
+
+    // Voices play at most two channels
+    const int numChannels = jmin(2, sample.getNumChannels());
+    const int crossfadeStart = points.end - points.crossfade;
+    const int tailStart = crossfadeStart - margin;
+    const int tailLength = points.crossfade + 2 * margin + 1;
+    const int loopLength = points.end - points.start;
+
+    auto read = [&](AudioSampleBuffer& dest, int startFrame)
+    {
+        if (reader != nullptr)
+            reader->read(&dest, 0, dest.getNumSamples(), startFrame, true, numChannels > 1);
+        else
+            sample.readFrames(startFrame, dest.getNumSamples(), dest.getArrayOfWritePointers(), numChannels);
+    };
+
+    // The frames leading up to end, and those the loop jumps back to
+    AudioSampleBuffer tail(numChannels, tailLength);
+    AudioSampleBuffer wrapped(numChannels, tailLength);
+    read(tail, tailStart);
+    read(wrapped, tailStart - loopLength);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* dest = tail.getWritePointer(ch);
+        const float* from = wrapped.getReadPointer(ch);
+
+        // Equal-power crossfade, since loops in pads and drones are rarely
+        // in phase with their start
+        for (int i = 0; i < points.crossfade; ++i)
+        {
+            const float t = (static_cast<float>(i) + 0.5f) / static_cast<float>(points.crossfade);
+            const float angle = t * MathConstants<float>::halfPi;
+            dest[margin + i] = dest[margin + i] * std::cos(angle) + from[margin + i] * std::sin(angle);
+        }
+
+        // From end on, the loop's start
+        FloatVectorOperations::copy(dest + margin + points.crossfade, from + margin + points.crossfade, margin + 1);
+    }
+
+    return std::make_unique<SampleLoop>(points, std::move(tail));
+}
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    SampleLoop.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Sustain loop points and their precomputed crossfade tail
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+
+class SampleData;
+
+//==============================================================================
+// A forward loop over frames [start, end) of a sample. The last crossfade
+// frames before end are blended with the frames before start, so the join
+// is smooth even where the waveform doesn't line up.
+struct LoopPoints
+{
+    int start = 0;
+    int end = 0;
+    int crossfade = 0;
+
+    bool isValid() const noexcept { return start >= 0 && end > start; }
+
+    // The same points in a copy resampled by ratio (target rate / source rate)
+    LoopPoints scaled(double ratio) const noexcept;
+
+    // The sample's first loop, from the "Loop0Start"/"Loop0End" metadata
+    // JUCE reads from a WAV file's smpl chunk, with crossfade frames. Not
+    // valid if the file has none or it doesn't fit in length frames.
+    static LoopPoints fromMetadata(const StringPairArray& metadata, int length, int crossfade);
+};
+
+//==============================================================================
+// Loop points plus a short tail buffer, built once at load time.
+//
+// The tail holds the frames around the loop's end as they should sound:
+// up to the crossfade the sample itself, then the crossfade already mixed,
+// then the frames from the loop's start. A voice reads the sample up to the
+// crossfade, then the tail up to end, then jumps back by the loop length,
+// so every read is contiguous (resampler taps included) and the only wrap
+// check is once per segment.
+//
+// Owned by its SampleData and immutable like it.
+class SampleLoop
+{
+public:
+    static constexpr int margin = 8;   // Frames the resampler reads either side of a position
+
+    // Reads the frames it needs from reader if given (streamed samples hold
+    // only their start in memory), otherwise from sample. The crossfade is
+    // shortened to fit before start and inside the loop. Null if points
+    // aren't valid for the sample.
+    static std::unique_ptr<SampleLoop> create(const SampleData& sample, LoopPoints points,
+                                              AudioFormatReader* reader = nullptr);
+
+    const LoopPoints points;
+
+    int getStart() const noexcept { return points.start; }
+    int getEnd() const noexcept { return points.end; }
+    int getLength() const noexcept { return points.end - points.start; }
+    int getCrossfadeStart() const noexcept { return points.end - points.crossfade; }
+
+    // Frames [getTailStart(), getTailStart() + getTailLength()) in the
+    // sample's own frame numbering, one or two channels
+    const float* const* getTail() const noexcept { return tail.getArrayOfReadPointers(); }
+    int getTailStart() const noexcept { return getCrossfadeStart() - margin; }
+    int getTailLength() const noexcept { return tail.getNumSamples(); }
+
+    size_t getNumBytes() const noexcept
+    {
+        return static_cast<size_t>(tail.getNumChannels()) * static_cast<size_t>(tail.getNumSamples()) * sizeof(float);
+    }
+
+    SampleLoop(const LoopPoints& points, AudioSampleBuffer&& tail);
+
+private:
+    const AudioSampleBuffer tail;
+
+    JUCE_DECLARE_NON_COPYABLE(SampleLoop)
+};
@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    SampleRateCache.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Cache of samples converted to the device sample rate
+
+  ==============================================================================
+*/
+
+#include "SampleRateCache.h"
+#include "SampleRenderKernels.h"
+#include "SampleResampler.h"
+
+//==============================================================================
+SampleData::Ptr SampleRateCache::find(const File& file, double targetRate) const
+{
+    auto path = file.getFullPathName();
+    auto modificationTime = file.getLastModificationTime().toMilliseconds();
+
+    const ScopedLock sl(lock);
+
+    for (auto& entry : entries)
+        if (entry.targetRate == targetRate && entry.modificationTime == modificationTime && entry.path == path)
+            return entry.sample;
+
+    return nullptr;
+}
+
+SampleData::Ptr SampleRateCache::add(const File& file, const AudioSampleBuffer& decoded,
+                                     double sourceRate, double targetRate, const LoopPoints& loop)
+{
+    // Conversion happens outside the lock so lookups aren't held up by it
+    SampleData::Ptr sample = new SampleData(convert(decoded, sourceRate, targetRate), targetRate);
+
+    if (loop.isValid() && sourceRate > 0)
+        sample->setLoop(SampleLoop::create(*sample, loop.scaled(targetRate / sourceRate)));
+
+    Entry entry;
+    entry.path = file.getFullPathName();
+    entry.modificationTime = file.getLastModificationTime().toMilliseconds();
+    entry.targetRate = targetRate;
+    entry.sample = sample;
+
+    const ScopedLock sl(lock);
+
+    // Replace any stale copy of the same file at this rate
+    for (int i = entries.size(); --i >= 0;)
+        if (entries.getReference(i).path == entry.path && entries.getReference(i).targetRate == targetRate)
+            entries.remove(i);
+
+    entries.add(entry);
+    return sample;
+}
+
+SampleData::Ptr SampleRateCache::findOrCreate(AudioFormatManager& formatManager, const File& file, double targetRate,
+                                              double loopCrossfadeSeconds)
+{
+    if (auto cached = find(file, targetRate))
+        return cached;
+
+    std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr)
+        return nullptr;
+
+    AudioSampleBuffer decoded(static_cast<int>(reader->numChannels), static_cast<int>(reader->lengthInSamples));
+    reader->read(&decoded, 0, static_cast<int>(reader->lengthInSamples), 0, true, true);
+
+    const auto loop = LoopPoints::fromMetadata(reader->metadataValues, decoded.getNumSamples(),
+                                               roundToInt(loopCrossfadeSeconds * reader->sampleRate));
+
+    return add(file, decoded, reader->sampleRate, targetRate, loop);
+}
+
+void SampleRateCache::removeUnused()
+{
+    const ScopedLock sl(lock);
+
+    for (int i = entries.size(); --i >= 0;)
+        if (entries.getReference(i).sample->getReferenceCount() == 1)
+            entries.remove(i);
+}
+
+//==============================================================================
+AudioSampleBuffer SampleRateCache::convert(const AudioSampleBuffer& source, double sourceRate, double targetRate)
+{
+    const int sourceLength = source.getNumSamples();
+
+    if (sourceRate <= 0 || targetRate <= 0 || sourceRate == targetRate)
+        return AudioSampleBuffer(source);
+
+    const double step = sourceRate / targetRate;
+    const int outputLength = RenderKernels::numSamplesBeforeEnd(0.0, step, sourceLength);
+
+    AudioSampleBuffer result(source.getNumChannels(), outputLength);
+
+    for (int ch = 0; ch < source.getNumChannels(); ++ch)
+    {
+        const float* channel = source.getReadPointer(ch);
+        float* dest = result.getWritePointer(ch);
+
+        for (int done = 0; done < outputLength;)
+        {
+            const int segment = jmin(RenderKernels::maxSegmentSize, outputLength - done);
+            Resampler::mixDown(ResampleQuality::sinc, dest + done, &channel, 1, sourceLength,
+                               (double) done * step, step, 1.0f, segment);
+            done += segment;
+        }
+    }
+
+    return result;
+}
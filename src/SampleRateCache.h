@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    SampleRateCache.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Cache of samples converted to the device sample rate
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+#include "SampleData.h"
+
+//==============================================================================
+// Converted samples keyed by (file path, modification time, target rate).
+// Used from the message thread and the conversion thread, never from the
+// audio thread.
+class SampleRateCache
+{
+public:
+    SampleRateCache() = default;
+
+    // Returns the cached copy of file at targetRate, or nullptr
+    SampleData::Ptr find(const File& file, double targetRate) const;
+
+    // Converts an already-decoded buffer and caches the result, with loop
+    // (in source frames) moved to the new rate if it is valid
+    SampleData::Ptr add(const File& file, const AudioSampleBuffer& decoded,
+                        double sourceRate, double targetRate, const LoopPoints& loop = {});
+
+    // Decodes and converts file unless a current copy is already cached.
+    // A loop in the file gets a crossfade of loopCrossfadeSeconds.
+    SampleData::Ptr findOrCreate(AudioFormatManager& formatManager, const File& file, double targetRate,
+                                 double loopCrossfadeSeconds = 0.0);
+
+    // Drops entries that nothing outside the cache refers to any more
+    void removeUnused();
+
+    // Resamples every channel of source with the windowed-sinc kernel
+    static AudioSampleBuffer convert(const AudioSampleBuffer& source, double sourceRate, double targetRate);
+
+private:
+    struct Entry
+    {
+        String path;
+        int64 modificationTime = 0;
+        double targetRate = 0;
+        SampleData::Ptr sample;
+    };
+
+    CriticalSection lock;
+    Array<Entry> entries;
+
+    JUCE_DECLARE_NON_COPYABLE(SampleRateCache)
+};
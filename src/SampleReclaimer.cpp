@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    SampleReclaimer.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Deferred reclamation of objects the audio thread may still be reading
+
+  ==============================================================================
+*/
+
+#include "SampleReclaimer.h"
+
+//==============================================================================
+SampleReclaimer::SampleReclaimer()
+    : Thread("Sample reclaimer")
+{
+    startThread();
+}
+
+SampleReclaimer::~SampleReclaimer()
+{
+    stopThread(2000);
+
+    // Anything still referenced elsewhere lives on with its other owners
+    const ScopedLock sl(lock);
+    retired.clear();
+}
+
+//==============================================================================
+void SampleReclaimer::retire(ReferenceCountedObject* object)
+{
+    if (object == nullptr)
+        return;
+
+    // Read after the swap: if the audio thread wasn't inside a block, it
+    // can only ever see the new pointer from here on
+    const uint32 epoch = renderEpoch.load();
+
+    const ScopedLock sl(lock);
+    retired.add({ ReferenceCountedObjectPtr<ReferenceCountedObject>(object), epoch });
+}
+
+void SampleReclaimer::collect()
+{
+    const uint32 epoch = renderEpoch.load();
+
+    // Freed outside the lock so retire() is never held up by a large free
+    Array<Retired> toFree;
+
+    {
+        const ScopedLock sl(lock);
+
+        for (int i = retired.size(); --i >= 0;)
+        {
+            auto& entry = retired.getReference(i);
+
+            // Safe once no block that could have read the old pointer is
+            // still running, and nothing else holds a reference
+            const bool audioThreadDone = (entry.epoch & 1) == 0 || epoch != entry.epoch;
+
+            if (audioThreadDone && entry.object->getReferenceCount() == 1)
+            {
+                toFree.add(entry);
+                retired.remove(i);
+            }
+        }
+    }
+}
+
+int SampleReclaimer::getNumPending() const
+{
+    const ScopedLock sl(lock);
+    return retired.size();
+}
+
+void SampleReclaimer::run()
+{
+    while (!threadShouldExit())
+    {
+        collect();
+        wait(100);
+    }
+}
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    SampleReclaimer.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Deferred reclamation of objects the audio thread may still be reading
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+
+#include <atomic>
+
+//==============================================================================
+// Epoch-based garbage collector for sounds and sample data.
+//
+// The audio thread brackets each block with beginBlock/endBlock, so the
+// epoch is odd while it is rendering. An object retired during an odd epoch
+// is kept until the epoch moves on, since the block in flight may have read
+// its raw pointer before the swap. Once that is true and the reclaimer holds
+// the only reference, the object is freed on the reclaimer's own thread -
+// never on the audio thread, and without the audio thread taking a lock.
+class SampleReclaimer : private Thread
+{
+public:
+    SampleReclaimer();
+    ~SampleReclaimer() override;
+
+    // Audio thread
+    void beginBlock() noexcept { renderEpoch.fetch_add(1); }
+    void endBlock() noexcept { renderEpoch.fetch_add(1); }
+
+    // Any thread but the audio thread: hand over an object whose pointer has
+    // just been unpublished
+    void retire(ReferenceCountedObject* object);
+
+    // Frees whatever is safe to free now (called periodically by the thread)
+    void collect();
+
+    int getNumPending() const;
+
+private:
+    void run() override;
+
+    std::atomic<uint32> renderEpoch { 0 };
+
+    struct Retired
+    {
+        ReferenceCountedObjectPtr<ReferenceCountedObject> object;
+        uint32 epoch;
+    };
+
+    CriticalSection lock;
+    Array<Retired> retired;
+
+    JUCE_DECLARE_NON_COPYABLE(SampleReclaimer)
+};
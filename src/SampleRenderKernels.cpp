@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    SampleRenderKernels.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Block-based render kernels for MidiSamplerVoice
+
+  ==============================================================================
+*/
+
+#include "SampleRenderKernels.h"
+
+namespace RenderKernels
+{
+int numSamplesBeforeEnd(double position, double step, int sourceLength) noexcept
+{
+    if (position >= sourceLength || step <= 0.0)
+        return 0;
+
+    auto count = (int64) std::ceil((sourceLength - position) / step);
+
+    // Guard against rounding putting the last read index on sourceLength
+    while (count > 0 && (int64) (position + (double) (count - 1) * step) >= sourceLength)
+        --count;
+
+    return (int) jmin(count, (int64) std::numeric_limits<int>::max());
+}
+
+void mixDownUnity(float* dest, const float* const* source, int numChannels,
+                  int startIndex, float gain, int numSamples) noexcept
+{
+    jassert(numChannels > 0);
+
+    FloatVectorOperations::copyWithMultiply(dest, source[0] + startIndex, gain, numSamples);
+
+    for (int ch = 1; ch < numChannels; ++ch)
+        FloatVectorOperations::addWithMultiply(dest, source[ch] + startIndex, gain, numSamples);
+}
+
+void panGains(float pan, bool stereoSource, float& leftGain, float& rightGain) noexcept
+{
+    pan = jlimit(-1.0f, 1.0f, pan);
+
+    if (stereoSource)
+    {
+        leftGain = jmin(1.0f, 1.0f - pan);
+        rightGain = jmin(1.0f, 1.0f + pan);
+        return;
+    }
+
+    const float angle = (pan + 1.0f) * MathConstants<float>::pi * 0.25f;
+    leftGain = MathConstants<float>::sqrt2 * std::cos(angle);
+    rightGain = MathConstants<float>::sqrt2 * std::sin(angle);
+}
+
+void applyGainRamp(float* samples, float startGain, float step, int numSamples) noexcept
+{
+    if (step == 0.0f)
+    {
+        if (startGain != 1.0f)
+            FloatVectorOperations::multiply(samples, startGain, numSamples);
+        return;
+    }
+
+    // Branch-free so the compiler can vectorise it
+    for (int i = 0; i < numSamples; ++i)
+        samples[i] *= startGain + step * static_cast<float>(i);
+}
+
+void addToBus(AudioBuffer<float>& output, int firstChannel, int numBusChannels, int startSample,
+              const float* left, const float* right, float leftGain, float rightGain,
+              int numSamples) noexcept
+{
+    if (numBusChannels >= 2)
+    {
+        FloatVectorOperations::addWithMultiply(output.getWritePointer(firstChannel, startSample), left, leftGain, numSamples);
+        FloatVectorOperations::addWithMultiply(output.getWritePointer(firstChannel + 1, startSample), right, rightGain, numSamples);
+    }
+    else if (numBusChannels == 1)
+    {
+        float* dest = output.getWritePointer(firstChannel, startSample);
+        FloatVectorOperations::addWithMultiply(dest, left, 0.5f * leftGain, numSamples);
+        FloatVectorOperations::addWithMultiply(dest, right, 0.5f * rightGain, numSamples);
+    }
+}
+}
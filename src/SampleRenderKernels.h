@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    SampleRenderKernels.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Block-based render kernels for MidiSamplerVoice
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+
+//==============================================================================
+// Kernels that render a whole constant-ratio segment of a voice at once
+// (resampled segments go through SampleResampler).
+// The voice splits each block into segments that end either at the end of
+// the block or at the end of the sample, so none of these check bounds.
+// Each source channel is rendered separately, so stereo samples stay stereo.
+namespace RenderKernels
+{
+    // Largest segment a kernel is asked to handle (size of the voice's scratch)
+    constexpr int maxSegmentSize = 256;
+
+    // Number of output samples that can be read from position onwards, stepping
+    // by step, before the read index reaches sourceLength
+    int numSamplesBeforeEnd(double position, double step, int sourceLength) noexcept;
+
+    // dest = gain * sum of source channels, read contiguously from startIndex
+    void mixDownUnity(float* dest, const float* const* source, int numChannels,
+                      int startIndex, float gain, int numSamples) noexcept;
+
+    // Left and right gains for pan in [-1, 1]. Mono sources use a
+    // constant-power law with unity gain in the centre; stereo sources are
+    // balanced, so the centre leaves both channels untouched.
+    void panGains(float pan, bool stereoSource, float& leftGain, float& rightGain) noexcept;
+
+    // samples[i] *= startGain + i * step, for envelopes and fades. A flat
+    // ramp is a plain multiply, or nothing at unity.
+    void applyGainRamp(float* samples, float startGain, float step, int numSamples) noexcept;
+
+    // Adds a segment to the output bus starting at firstChannel, in place:
+    // left and right to a stereo bus, their average to a mono one. Pass the
+    // same pointer twice for a mono source.
+    void addToBus(AudioBuffer<float>& output, int firstChannel, int numBusChannels, int startSample,
+                  const float* left, const float* right, float leftGain, float rightGain,
+                  int numSamples) noexcept;
+}
@@ -0,0 +1,308 @@
+/*
+  ==============================================================================
+
+    SampleResampler.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Interpolating resampler kernels with selectable quality
+
+  ==============================================================================
+*/
+
+#include "SampleResampler.h"
+#include "SampleRenderKernels.h"
+
+namespace Resampler
+{
+namespace
+{
+    //==============================================================================
+    constexpr int sincTaps = 16;
+    constexpr int sincTapsBefore = sincTaps / 2 - 1;  // Taps before the read index
+    constexpr int sincPhases = 256;                   // Fractional positions per sample
+    constexpr int sincBands = 5;                      // Tables for step <= 1, 2, 4, 8 and above
+
+    // Coefficient rows for each fractional phase, with one extra row so the
+    // kernel can interpolate between neighbouring phases
+    struct SincTables
+    {
+        float coefficients[sincBands][sincPhases + 1][sincTaps];
+
+        SincTables()
+        {
+            for (int band = 0; band < sincBands; ++band)
+            {
+                // Lower the cutoff when reading faster than the source rate
+                // so pitched-up notes don't alias
+                const double cutoff = 0.92 / (double) (1 << band);
+
+                for (int phase = 0; phase <= sincPhases; ++phase)
+                {
+                    auto* row = coefficients[band][phase];
+                    const double fraction = (double) phase / (double) sincPhases;
+                    double sum = 0.0;
+
+                    for (int tap = 0; tap < sincTaps; ++tap)
+                    {
+                        const double distance = (double) (tap - sincTapsBefore) - fraction;
+                        const double x = cutoff * distance;
+                        const double sinc = std::abs(x) < 1.0e-9 ? 1.0 : std::sin(MathConstants<double>::pi * x) / (MathConstants<double>::pi * x);
+
+                        // Blackman window over the full kernel width
+                        const double u = distance / (double) (sincTaps / 2);
+                        const double window = std::abs(u) >= 1.0 ? 0.0
+                                            : 0.42 + 0.5 * std::cos(MathConstants<double>::pi * u)
+                                                   + 0.08 * std::cos(2.0 * MathConstants<double>::pi * u);
+
+                        row[tap] = (float) (sinc * window);
+                        sum += row[tap];
+                    }
+
+                    // Unity gain at DC for every phase
+                    for (int tap = 0; tap < sincTaps; ++tap)
+                        row[tap] = (float) (row[tap] / sum);
+                }
+            }
+        }
+    };
+
+    const SincTables& getSincTables()
+    {
+        static const SincTables tables;
+        return tables;
+    }
+
+    //==============================================================================
+    // Interior reads, where every tap is known to be inside the source
+    struct DirectReader
+    {
+        const float* data;
+        int length;
+
+        float operator()(int index) const noexcept { return data[index]; }
+    };
+
+    // Reads near either end of the source, treating missing taps as silence
+    struct PaddedReader
+    {
+        const float* data;
+        int length;
+
+        float operator()(int index) const noexcept { return isPositiveAndBelow(index, length) ? data[index] : 0.0f; }
+    };
+
+    //==============================================================================
+    template <typename Reader>
+    void linearKernel(float* dest, const float* const* source, int numChannels, int sourceLength,
+                      const int* indices, const float* fractions, float gain, int numSamples) noexcept
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const Reader read { source[ch], sourceLength };
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float y0 = read(indices[i]);
+                const float y1 = read(indices[i] + 1);
+                const float value = gain * (y0 + fractions[i] * (y1 - y0));
+                dest[i] = ch == 0 ? value : dest[i] + value;
+            }
+        }
+    }
+
+    template <typename Reader>
+    void hermiteKernel(float* dest, const float* const* source, int numChannels, int sourceLength,
+                       const int* indices, const float* fractions, float gain, int numSamples) noexcept
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const Reader read { source[ch], sourceLength };
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const int index = indices[i];
+                const float x = fractions[i];
+                const float ym1 = read(index - 1);
+                const float y0 = read(index);
+                const float y1 = read(index + 1);
+                const float y2 = read(index + 2);
+
+                const float c1 = 0.5f * (y1 - ym1);
+                const float c2 = ym1 - 2.5f * y0 + 2.0f * y1 - 0.5f * y2;
+                const float c3 = 0.5f * (y2 - ym1) + 1.5f * (y0 - y1);
+                const float value = gain * (((c3 * x + c2) * x + c1) * x + y0);
+
+                dest[i] = ch == 0 ? value : dest[i] + value;
+            }
+        }
+    }
+
+    template <typename Reader>
+    void sincKernel(float* dest, const float* const* source, int numChannels, int sourceLength,
+                    const int* indices, const float* fractions, float gain, double step, int numSamples) noexcept
+    {
+        // ceil(log2(step)), so the cutoff is always at or below the new
+        // Nyquist. Beyond 16 (four octaves up) the last band's cutoff is
+        // still too high and those notes alias; 16 taps can't go lower.
+        int band = 0;
+        while (band < sincBands - 1 && step > (double) (1 << band))
+            ++band;
+
+        const auto& table = getSincTables().coefficients[band];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // Blend the two nearest phase rows
+            const float phasePosition = fractions[i] * (float) sincPhases;
+            const int phase = jmin((int) phasePosition, sincPhases - 1);
+            const float blend = phasePosition - (float) phase;
+            const float* rowA = table[phase];
+            const float* rowB = table[phase + 1];
+
+            float coefficients[sincTaps];
+            for (int tap = 0; tap < sincTaps; ++tap)
+                coefficients[tap] = gain * (rowA[tap] + blend * (rowB[tap] - rowA[tap]));
+
+            const int first = indices[i] - sincTapsBefore;
+            float sum = 0.0f;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const Reader read { source[ch], sourceLength };
+
+                for (int tap = 0; tap < sincTaps; ++tap)
+                    sum += coefficients[tap] * read(first + tap);
+            }
+
+            dest[i] = sum;
+        }
+    }
+
+    //==============================================================================
+    int getTapsBefore(ResampleQuality quality) noexcept
+    {
+        switch (quality)
+        {
+            case ResampleQuality::hermite: return 1;
+            case ResampleQuality::sinc:    return sincTapsBefore;
+            case ResampleQuality::linear:
+            default:                       return 0;
+        }
+    }
+
+    int getTapsAfter(ResampleQuality quality) noexcept
+    {
+        switch (quality)
+        {
+            case ResampleQuality::hermite: return 2;
+            case ResampleQuality::sinc:    return sincTaps - sincTapsBefore - 1;
+            case ResampleQuality::linear:
+            default:                       return 1;
+        }
+    }
+
+    template <typename Reader>
+    void runKernel(ResampleQuality quality, float* dest, const float* const* source, int numChannels, int sourceLength,
+                   const int* indices, const float* fractions, float gain, double step, int numSamples) noexcept
+    {
+        switch (quality)
+        {
+            case ResampleQuality::hermite:
+                hermiteKernel<Reader>(dest, source, numChannels, sourceLength, indices, fractions, gain, numSamples);
+                break;
+
+            case ResampleQuality::sinc:
+                sincKernel<Reader>(dest, source, numChannels, sourceLength, indices, fractions, gain, step, numSamples);
+                break;
+
+            case ResampleQuality::linear:
+            default:
+                linearKernel<Reader>(dest, source, numChannels, sourceLength, indices, fractions, gain, numSamples);
+                break;
+        }
+    }
+}
+
+//==============================================================================
+String qualityToString(ResampleQuality quality)
+{
+    switch (quality)
+    {
+        case ResampleQuality::linear:  return "linear";
+        case ResampleQuality::hermite: return "hermite";
+        case ResampleQuality::sinc:    return "sinc";
+        default:                       break;
+    }
+
+    return {};
+}
+
+ResampleQuality qualityFromString(const String& name, ResampleQuality defaultQuality)
+{
+    for (auto quality : { ResampleQuality::linear, ResampleQuality::hermite, ResampleQuality::sinc })
+        if (name.equalsIgnoreCase(qualityToString(quality)))
+            return quality;
+
+    return defaultQuality;
+}
+
+void initialiseTables()
+{
+    getSincTables();
+}
+
+void mixDown(ResampleQuality quality, float* dest, const float* const* source, int numChannels,
+             int sourceLength, double position, double step, float gain, int numSamples) noexcept
+{
+    jassert(numChannels > 0 && numSamples <= RenderKernels::maxSegmentSize);
+
+    int indices[RenderKernels::maxSegmentSize];
+    float fractions[RenderKernels::maxSegmentSize];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const double readPosition = position + (double) i * step;
+        indices[i] = (int) readPosition;
+        fractions[i] = (float) (readPosition - (double) indices[i]);
+    }
+
+    const int tapsBefore = getTapsBefore(quality);
+    const int lastDirectIndex = sourceLength - getTapsAfter(quality);
+
+    // Split into runs that need bounds checks (near either end of the
+    // source) and an interior run that reads directly
+    int done = 0;
+    while (done < numSamples)
+    {
+        const double runPosition = position + (double) done * step;
+        const int remaining = numSamples - done;
+        int run = 0;
+        bool direct = false;
+
+        if (indices[done] < tapsBefore)
+        {
+            run = RenderKernels::numSamplesBeforeEnd(runPosition, step, tapsBefore);
+        }
+        else
+        {
+            run = RenderKernels::numSamplesBeforeEnd(runPosition, step, lastDirectIndex);
+            direct = run > 0;
+
+            if (!direct)
+                run = remaining;
+        }
+
+        run = jlimit(1, remaining, run);
+
+        if (direct)
+            runKernel<DirectReader>(quality, dest + done, source, numChannels, sourceLength,
+                                    indices + done, fractions + done, gain, step, run);
+        else
+            runKernel<PaddedReader>(quality, dest + done, source, numChannels, sourceLength,
+                                    indices + done, fractions + done, gain, step, run);
+
+        done += run;
+    }
+}
+}
@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    SampleResampler.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Interpolating resampler kernels with selectable quality
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+
+//==============================================================================
+// Interpolation quality, chosen per sound
+enum class ResampleQuality : int
+{
+    linear = 0,     // 2 taps, cheapest
+    hermite,        // 4-point, 3rd-order Hermite
+    sinc            // 16-tap polyphase windowed-sinc, anti-aliased up to a step of 16
+};
+
+//==============================================================================
+namespace Resampler
+{
+    String qualityToString(ResampleQuality quality);
+    ResampleQuality qualityFromString(const String& name, ResampleQuality defaultQuality);
+
+    // Builds the windowed-sinc coefficient tables. Called from the message
+    // thread at startup so the audio thread never pays for it.
+    void initialiseTables();
+
+    // dest = gain * sum of source channels, interpolated at position + i * step.
+    // Reads can start anywhere before sourceLength; taps falling outside the
+    // source are treated as silence, so the caller only has to stop the note
+    // once position reaches sourceLength.
+    void mixDown(ResampleQuality quality, float* dest, const float* const* source, int numChannels,
+                 int sourceLength, double position, double step, float gain, int numSamples) noexcept;
+}
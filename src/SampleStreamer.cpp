@@ -0,0 +1,253 @@
+/*
+  ==============================================================================
+
+    SampleStreamer.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Disk streaming for samples too large to hold in memory
+
+  ==============================================================================
+*/
+
+#include "SampleStreamer.h"
+
+//==============================================================================
+bool SampleStreamer::Stream::push(const Command& command) noexcept
+{
+    const uint32 head = commandHead.load(std::memory_order_relaxed);
+
+    if (head - commandTail.load(std::memory_order_acquire) >= commandQueueSize)
+        return false;
+
+    commands[head % commandQueueSize] = command;
+    commandHead.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+uint32 SampleStreamer::Stream::start(SampleData* sample, int startFrame) noexcept
+{
+    // Checked before taking the reference so a full queue never has to drop one
+    if (commandHead.load(std::memory_order_relaxed) - commandTail.load(std::memory_order_acquire) >= commandQueueSize)
+        return 0;
+
+    // 0 means "no request"
+    if (++lastId == 0)
+        ++lastId;
+
+    readFrame.store(startFrame, std::memory_order_release);
+
+    // The caller's voice holds the sample too, so this is never the last reference
+    sample->incReferenceCount();
+    push({ sample, startFrame, lastId });
+    owner->wake();
+    return lastId;
+}
+
+void SampleStreamer::Stream::stop() noexcept
+{
+    // If the queue is full the next start replaces the stream anyway
+    if (push({ nullptr, 0, 0 }))
+        owner->wake();
+}
+
+int SampleStreamer::Stream::getWindow(uint32 id, int windowStart, const float** channels) noexcept
+{
+    if (id == 0 || activeId.load(std::memory_order_acquire) != id)
+        return 0;
+
+    const int written = writeFrame.load(std::memory_order_acquire);
+
+    // Everything before the window can now be overwritten
+    jassert(windowStart >= readFrame.load(std::memory_order_relaxed));
+    readFrame.store(windowStart, std::memory_order_release);
+
+    // Enough room for the disk thread's next read
+    if (written < endFrame.load(std::memory_order_relaxed) && windowStart + bufferFrames - written >= readChunkFrames)
+        owner->wake();
+
+    const int offset = windowStart % bufferFrames;
+    for (int ch = 0; ch < maxChannels; ++ch)
+        channels[ch] = data.getReadPointer(ch) + offset;
+
+    return jmax(0, written - windowStart);
+}
+
+//==============================================================================
+SampleStreamer::SampleStreamer(AudioFormatManager& manager, int numStreams)
+    : Thread("Sample streamer"),
+      formatManager(manager),
+      readBuffer(maxChannels, readChunkFrames)
+{
+    for (int i = 0; i < numStreams; ++i)
+        streams.add(new Stream())->owner = this;
+
+    startThread(Thread::Priority::high);
+}
+
+SampleStreamer::~SampleStreamer()
+{
+    signalThreadShouldExit();
+    wakeCount.fetch_add(1);
+    wakeCount.notify_one();
+    stopThread(2000);
+
+    // Release whatever requests the disk thread never got to
+    for (auto* stream : streams)
+    {
+        release(*stream);
+
+        for (uint32 tail = stream->commandTail.load(); tail != stream->commandHead.load(); ++tail)
+            if (auto* sample = stream->commands[tail % Stream::commandQueueSize].sample)
+                sample->decReferenceCount();
+    }
+}
+
+int SampleStreamer::getNumUnderruns() const noexcept
+{
+    int total = 0;
+    for (auto* stream : streams)
+        total += stream->numUnderruns.load();
+    return total;
+}
+
+//==============================================================================
+void SampleStreamer::run()
+{
+    while (!threadShouldExit())
+    {
+        bool didWork = false;
+
+        for (auto* stream : streams)
+        {
+            processCommands(*stream);
+            didWork = fill(*stream) || didWork;
+        }
+
+        if (didWork)
+            continue;
+
+        // Announce the sleep, then look once more, so a request or read made
+        // in between either gets seen here or bumps wakeCount past the value
+        // the wait below compares against
+        const uint32 wakeSnapshot = wakeCount.load(std::memory_order_relaxed);
+        sleeping.store(true, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        bool pending = false;
+        for (auto* stream : streams)
+        {
+            const int written = stream->writeFrame.load(std::memory_order_relaxed);
+
+            pending = pending
+                   || stream->commandTail.load(std::memory_order_relaxed) != stream->commandHead.load(std::memory_order_acquire)
+                   || (stream->reader != nullptr && written < stream->endFrame.load(std::memory_order_relaxed)
+                       && stream->readFrame.load(std::memory_order_acquire) + bufferFrames - written >= readChunkFrames);
+        }
+
+        if (pending || threadShouldExit())
+        {
+            sleeping.store(false, std::memory_order_relaxed);
+            continue;
+        }
+
+        // Full streams are topped up as their voices read; with none, until a start
+        wakeCount.wait(wakeSnapshot, std::memory_order_acquire);
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+// Audio thread: one notify per sleep, so voices don't all signal every block.
+// Atomic notify is a futex wake (or the platform's equivalent), never a lock.
+void SampleStreamer::wake() noexcept
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (sleeping.load(std::memory_order_relaxed) && sleeping.exchange(false))
+    {
+        wakeCount.fetch_add(1, std::memory_order_release);
+        wakeCount.notify_one();
+    }
+}
+
+void SampleStreamer::processCommands(Stream& stream)
+{
+    uint32 tail = stream.commandTail.load(std::memory_order_relaxed);
+
+    while (tail != stream.commandHead.load(std::memory_order_acquire))
+    {
+        const auto command = stream.commands[tail % Stream::commandQueueSize];
+        stream.commandTail.store(++tail, std::memory_order_release);
+
+        // The voice stops trusting the buffer before it is reused
+        stream.activeId.store(0, std::memory_order_release);
+        release(stream);
+
+        if (command.sample != nullptr)
+        {
+            // Buffers are allocated on first use, so idle streams cost almost nothing
+            if (stream.data.getNumSamples() == 0)
+                stream.data.setSize(maxChannels, 2 * bufferFrames, false, true);
+
+            stream.current = command.sample;
+            stream.reader.reset(formatManager.createReaderFor(command.sample->sourceFile));
+
+            // A file that has gone missing just plays silence after the preload
+            stream.endFrame.store(command.sample->getTotalLength(), std::memory_order_relaxed);
+            stream.writeFrame.store(command.startFrame, std::memory_order_release);
+            stream.activeId.store(command.id, std::memory_order_release);
+        }
+    }
+}
+
+bool SampleStreamer::fill(Stream& stream)
+{
+    if (stream.current == nullptr || stream.reader == nullptr)
+        return false;
+
+    const int readFrame = stream.readFrame.load(std::memory_order_acquire);
+
+    // After an underrun the voice has skipped ahead; frames it passed are dropped
+    const int start = jmax(stream.writeFrame.load(std::memory_order_relaxed), readFrame);
+    const int limit = jmin(stream.current->getTotalLength(), readFrame + bufferFrames);
+
+    if (start >= limit)
+        return false;
+
+    const int numFrames = jmin(readChunkFrames, limit - start);
+    const int numChannels = jmin(maxChannels, static_cast<int>(stream.reader->numChannels));
+
+    stream.reader->read(&readBuffer, 0, numFrames, start, true, numChannels > 1);
+
+    // Write each frame twice so any window of bufferFrames is contiguous
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* source = readBuffer.getReadPointer(ch);
+        float* dest = stream.data.getWritePointer(ch);
+
+        for (int done = 0; done < numFrames;)
+        {
+            const int offset = (start + done) % bufferFrames;
+            const int run = jmin(numFrames - done, bufferFrames - offset);
+
+            FloatVectorOperations::copy(dest + offset, source + done, run);
+            FloatVectorOperations::copy(dest + offset + bufferFrames, source + done, run);
+            done += run;
+        }
+    }
+
+    stream.writeFrame.store(start + numFrames, std::memory_order_release);
+    return true;
+}
+
+void SampleStreamer::release(Stream& stream)
+{
+    stream.reader.reset();
+
+    // The disk thread may drop the last reference; it is never the audio thread
+    if (stream.current != nullptr)
+    {
+        stream.current->decReferenceCount();
+        stream.current = nullptr;
+    }
+}
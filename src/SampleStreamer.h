@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    SampleStreamer.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Disk streaming for samples too large to hold in memory
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+#include "SampleData.h"
+
+#include <atomic>
+#include <memory>
+
+//==============================================================================
+// Background disk thread feeding one stream per voice, like a classic disk
+// sampler. A streamed SampleData keeps only its attack in memory; the voice
+// plays that while the stream reads the rest of the file ahead of it.
+//
+// Each stream is a mirrored ring buffer: frame f is written at f % size and
+// again at f % size + size, so any run of up to bufferFrames frames can be
+// handed to the resampler as one contiguous window. The audio thread never
+// blocks, allocates, or drops the last reference to a sample - stop and
+// start requests go to the disk thread through a small lock-free queue.
+// A stream's buffer is allocated by the disk thread the first time it is
+// used, so there can be one stream for every voice the pool may grow to.
+//
+// The disk thread sleeps without a timeout while nothing is streaming, and
+// while every playing stream is full. Requests wake it, and so do reads that
+// leave a chunk's worth of room, at most once per sleep. It sleeps on an
+// atomic (C++20 wait and notify), not an event, so waking it never takes a
+// lock on the audio thread.
+class SampleStreamer : private Thread
+{
+public:
+    static constexpr int bufferFrames = 32768;  // Per stream
+    static constexpr int maxChannels = 2;       // Extra channels of a streamed file are ignored
+    static constexpr int kernelMargin = 8;      // Frames the resampler reads either side of a position
+    static constexpr int overlapFrames = 32;    // Streams start this far before the end of the preload
+
+    //==============================================================================
+    class Stream
+    {
+    public:
+        Stream() = default;
+
+        // Audio thread: start streaming sample from startFrame. Returns an id
+        // for getWindow, or 0 if the request queue is full.
+        uint32 start(SampleData* sample, int startFrame) noexcept;
+        void stop() noexcept;
+
+        // Audio thread: a contiguous window of frames from windowStart onwards
+        // for the current request id. Returns the number of frames ready
+        // (0 if the disk thread hasn't started the request yet).
+        int getWindow(uint32 id, int windowStart, const float** channels) noexcept;
+
+        void addUnderrun() noexcept { ++numUnderruns; }
+
+    private:
+        friend class SampleStreamer;
+
+        struct Command
+        {
+            SampleData* sample;  // Holds a reference, released by the disk thread
+            int startFrame;
+            uint32 id;
+        };
+
+        static constexpr uint32 commandQueueSize = 8;
+        bool push(const Command& command) noexcept;
+
+        SampleStreamer* owner = nullptr;
+        AudioSampleBuffer data;                // Mirrored ring, sized by the disk thread
+        std::atomic<int> writeFrame { 0 };    // First frame not yet written
+        std::atomic<int> endFrame { 0 };      // Length of the file being streamed
+        std::atomic<int> readFrame { 0 };     // First frame the voice still needs
+        std::atomic<uint32> activeId { 0 };   // Request the buffer currently holds
+        std::atomic<int> numUnderruns { 0 };
+        uint32 lastId = 0;
+
+        Command commands[commandQueueSize];
+        std::atomic<uint32> commandHead { 0 };  // Written by the audio thread
+        std::atomic<uint32> commandTail { 0 };  // Written by the disk thread
+
+        // Disk thread only
+        SampleData* current = nullptr;
+        std::unique_ptr<AudioFormatReader> reader;
+
+        JUCE_DECLARE_NON_COPYABLE(Stream)
+    };
+
+    //==============================================================================
+    SampleStreamer(AudioFormatManager& formatManager, int numStreams);
+    ~SampleStreamer() override;
+
+    Stream* getStream(int index) noexcept { return streams[index]; }
+
+    // Reads that couldn't be served in time, across all streams
+    int getNumUnderruns() const noexcept;
+
+private:
+    void run() override;
+    void wake() noexcept;
+    void processCommands(Stream& stream);
+    bool fill(Stream& stream);
+    void release(Stream& stream);
+
+    AudioFormatManager& formatManager;
+    OwnedArray<Stream> streams;
+    AudioSampleBuffer readBuffer;
+    std::atomic<bool> sleeping { false };  // Set by the disk thread before it waits
+    std::atomic<uint32> wakeCount { 0 };   // What it waits on; bumped by every wake
+
+    static constexpr int readChunkFrames = 8192;
+
+    JUCE_DECLARE_NON_COPYABLE(SampleStreamer)
+};
@@ -0,0 +1,468 @@
+/*
+  ==============================================================================
+
+    SamplerBenchmark.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Headless engine benchmark: scripted MIDI through SamplerPlugin::processBlock
+
+  ==============================================================================
+*/
+
+#include "juce.h"
+#include "SamplerPlugin.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#if JUCE_WINDOWS
+ #define NOMINMAX
+ #define WIN32_LEAN_AND_MEAN
+ #include <windows.h>
+ #include <psapi.h>
+ #pragma comment(lib, "psapi.lib")
+#else
+ #include <sys/resource.h>
+#endif
+
+//==============================================================================
+// The benchmark is always built with the allocation trap, which counts every
+// heap allocation made inside the engine's real-time sections (the
+// processBlock call and the render helpers' jobs). The engine is meant to make
+// none, so anything above zero is a regression. Where the trap can't hook the
+// malloc family (see AllocationTrap::isWatchingMalloc, reported as
+// allocationsWatchMalloc) the count covers operator new only, and HeapBlock
+// growth inside JUCE containers is missed.
+
+//==============================================================================
+namespace
+{
+    // Peak resident memory of the whole process, in bytes
+    int64 getPeakMemoryBytes()
+    {
+       #if JUCE_WINDOWS
+        PROCESS_MEMORY_COUNTERS counters {};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return static_cast<int64>(counters.PeakWorkingSetSize);
+        return 0;
+       #else
+        rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+        #if JUCE_MAC
+         return static_cast<int64>(usage.ru_maxrss);
+        #else
+         return static_cast<int64>(usage.ru_maxrss) * 1024;
+        #endif
+       #endif
+    }
+
+    //==============================================================================
+    // Synthetic kit: 16 decaying tone and noise hits of increasing length,
+    // every other one stereo, written as 24-bit WAV at 44.1 kHz so playback at
+    // other device rates goes through the resampler
+    bool writeSyntheticKit(const File& folder, Array<File>& files)
+    {
+        constexpr double fileRate = 44100.0;
+        WavAudioFormat wav;
+        Random random(1234);
+
+        folder.createDirectory();
+
+        for (int pad = 0; pad < PadLayout::padsPerBank; ++pad)
+        {
+            const int numChannels = (pad % 2) + 1;
+            const int numSamples = static_cast<int>(fileRate * (0.2 + 0.15 * pad));
+            const double frequency = 55.0 * std::pow(2.0, pad / 4.0);
+
+            AudioBuffer<float> audio(numChannels, numSamples);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double t = i / fileRate;
+                const float envelope = static_cast<float>(std::exp(-4.0 * t / (0.2 + 0.15 * pad)));
+                const float tone = static_cast<float>(std::sin(MathConstants<double>::twoPi * frequency * t));
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    audio.setSample(ch, i, 0.5f * envelope * (0.7f * tone + 0.3f * (random.nextFloat() * 2.0f - 1.0f)));
+            }
+
+            const File file = folder.getChildFile("pad" + String(pad + 1).paddedLeft('0', 2) + ".wav");
+            file.deleteFile();
+
+            std::unique_ptr<OutputStream> stream(file.createOutputStream());
+            if (stream == nullptr)
+                return false;
+
+            std::unique_ptr<AudioFormatWriter> writer(wav.createWriterFor(stream.get(), fileRate,
+                                                                          static_cast<unsigned int>(numChannels),
+                                                                          24, {}, 0));
+            if (writer == nullptr)
+                return false;
+
+            stream.release();  // Owned by the writer now
+            writer->writeFromAudioSampleBuffer(audio, 0, numSamples);
+            files.add(file);
+        }
+
+        return true;
+    }
+
+    // A real kit: the first 16 audio files in a folder, by name
+    bool findKitFiles(const File& folder, Array<File>& files)
+    {
+        auto found = folder.findChildFiles(File::findFiles, false, "*.wav;*.aif;*.aiff;*.flac;*.ogg;*.mp3");
+        found.sort();
+
+        for (int i = 0; i < jmin(PadLayout::padsPerBank, found.size()); ++i)
+            files.add(found[i]);
+
+        return !files.isEmpty();
+    }
+
+    //==============================================================================
+    struct ScriptEvent
+    {
+        enum Type { noteOn, noteOff, remap };
+
+        int64 position;   // Samples from the start of the run
+        Type type;
+        int pad;
+        uint8 velocity;
+    };
+
+    struct Scenario
+    {
+        const char* name;
+        bool oneShot;      // Note-offs ignored, so hits ring out and pile up voices
+        std::vector<ScriptEvent> (*build)(double sampleRate, int64 length);
+    };
+
+    // Four pads rolled in 32nd notes at 140 BPM, with accents
+    std::vector<ScriptEvent> buildDrumRolls(double sampleRate, int64 length)
+    {
+        std::vector<ScriptEvent> events;
+        const int64 step = static_cast<int64>(sampleRate * 60.0 / 140.0 / 8.0);
+
+        for (int64 pos = 0, n = 0; pos < length; pos += step, ++n)
+            for (int pad = 0; pad < 4; ++pad)
+                events.push_back({ pos + pad * 7, ScriptEvent::noteOn, pad, static_cast<uint8>(n % 4 == 0 ? 127 : 70 + pad * 10) });
+
+        return events;
+    }
+
+    // All 16 pads at once every beat at 120 BPM, held for most of the beat
+    std::vector<ScriptEvent> buildChords(double sampleRate, int64 length)
+    {
+        std::vector<ScriptEvent> events;
+        const int64 beat = static_cast<int64>(sampleRate * 0.5);
+        const int64 hold = beat * 4 / 5;
+
+        for (int64 pos = 0; pos < length; pos += beat)
+        {
+            for (int pad = 0; pad < PadLayout::padsPerBank; ++pad)
+                events.push_back({ pos, ScriptEvent::noteOn, pad, 100 });
+
+            for (int pad = 0; pad < PadLayout::padsPerBank; ++pad)
+                events.push_back({ pos + hold, ScriptEvent::noteOff, pad, 0 });
+        }
+
+        return events;
+    }
+
+    // 16th-note hits across the pads while every pad is remapped every 50 ms
+    std::vector<ScriptEvent> buildRemapping(double sampleRate, int64 length)
+    {
+        std::vector<ScriptEvent> events;
+        const int64 step = static_cast<int64>(sampleRate * 60.0 / 120.0 / 4.0);
+        const int64 remapInterval = static_cast<int64>(sampleRate * 0.05);
+
+        for (int64 pos = 0, n = 0; pos < length; pos += step, ++n)
+            events.push_back({ pos, ScriptEvent::noteOn, static_cast<int>(n % PadLayout::padsPerBank), 110 });
+
+        for (int64 pos = remapInterval; pos < length; pos += remapInterval)
+            events.push_back({ pos, ScriptEvent::remap, 0, 0 });
+
+        std::stable_sort(events.begin(), events.end(),
+                         [](const ScriptEvent& a, const ScriptEvent& b) { return a.position < b.position; });
+        return events;
+    }
+
+    const Scenario scenarios[] =
+    {
+        { "drumRolls",  true,  buildDrumRolls },
+        { "chords16",   false, buildChords },
+        { "remapping",  true,  buildRemapping },
+    };
+
+    //==============================================================================
+    struct RunSettings
+    {
+        const Scenario* scenario;
+        double sampleRate;
+        int blockSize;
+        double seconds;
+        int numVoices;
+        int renderThreads;
+    };
+
+    double percentile(const std::vector<double>& sorted, double fraction)
+    {
+        if (sorted.empty())
+            return 0.0;
+
+        const auto index = static_cast<size_t>(std::ceil(fraction * static_cast<double>(sorted.size()))) - 1;
+        return sorted[jmin(sorted.size() - 1, index)];
+    }
+
+    var runScenario(const RunSettings& settings, const Array<File>& kit)
+    {
+        SamplerPlugin plugin;
+
+        plugin.setNumVoices(settings.numVoices);
+        plugin.setRenderThreads(settings.renderThreads);
+        plugin.setPlayConfigDetails(0, 2, settings.sampleRate, settings.blockSize);
+        plugin.prepareToPlay(settings.sampleRate, settings.blockSize);
+
+        for (int pad = 0; pad < kit.size(); ++pad)
+            plugin.loadSample(pad, kit[pad]);
+
+        plugin.getEngineSettings().setDefaultMode(settings.scenario->oneShot ? PlaybackMode::oneShot : PlaybackMode::gate);
+
+        const int64 length = static_cast<int64>(settings.sampleRate * settings.seconds);
+        const auto script = settings.scenario->build(settings.sampleRate, length);
+        const int numBlocks = static_cast<int>((length + settings.blockSize - 1) / settings.blockSize);
+
+        // Everything the loop needs is allocated up front
+        AudioBuffer<float> buffer(jmax(2, plugin.getTotalNumOutputChannels()), settings.blockSize);
+        MidiBuffer midi;
+        midi.ensureSize(4096);
+
+        std::vector<double> blockSeconds;
+        blockSeconds.reserve(static_cast<size_t>(numBlocks));
+
+        int remapShift = 0;
+        size_t next = 0;
+        int64 totalAllocations = 0, maxBlockAllocations = 0, blocksWithAllocations = 0;
+        double totalSeconds = 0.0, voiceSum = 0.0;
+        int peakVoices = 0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const int64 blockStart = static_cast<int64>(block) * settings.blockSize;
+            midi.clear();
+
+            // Remapping happens between blocks, where the editor would do it
+            for (; next < script.size() && script[next].position < blockStart + settings.blockSize; ++next)
+            {
+                const auto& event = script[next];
+                const int offset = static_cast<int>(event.position - blockStart);
+
+                if (event.type == ScriptEvent::remap)
+                {
+                    ++remapShift;
+                    for (int pad = 0; pad < PadLayout::padsPerBank; ++pad)
+                        plugin.setNoteMapping(pad, 36 + (pad + remapShift) % PadLayout::padsPerBank);
+                }
+                else if (event.type == ScriptEvent::noteOn)
+                {
+                    midi.addEvent(MidiMessage::noteOn(1, plugin.getNoteMapping(event.pad), event.velocity), offset);
+                }
+                else
+                {
+                    midi.addEvent(MidiMessage::noteOff(1, plugin.getNoteMapping(event.pad)), offset);
+                }
+            }
+
+            const int64 allocationsBefore = AllocationTrap::getNumTrapped();
+            const int64 startTicks = Time::getHighResolutionTicks();
+
+            plugin.processBlock(buffer, midi);
+
+            const int64 endTicks = Time::getHighResolutionTicks();
+
+            const int64 allocations = AllocationTrap::getNumTrapped() - allocationsBefore;
+            totalAllocations += allocations;
+            maxBlockAllocations = jmax(maxBlockAllocations, allocations);
+            blocksWithAllocations += allocations > 0 ? 1 : 0;
+
+            const double elapsed = Time::highResolutionTicksToSeconds(endTicks - startTicks);
+            blockSeconds.push_back(elapsed);
+            totalSeconds += elapsed;
+
+            const int voices = plugin.getPerformanceMonitor().getSnapshot().activeVoices;
+            voiceSum += voices;
+            peakVoices = jmax(peakVoices, voices);
+        }
+
+        plugin.releaseResources();
+
+        const double blockPeriod = settings.blockSize / settings.sampleRate;
+        const double audioSeconds = static_cast<double>(numBlocks) * blockPeriod;
+        const double realtimeFactor = totalSeconds > 0 ? audioSeconds / totalSeconds : 0.0;
+        const double averageVoices = numBlocks > 0 ? voiceSum / numBlocks : 0.0;
+
+        std::sort(blockSeconds.begin(), blockSeconds.end());
+
+        auto* result = new DynamicObject();
+        result->setProperty("scenario", settings.scenario->name);
+        result->setProperty("sampleRate", settings.sampleRate);
+        result->setProperty("blockSize", settings.blockSize);
+        result->setProperty("voices", settings.numVoices);
+        result->setProperty("renderThreads", plugin.getRenderThreads());
+        result->setProperty("blocks", numBlocks);
+        result->setProperty("audioSeconds", audioSeconds);
+        result->setProperty("processSeconds", totalSeconds);
+        result->setProperty("realtimeFactor", realtimeFactor);
+        result->setProperty("averageVoices", averageVoices);
+        result->setProperty("peakVoices", peakVoices);
+        result->setProperty("voiceRealtimeFactor", averageVoices * realtimeFactor);
+        result->setProperty("blockUsP50", 1.0e6 * percentile(blockSeconds, 0.50));
+        result->setProperty("blockUsP95", 1.0e6 * percentile(blockSeconds, 0.95));
+        result->setProperty("blockUsP99", 1.0e6 * percentile(blockSeconds, 0.99));
+        result->setProperty("blockUsMax", 1.0e6 * (blockSeconds.empty() ? 0.0 : blockSeconds.back()));
+        result->setProperty("loadP99", percentile(blockSeconds, 0.99) / blockPeriod);
+        result->setProperty("allocations", totalAllocations);
+        result->setProperty("allocationsPerBlock", numBlocks > 0 ? static_cast<double>(totalAllocations) / numBlocks : 0.0);
+        result->setProperty("maxAllocationsInBlock", maxBlockAllocations);
+        result->setProperty("blocksWithAllocations", blocksWithAllocations);
+        result->setProperty("allocationsWatchMalloc", AllocationTrap::isWatchingMalloc());
+        result->setProperty("streamUnderruns", plugin.getNumStreamUnderruns());
+        result->setProperty("peakMemoryBytes", getPeakMemoryBytes());
+        return var(result);
+    }
+
+    template <typename Type>
+    Array<Type> parseList(const String& text, const Array<Type>& defaults)
+    {
+        if (text.isEmpty())
+            return defaults;
+
+        Array<Type> values;
+        for (const auto& token : StringArray::fromTokens(text, ",", ""))
+            if (token.trim().isNotEmpty())
+                values.add(static_cast<Type>(token.trim().getDoubleValue()));
+
+        return values.isEmpty() ? defaults : values;
+    }
+
+    void printUsage()
+    {
+        std::cout << "SamplerBenchmark [options]\n"
+                     "  --kit=<folder>        Load the first 16 audio files from folder (default: synthetic kit)\n"
+                     "  --scenarios=<list>    drumRolls,chords16,remapping (default: all)\n"
+                     "  --rates=<list>        Sample rates (default: 44100,48000,96000)\n"
+                     "  --blocks=<list>       Block sizes (default: 32,64,128,256,512,1024)\n"
+                     "  --seconds=<n>         Audio rendered per run (default: 10)\n"
+                     "  --voices=<n>          Voice pool size (default: " << SamplerPlugin::defaultVoices << ")\n"
+                     "  --threads=<n>         Render helper threads (default: 0)\n"
+                     "  --output=<file>       Write the JSON report there instead of stdout\n";
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    ArgumentList args("SamplerBenchmark", argc, argv);
+
+    if (args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    ScopedJuceInitialiser_GUI juceInitialiser;
+    SamplerLog::setLevel(SamplerLog::Level::off);
+
+    // Allocations are counted and reported, not stopped at
+    AllocationTrap::setAssertsEnabled(false);
+
+    // Kit
+    Array<File> kit;
+    const String kitOption = args.getValueForOption("--kit");
+    const File tempKit = File::getSpecialLocation(File::tempDirectory).getChildFile("SamplerBenchmarkKit");
+
+    if (kitOption.isNotEmpty() ? !findKitFiles(File::getCurrentWorkingDirectory().getChildFile(kitOption), kit)
+                               : !writeSyntheticKit(tempKit, kit))
+    {
+        std::cerr << "No kit: could not " << (kitOption.isNotEmpty() ? "find audio files in " + kitOption
+                                                                     : String("write the synthetic kit")) << "\n";
+        return 1;
+    }
+
+    // Run matrix
+    const auto rates = parseList<double>(args.getValueForOption("--rates"), { 44100.0, 48000.0, 96000.0 });
+    const auto blockSizes = parseList<int>(args.getValueForOption("--blocks"), { 32, 64, 128, 256, 512, 1024 });
+    const StringArray scenarioNames = StringArray::fromTokens(args.getValueForOption("--scenarios"), ",", "");
+    const String secondsOption = args.getValueForOption("--seconds");
+    const String voicesOption = args.getValueForOption("--voices");
+    const String threadsOption = args.getValueForOption("--threads");
+
+    RunSettings settings {};
+    settings.seconds = secondsOption.isNotEmpty() ? jmax(0.1, secondsOption.getDoubleValue()) : 10.0;
+    settings.numVoices = voicesOption.isNotEmpty() ? voicesOption.getIntValue() : SamplerPlugin::defaultVoices;
+    settings.renderThreads = threadsOption.getIntValue();
+
+    Array<var> runs;
+
+    for (const auto& scenario : scenarios)
+    {
+        if (!scenarioNames.isEmpty() && !scenarioNames.contains(scenario.name))
+            continue;
+
+        for (const double rate : rates)
+        {
+            for (const int blockSize : blockSizes)
+            {
+                if (rate <= 0 || blockSize <= 0)
+                    continue;
+
+                settings.scenario = &scenario;
+                settings.sampleRate = rate;
+                settings.blockSize = blockSize;
+
+                std::cerr << scenario.name << " @ " << rate << " Hz, " << blockSize << " samples\n";
+                runs.add(runScenario(settings, kit));
+            }
+        }
+    }
+
+    // Report
+    auto* report = new DynamicObject();
+    report->setProperty("version", ProjectInfo::versionString);
+    report->setProperty("juce", SystemStats::getJUCEVersion());
+    report->setProperty("cpu", SystemStats::getCpuModel());
+    report->setProperty("cpus", SystemStats::getNumCpus());
+   #if JUCE_DEBUG
+    report->setProperty("build", "debug");
+   #else
+    report->setProperty("build", "release");
+   #endif
+    report->setProperty("kit", kitOption.isNotEmpty() ? kitOption : String("synthetic"));
+    report->setProperty("seconds", settings.seconds);
+    report->setProperty("peakMemoryBytes", getPeakMemoryBytes());
+    report->setProperty("runs", runs);
+
+    const String json = JSON::toString(var(report));
+    const String outputOption = args.getValueForOption("--output");
+
+    if (outputOption.isNotEmpty())
+    {
+        const File output = File::getCurrentWorkingDirectory().getChildFile(outputOption);
+        if (!output.replaceWithText(json))
+        {
+            std::cerr << "Could not write " << output.getFullPathName() << "\n";
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << json << "\n";
+    }
+
+    if (kitOption.isEmpty())
+        tempKit.deleteRecursively();
+
+    return 0;
+}
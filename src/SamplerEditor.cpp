@@ -11,6 +11,7 @@
 */
 
 #include "SamplerEditor.h"
+#include "SampleBundle.h"
 
 //==============================================================================
 String SamplerEditor::getNoteName(int midiNote)
@@ -24,51 +25,139 @@ String SamplerEditor::getNoteName(int midiNote)
 }
 
 //==============================================================================
-SamplerButtonUI::SamplerButtonUI(int index, SamplerPlugin& plugin)
-    : buttonIndex(index), sampler(plugin), isActive(false), isLoaded(false),
-      velocity(0.0f), flashAlpha(0.0f)
+PadGrid::PadGrid(SamplerPlugin& plugin)
+    : sampler(plugin)
 {
-    DEBUG_MIDI("SamplerButtonUI::constructor for button " + String(index));
-    defaultColor = Colour(0xFF404040);
-    activeColor = Colour(0xFF00AA00);
-    loadedColor = Colour(0xFF606060);
-    activeBorderColor = Colour(0xFF00FF00);
+    setOpaque(true);
 }
 
-SamplerButtonUI::~SamplerButtonUI()
+Rectangle<int> PadGrid::getCellBounds(int cell) const
 {
+    const int cellWidth = (getWidth() - (PadLayout::gridSize - 1) * cellMargin) / PadLayout::gridSize;
+    const int cellHeight = (getHeight() - (PadLayout::gridSize - 1) * cellMargin) / PadLayout::gridSize;
+
+    // Invert row so pad 1 is at bottom-left
+    const int row = PadLayout::gridSize - 1 - cell / PadLayout::gridSize;
+    const int col = cell % PadLayout::gridSize;
+
+    return { col * (cellWidth + cellMargin), row * (cellHeight + cellMargin), cellWidth, cellHeight };
+}
+
+int PadGrid::getPadAt(Point<int> position) const
+{
+    for (int cell = 0; cell < PadLayout::padsPerBank; ++cell)
+        if (getCellBounds(cell).contains(position))
+            return PadLayout::getFirstPad(bank) + cell;
+
+    return -1;
+}
+
+void PadGrid::markDirty(int pad)
+{
+    if (!isShown(pad))
+        return;
+
+    const int cell = pad % PadLayout::padsPerBank;
+    dirty[cell] = true;
+    repaint(getCellBounds(cell));
+}
+
+void PadGrid::setBank(int newBank)
+{
+    newBank = jlimit(0, PadLayout::numBanks - 1, newBank);
+
+    if (newBank == bank)
+        return;
+
+    // Flashes stop where they are once their pads are hidden
+    for (int pad = PadLayout::getFirstPad(bank); pad < PadLayout::getFirstPad(bank + 1); ++pad)
+        pads[pad].flashAlpha = 0.0f;
+
+    bank = newBank;
+
+    for (auto& cell : dirty)
+        cell = true;
+
+    repaint();
+}
+
+void PadGrid::resized()
+{
+    // Rebuilt at the new size on the next paint
+    cache = {};
+}
+
+void PadGrid::paint(Graphics& g)
+{
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const int width = roundToInt(getWidth() * scale);
+    const int height = roundToInt(getHeight() * scale);
+
+    if (cache.isNull() || cacheScale != scale || cache.getWidth() != width || cache.getHeight() != height)
+    {
+        cache = Image(Image::ARGB, jmax(1, width), jmax(1, height), false);
+        cacheScale = scale;
+
+        Graphics cacheGraphics(cache);
+        cacheGraphics.fillAll(Colour(0xFF202020));
+
+        for (auto& cell : dirty)
+            cell = true;
+    }
+
+    // Only the cells that changed are drawn again
+    {
+        Graphics cacheGraphics(cache);
+        cacheGraphics.addTransform(AffineTransform::scale(scale));
+
+        for (int cell = 0; cell < PadLayout::padsPerBank; ++cell)
+        {
+            if (!dirty[cell])
+                continue;
+
+            dirty[cell] = false;
+
+            const auto bounds = getCellBounds(cell);
+            Graphics::ScopedSaveState state(cacheGraphics);
+            cacheGraphics.reduceClipRegion(bounds);
+            cacheGraphics.fillAll(Colour(0xFF202020));
+            drawPad(cacheGraphics, PadLayout::getFirstPad(bank) + cell, bounds.toFloat());
+        }
+    }
+
+    g.drawImageTransformed(cache, AffineTransform::scale(1.0f / scale));
 }
 
-void SamplerButtonUI::paint(Graphics& g)
+void PadGrid::drawPad(Graphics& g, int pad, Rectangle<float> bounds) const
 {
-    auto bounds = getLocalBounds().toFloat();
+    const Pad& state = pads[pad];
 
     // Calculate color based on active state and velocity
     Colour bgColour;
-    if (isActive)
+    if (state.isActive)
     {
         // Brightness increases with velocity (0.0 = dim green, 1.0 = bright green)
         bgColour = Colour::fromRGB(
-            static_cast<uint8>(0 + velocity * 50),      // R: 0-50
-            static_cast<uint8>(100 + velocity * 155),   // G: 100-255
-            static_cast<uint8>(0 + velocity * 50)       // B: 0-50
+            static_cast<uint8>(0 + state.velocity * 50),      // R: 0-50
+            static_cast<uint8>(100 + state.velocity * 155),   // G: 100-255
+            static_cast<uint8>(0 + state.velocity * 50)       // B: 0-50
         );
     }
     else
     {
-        bgColour = isLoaded ? loadedColor : defaultColor;
+        bgColour = state.isLoaded ? Colour(0xFF606060) : Colour(0xFF404040);
     }
 
     g.setColour(bgColour);
     g.fillRoundedRectangle(bounds, 8.0f);
 
     // Draw border - also affected by velocity
-    if (isActive)
+    if (state.isActive)
     {
         Colour borderColour = Colour::fromRGB(
-            static_cast<uint8>(0 + velocity * 100),
-            static_cast<uint8>(200 + velocity * 55),
-            static_cast<uint8>(0 + velocity * 100)
+            static_cast<uint8>(0 + state.velocity * 100),
+            static_cast<uint8>(200 + state.velocity * 55),
+            static_cast<uint8>(0 + state.velocity * 100)
         );
         g.setColour(borderColour);
     }
@@ -78,35 +167,48 @@ void SamplerButtonUI::paint(Graphics& g)
     }
     g.drawRoundedRectangle(bounds.reduced(2.0f), 6.0f, 2.0f);
 
-    // Draw flash effect
-    if (flashAlpha > 0.0f)
+    // Playhead along the bottom edge, level meter up the right edge
+    if (state.isActive && state.playhead > 0.0f)
+    {
+        auto track = bounds.reduced(8.0f, 0.0f).removeFromBottom(5.0f).removeFromTop(2.0f);
+        g.setColour(Colours::white.withAlpha(0.6f));
+        g.fillRect(track.withWidth(track.getWidth() * state.playhead));
+    }
+
+    if (state.level > 0.0f)
     {
-        g.setColour(Colours::white.withAlpha(flashAlpha));
+        auto meter = bounds.reduced(0.0f, 10.0f).removeFromRight(7.0f).removeFromLeft(3.0f);
+        g.setColour(state.level > 0.9f ? Colours::orangered : Colours::yellowgreen);
+        g.fillRect(meter.removeFromBottom(meter.getHeight() * state.level));
+    }
+
+    // Draw flash effect (faded by advanceFlash)
+    if (state.flashAlpha > 0.0f)
+    {
+        g.setColour(Colours::white.withAlpha(state.flashAlpha));
         g.fillRoundedRectangle(bounds, 8.0f);
-        flashAlpha -= 0.1f;
-        if (flashAlpha < 0.0f) flashAlpha = 0.0f;
     }
 
-    // Draw file name or button number
+    // Draw file name or pad name
     g.setColour(Colours::white);
     g.setFont(12.0f);
 
     String displayText;
-    if (isLoaded && fileName.isNotEmpty())
+    if (state.isLoaded && state.fileName.isNotEmpty())
     {
         // Truncate long file names
-        if (fileName.length() > 12)
+        if (state.fileName.length() > 12)
         {
-            displayText = fileName.substring(0, 10) + "..";
+            displayText = state.fileName.substring(0, 10) + "..";
         }
         else
         {
-            displayText = fileName;
+            displayText = state.fileName;
         }
     }
     else
     {
-        displayText = String(buttonIndex + 1);
+        displayText = PadLayout::getPadName(pad);
     }
 
     // Draw centered text
@@ -115,56 +217,31 @@ void SamplerButtonUI::paint(Graphics& g)
     // Draw MIDI note
     g.setFont(9.0f);
     g.setColour(Colours::silver);
-    String noteName = SamplerEditor::getNoteName(sampler.getNoteMapping(buttonIndex));
+    String noteName = SamplerEditor::getNoteName(sampler.getNoteMapping(pad));
     g.drawText(noteName, bounds.removeFromBottom(14), Justification::centred, true);
 }
 
-void SamplerButtonUI::resized()
+void PadGrid::mouseDown(const MouseEvent& e)
 {
-    auto bounds = getLocalBounds().toFloat().reduced(4.0f);
-    flashRect = bounds;
-}
+    const int pad = getPadAt(e.getPosition());
+    if (pad < 0)
+        return;
 
-void SamplerButtonUI::mouseDown(const MouseEvent& e)
-{
-    DEBUG_MIDI("mouseDown: button=" + String(buttonIndex) + " rightBtn=" + String(e.mods.isRightButtonDown() ? 1 : 0));
+    DEBUG_MIDI("mouseDown: pad=" + String(pad) + " rightBtn=" + String(e.mods.isRightButtonDown() ? 1 : 0));
 
     if (e.mods.isRightButtonDown())
     {
         DEBUG_MIDI("Right click - clearing sample");
         // Right click to clear sample
-        sampler.clearSample(buttonIndex);
-        fileName = "";
-        isLoaded = false;
-        repaint();
-        return;
-    }
-
-    // Find the editor parent
-    Component* parent = getParentComponent();
-    if (parent == nullptr)
-    {
-        DEBUG_MIDI("ERROR: getParentComponent() is nullptr");
-        return;
-    }
-
-    // Traverse up to find SamplerEditor
-    Component* editorParent = parent;
-    while (editorParent != nullptr && dynamic_cast<SamplerEditor*>(editorParent) == nullptr)
-    {
-        editorParent = editorParent->getParentComponent();
-    }
-
-    if (editorParent == nullptr)
-    {
-        DEBUG_MIDI("ERROR: Could not find SamplerEditor in parent hierarchy");
+        sampler.clearSample(pad);
+        setFileName(pad, {});
         return;
     }
 
-    auto* editor = dynamic_cast<SamplerEditor*>(editorParent);
+    auto* editor = findParentComponentOfClass<SamplerEditor>();
     if (editor == nullptr)
     {
-        DEBUG_MIDI("ERROR: dynamic_cast to SamplerEditor failed");
+        DEBUG_MIDI("ERROR: Could not find SamplerEditor in parent hierarchy");
         return;
     }
 
@@ -173,97 +250,122 @@ void SamplerButtonUI::mouseDown(const MouseEvent& e)
     if (editor->isMidiLearning)
     {
         DEBUG_MIDI("MIDI Learn mode active - setting learning button");
-        // Enter listening mode for this button
-        editor->setLearningButtonIndex(buttonIndex);
+        // Enter listening mode for this pad
+        editor->setLearningButtonIndex(pad);
         return;
     }
 
     // Check if we're in Sample Learn mode
     if (editor->isSampleLearning)
     {
-        DEBUG_MIDI(String("Sample Learn mode ACTIVE - calling loadSampleForButton for button ") + String(buttonIndex));
+        DEBUG_MIDI(String("Sample Learn mode ACTIVE - calling loadSampleForButton for pad ") + String(pad));
         // Open file chooser to load sample
-        editor->loadSampleForButton(buttonIndex);
+        editor->loadSampleForButton(pad);
         return;
     }
 
-    // Left click - trigger the sample (flash effect and sound)
-    DEBUG_MIDI("Normal click - triggering sample flash");
-    setActive(true);
-    flash();
-    repaint();
+    // Left click - trigger the sample (flash effect and sound). The pad
+    // lights once its voice starts.
+    flash(pad);
 
-    // Also trigger the sound directly for this button via MIDI
-    int mappedNote = editor->getNoteMapping(buttonIndex);
+    int mappedNote = editor->getNoteMapping(pad);
     DEBUG_MIDI("Click triggering sound for mapped note " + String(mappedNote));
+    editor->playClickedNote(mappedNote);
+}
+
+void PadGrid::mouseDoubleClick(const MouseEvent& e)
+{
+    // Double click to load a sample
+    const int pad = getPadAt(e.getPosition());
+
+    if (auto* editor = findParentComponentOfClass<SamplerEditor>())
+        if (pad >= 0)
+            editor->loadSampleForButton(pad);
+}
 
-    // Send a note-on message to the synth to play the sample
-    MidiMessage noteOn = MidiMessage::noteOn(1, mappedNote, uint8(100));
-    sampler.getMidiCollector().addMessageToQueue(noteOn);
+void PadGrid::setFileName(int pad, const String& name)
+{
+    if (!isPositiveAndBelow(pad, PadLayout::numPads))
+        return;
 
-    // Schedule note-off after a short duration (for one-shot samples)
-    // Use a timer to send note-off
-    editor->startNoteOffTimer(buttonIndex, mappedNote);
+    pads[pad].fileName = name;
+    pads[pad].isLoaded = name.isNotEmpty();
+    markDirty(pad);
 }
 
-void SamplerButtonUI::mouseDoubleClick(const MouseEvent& e)
+void PadGrid::setLoaded(int pad, bool loaded)
 {
-    (void)e;
-    // Double click to load a sample - call parent's method
-    if (getParentComponent() != nullptr)
+    if (isPositiveAndBelow(pad, PadLayout::numPads) && pads[pad].isLoaded != loaded)
     {
-        // Find the SamplerEditor parent
-        Component* parent = getParentComponent();
-        while (parent != nullptr && dynamic_cast<SamplerEditor*>(parent) == nullptr)
-        {
-            parent = parent->getParentComponent();
-        }
-        if (auto* editor = dynamic_cast<SamplerEditor*>(parent))
-        {
-            editor->loadSampleForButton(buttonIndex);
-        }
+        pads[pad].isLoaded = loaded;
+        markDirty(pad);
     }
 }
 
-void SamplerButtonUI::setFileName(const String& name)
+void PadGrid::flash(int pad)
 {
-    fileName = name;
-    isLoaded = name.isNotEmpty();
-    repaint();
+    if (isPositiveAndBelow(pad, PadLayout::numPads))
+    {
+        pads[pad].flashAlpha = 0.5f;
+        markDirty(pad);
+    }
 }
 
-void SamplerButtonUI::setActive(bool active)
+void PadGrid::repaintPad(int pad)
 {
-    isActive = active;
-    repaint();
+    if (isPositiveAndBelow(pad, PadLayout::numPads))
+        markDirty(pad);
 }
 
-bool SamplerButtonUI::getIsActive() const
+bool PadGrid::advanceFlash(int pad)
 {
-    return isActive;
+    auto& state = pads[pad];
+
+    if (state.flashAlpha <= 0.0f)
+        return false;
+
+    state.flashAlpha = jmax(0.0f, state.flashAlpha - 0.1f);
+    markDirty(pad);
+    return state.flashAlpha > 0.0f;
 }
 
-void SamplerButtonUI::flash()
+bool PadGrid::setNoteState(int pad, int note, bool active, float vel, float newPlayhead, float peak)
 {
-    flashAlpha = 0.5f;
+    auto& state = pads[pad];
+    const auto cell = getCellBounds(pad % PadLayout::padsPerBank);
+
+    // About 20 dB per 100 ms at 60 frames a second
+    float newLevel = jmax(jmin(1.0f, peak), state.level * 0.7f);
+    if (newLevel < 0.001f)
+        newLevel = 0.0f;
+
+    if (!active)
+        newPlayhead = 0.0f;
+
+    if (note != state.displayedNote || active != state.isActive || vel != state.velocity
+        || std::abs(newPlayhead - state.playhead) * cell.getWidth() >= 1.0f
+        || std::abs(newLevel - state.level) * cell.getHeight() >= 0.5f)
+    {
+        state.displayedNote = note;
+        state.isActive = active;
+        state.velocity = vel;
+        state.playhead = newPlayhead;
+        state.level = newLevel;
+        markDirty(pad);
+    }
+
+    return state.level > 0.0f;
 }
 
 //==============================================================================
 SamplerEditor::SamplerEditor(SamplerPlugin& plugin)
-    : AudioProcessorEditor(plugin), sampler(plugin), isMidiLearning(false), learningButtonIndex(-1)
+    : AudioProcessorEditor(plugin), sampler(plugin), padGrid(plugin), isMidiLearning(false),
+      performancePanel(plugin.getPerformanceMonitor()), learningButtonIndex(-1)
 {
     DEBUG_MIDI("SamplerEditor::constructor ENTRY");
 
-    // Initialize note tracking array
-    notePlaying.resize(128);
-    notePlaying.fill(false);
-
-    // Initialize velocity tracking array
-    noteVelocities.resize(128);
-    noteVelocities.fill(0.0f);
-
-    setSize(500, 560);
-    DEBUG_MIDI("SamplerEditor: setSize to 500x560");
+    setSize(500, 600);
+    DEBUG_MIDI("SamplerEditor: setSize to 500x600");
 
     // MIDI Learn button at top
     midiLearnButton.setButtonText("MIDI Learn");
@@ -283,11 +385,10 @@ SamplerEditor::SamplerEditor(SamplerPlugin& plugin)
     oneShotButton.setButtonText("One-Shot");
     oneShotButton.addListener(this);
     oneShotButton.setBounds(225, 10, 80, 22);
-    oneShotButton.setToggleState(true, NotificationType::dontSendNotification);  // Default ON
-    isOneShotMode = true;
-    OneShotMode::setEnabled(true);  // Enable one-shot mode by default
+    isOneShotMode = sampler.getEngineSettings().getDefaultMode() == PlaybackMode::oneShot;  // Default ON
+    oneShotButton.setToggleState(isOneShotMode, NotificationType::dontSendNotification);
     addAndMakeVisible(&oneShotButton);
-    DEBUG_MIDI("SamplerEditor: added One-Shot button (default ON)");
+    DEBUG_MIDI("SamplerEditor: added One-Shot button");
 
     // Export button (next to One-Shot)
     exportButton.setButtonText("Export");
@@ -310,29 +411,23 @@ SamplerEditor::SamplerEditor(SamplerPlugin& plugin)
     addAndMakeVisible(&midiLearnLabel);
     DEBUG_MIDI("SamplerEditor: added MIDI Learn label");
 
-    // Create 16 buttons in a 4x4 grid
-    // Button 1 at bottom-left, Button 16 at top-right
-    int buttonSize = 110;
-    int margin = 10;
-    int startX = 15;
-    int startY = 40;
-
-    for (int row = 0; row < 4; row++)
+    // Bank selector above the pads, one radio button per bank
+    const int bankWidth = (470 - (PadLayout::numBanks - 1) * 4) / PadLayout::numBanks;
+    for (int bank = 0; bank < PadLayout::numBanks; bank++)
     {
-        for (int col = 0; col < 4; col++)
-        {
-            // Invert row so button 1 is at bottom-left
-            int index = (3 - row) * 4 + col;
-            SamplerButtonUI* button = new SamplerButtonUI(index, sampler);
-            button->setBounds(startX + col * (buttonSize + margin),
-                            startY + row * (buttonSize + margin),
-                            buttonSize, buttonSize);
-            addAndMakeVisible(button);
-            buttons.add(button);
-            DEBUG_MIDI("SamplerEditor: added button " + String(index) + " at (" + String(startX + col * (buttonSize + margin)) + "," + String(startY + row * (buttonSize + margin)) + ")");
-        }
+        auto* bankButton = bankButtons.add(new TextButton("Bank " + PadLayout::getBankName(bank)));
+        bankButton->setClickingTogglesState(true);
+        bankButton->setRadioGroupId(1);
+        bankButton->addListener(this);
+        bankButton->setBounds(15 + bank * (bankWidth + 4), 40, bankWidth, 22);
+        addAndMakeVisible(bankButton);
     }
-    DEBUG_MIDI("SamplerEditor: created " + String(buttons.size()) + " buttons");
+
+    // The current bank's 16 pads in a 4x4 grid, pad 1 at bottom-left
+    padGrid.setBounds(15, 68, 470, 442);
+    addAndMakeVisible(padGrid);
+    showBank(sampler.getCurrentBank());
+    DEBUG_MIDI("SamplerEditor: added pad grid, bank " + PadLayout::getBankName(padGrid.getBank()));
 
     // Add MIDI status display at bottom (right after pads)
     // Pads end at Y=510
@@ -340,34 +435,50 @@ SamplerEditor::SamplerEditor(SamplerPlugin& plugin)
     addAndMakeVisible(midiStatus);
     DEBUG_MIDI("SamplerEditor: added MIDI status display");
 
-    // Start timer for button state updates
-    startTimer(50);
-    DEBUG_MIDI("SamplerEditor: timer started");
+    // Engine load panel below the status label
+    performancePanel.setBounds(15, 562, 470, 34);
+    addAndMakeVisible(performancePanel);
 
-    // Update button states with loaded file names
-    // Must iterate through buttons array and match by buttonIndex, not array index
-    for (int i = 0; i < buttons.size(); i++)
+    // Live MIDI wakes the frame updates; there is no polling timer
+    sampler.getMidiUiQueue().setListener(this);
+    wakeUp();
+
+    // Update pad states with loaded file names, in every bank
+    for (int pad = 0; pad < SamplerPlugin::numButtons; pad++)
     {
-        int btnIdx = buttons[i]->getButtonIndex();
-        if (sampler.getButton(btnIdx).isLoaded)
+        if (sampler.getButton(pad).isLoaded)
         {
-            File file(sampler.getButton(btnIdx).filePath);
-            buttons[i]->setFileName(file.getFileName());
-            buttons[i]->setLoaded(true);  // Also set the loaded flag
-            String dbgMsg = "Restored: buttonIndex " + String(btnIdx) + " (array pos " + String(i) + ") -> " + file.getFileName();
-            DEBUG_MIDI(dbgMsg);
+            File file(sampler.getButton(pad).filePath);
+            padGrid.setFileName(pad, file.getFileName());
+            DEBUG_MIDI("Restored: pad " + PadLayout::getPadName(pad) + " -> " + file.getFileName());
         }
     }
 
+    // Kits load in the background; pads fill in as each sample arrives
+    sampler.onSampleLoaded = [this](int buttonIndex, int midiNote, bool succeeded)
+    {
+        handleSampleLoaded(buttonIndex, midiNote, succeeded);
+    };
+    sampler.onLoadProgress = [this](int numFinished, int numQueued)
+    {
+        handleLoadProgress(numFinished, numQueued);
+    };
+
     // Auto-load last JSON file if exists
-    loadLastJsonFileOnStartup();
+    // Offline renders load the kit they were given, not the last session's
+    if (!sampler.isNonRealtime())
+        loadLastJsonFileOnStartup();
 
     DEBUG_MIDI("SamplerEditor::constructor EXIT");
 }
 
 SamplerEditor::~SamplerEditor()
 {
-    stopTimer();
+    sampler.getMidiUiQueue().setListener(nullptr);
+    cancelPendingUpdate();
+    frameUpdates.reset();
+    sampler.onSampleLoaded = nullptr;
+    sampler.onLoadProgress = nullptr;
 }
 
 void SamplerEditor::paint(Graphics& g)
@@ -380,87 +491,93 @@ void SamplerEditor::resized()
     // Layout is fixed for now
 }
 
-void SamplerEditor::timerCallback()
+void SamplerEditor::playClickedNote(int midiNote)
+{
+    if (midiNote < 0 || midiNote >= 128)
+        return;
+
+    sampler.getMidiInputQueue().addMessageToQueue(MidiMessage::noteOn(1, midiNote, uint8(100)), clickGateSeconds);
+    lastInputTime = Time::getMillisecondCounter();
+    wakeUp();
+}
+
+// Woken by input and pad changes, and by the last frame update before going
+// idle: attaches or detaches the vblank callback
+void SamplerEditor::handleAsyncUpdate()
 {
-    // Handle note-off timer for click-triggered samples
-    if (pendingNoteOffButton >= 0 && pendingNoteOffNote >= 0)
+    if (!updateFrame())
     {
-        uint32 currentTime = Time::getMillisecondCounter();
-        if (currentTime - noteOffStartTime >= NOTE_OFF_DELAY_MS)
-        {
-            // Send note-off message
-            MidiMessage noteOff = MidiMessage::noteOff(1, pendingNoteOffNote, uint8(0));
-            sampler.getMidiCollector().addMessageToQueue(noteOff);
-            DEBUG_MIDI(String("Sent note-off for note ") + String(pendingNoteOffNote));
-
-            // Reset the pending note-off
-            pendingNoteOffButton = -1;
-            pendingNoteOffNote = -1;
-
-            // If we don't have any notes playing, stop the high-frequency timer
-            // and restart the normal 50ms timer
-            bool anyNotesPlaying = false;
-            for (int i = 0; i < notePlaying.size() && i < 128; i++)
-            {
-                if (notePlaying[i])
-                {
-                    anyNotesPlaying = true;
-                    break;
-                }
-            }
-            if (!anyNotesPlaying)
-            {
-                stopTimer();
-                startTimer(50);
-                DEBUG_MIDI("Reverted to normal 50ms timer");
-            }
-        }
-        // Continue at high frequency if note-off is still pending
+        // The figures stay as they were at the end of the activity
+        performancePanel.update(Time::getMillisecondCounter(), true);
+        frameUpdates.reset();
         return;
     }
 
-    // Update active state based on tracked MIDI notes
-    for (int i = 0; i < 16; i++)
-    {
-        bool wasActive = buttons[i]->getIsActive();
-        int buttonIdx = buttons[i]->getButtonIndex();  // Get the actual button index stored in the button
-        int mappedNote = sampler.getNoteMapping(buttonIdx);
-
-        // Check if this mapped note is currently playing
-        bool shouldBeActive = false;
-        float velocity = 0.0f;
-        if (mappedNote >= 0 && mappedNote < 128 && notePlaying.size() > mappedNote)
+    if (frameUpdates == nullptr)
+        frameUpdates = std::make_unique<VBlankAttachment>(this, [this]
         {
-            shouldBeActive = notePlaying[mappedNote];
-            velocity = noteVelocities.size() > mappedNote ? noteVelocities[mappedNote] : 0.0f;
-        }
+            // Can't detach from inside its own callback, so hand over
+            if (!updateFrame())
+                triggerAsyncUpdate();
+        });
+}
 
-        if (wasActive != shouldBeActive)
-        {
-            buttons[i]->setActive(shouldBeActive);
-            buttons[i]->setVelocity(velocity);
-            if (shouldBeActive)
-            {
-                String msg = "timerCallback: button " + String(buttonIdx + 1) + " ACTIVE (note " + String(mappedNote) + ")";
-                DEBUG_MIDI(msg);
-            }
-            else
-            {
-                DEBUG_MIDI(String("timerCallback: button ") + String(buttonIdx + 1) + " INACTIVE");
-            }
-        }
-        else if (shouldBeActive && buttons[i]->getVelocity() != velocity)
-        {
-            // Update velocity even if active state hasn't changed
-            buttons[i]->setVelocity(velocity);
-        }
+// Returns true while anything on screen is still changing
+bool SamplerEditor::updateFrame()
+{
+    const uint32 now = Time::getMillisecondCounter();
+
+    // Live MIDI queued by the input callback since the last frame
+    MidiUiQueue::Event event;
+    while (sampler.getMidiUiQueue().pop(event))
+    {
+        const auto message = event.toMessage();
+        midiStatus.showMidiMessage(message);
+        handleMidiMessage(message);
+        lastInputTime = now;
     }
+
+    // Each shown pad shows its note's state block; only pads whose state
+    // visibly changed are redrawn. Other banks' pads are left alone.
+    auto& activity = sampler.getVoiceActivity();
+    bool animating = false;
+
+    const int firstPad = PadLayout::getFirstPad(padGrid.getBank());
+    for (int pad = firstPad; pad < firstPad + PadLayout::padsPerBank; pad++)
+    {
+        const int note = sampler.getNoteMapping(pad);
+        const bool valid = note >= 0 && note < VoiceActivity::numNotes;
+        const bool sounding = valid && activity.isSounding(note);
+
+        const bool meterFalling = padGrid.setNoteState(pad, note, sounding,
+                                                       sounding ? activity.getVelocity(note) : 0.0f,
+                                                       sounding ? activity.getPlayhead(note) : 0.0f,
+                                                       valid ? activity.getPeak(note) : 0.0f);
+        const bool flashing = padGrid.advanceFlash(pad);
+        animating = animating || meterFalling || flashing;
+    }
+
+    activity.resetPeaks();
+
+    animating = midiStatus.advance(now) || animating;
+    performancePanel.update(now);
+
+    return animating || activity.isAnySounding() || now - lastInputTime < inputGraceMs;
 }
 
 void SamplerEditor::buttonClicked(Button* button)
 {
     DEBUG_MIDI(String("buttonClicked: ") + button->getButtonText());
 
+    for (int bank = 0; bank < bankButtons.size(); bank++)
+    {
+        if (button == bankButtons[bank])
+        {
+            showBank(bank);
+            return;
+        }
+    }
+
     if (button == &midiLearnButton)
     {
         // Toggle MIDI learn mode - user selects a button, then presses MIDI key
@@ -516,7 +633,7 @@ void SamplerEditor::buttonClicked(Button* button)
     {
         // Toggle One-Shot mode
         isOneShotMode = oneShotButton.getToggleState();
-        OneShotMode::setEnabled(isOneShotMode);
+        sampler.getEngineSettings().setDefaultMode(isOneShotMode ? PlaybackMode::oneShot : PlaybackMode::gate);
         DEBUG_MIDI("One-Shot mode toggled: " + String(isOneShotMode ? "ON" : "OFF"));
         if (isOneShotMode)
         {
@@ -529,38 +646,38 @@ void SamplerEditor::buttonClicked(Button* button)
     }
     else if (button == &exportButton)
     {
-        // Export all settings to JSON
+        // Export all settings to JSON, or the whole kit as a bundle
         DEBUG_MIDI("Export button clicked");
-        exportAllSettings();
+        showExportMenu();
     }
     else if (button == &importButton)
     {
-        // Import all settings from JSON
+        // Import all settings from JSON or a bundle
         DEBUG_MIDI("Import button clicked");
         importAllSettings();
     }
 }
 
-void SamplerEditor::loadSampleForButton(int buttonIndex)
+void SamplerEditor::showBank(int bank)
 {
-    DEBUG_MIDI(String("loadSampleForButton ENTRY for button ") + String(buttonIndex));
-    DEBUG_MIDI(String("  buttons array size = ") + String(buttons.size()));
+    bank = jlimit(0, PadLayout::numBanks - 1, bank);
 
-    // Find the actual button in the buttons array by matching buttonIndex
-    SamplerButtonUI* targetButton = nullptr;
-    for (int i = 0; i < buttons.size(); i++)
-    {
-        if (buttons[i]->getButtonIndex() == buttonIndex)
-        {
-            targetButton = buttons[i];
-            DEBUG_MIDI(String("Found button at array position ") + String(i) + " with buttonIndex=" + String(buttonIndex));
-            break;
-        }
-    }
+    // Only changes which pads the grid shows; nothing is loaded or published
+    sampler.setCurrentBank(bank);
+    padGrid.setBank(bank);
+    bankButtons[bank]->setToggleState(true, NotificationType::dontSendNotification);
+
+    // Pick up the new pads' state on the next frame
+    wakeUp();
+}
+
+void SamplerEditor::loadSampleForButton(int buttonIndex)
+{
+    DEBUG_MIDI(String("loadSampleForButton ENTRY for pad ") + String(buttonIndex));
 
-    if (targetButton == nullptr)
+    if (buttonIndex < 0 || buttonIndex >= SamplerPlugin::numButtons)
     {
-        DEBUG_MIDI("ERROR: Could not find button with buttonIndex=" + String(buttonIndex));
+        DEBUG_MIDI("ERROR: No pad with buttonIndex=" + String(buttonIndex));
         return;
     }
 
@@ -576,7 +693,7 @@ void SamplerEditor::loadSampleForButton(int buttonIndex)
 
     // Use a std::function to store the callback, then call launchAsync
     // This keeps the chooser alive until callback executes
-    fileChooserCallback = [this, buttonIndex, targetButton](const FileChooser& fc)
+    fileChooserCallback = [this, buttonIndex](const FileChooser& fc)
     {
         DEBUG_MIDI(String("File chooser callback triggered for buttonIndex=") + String(buttonIndex));
         File file = fc.getResult();
@@ -590,26 +707,18 @@ void SamplerEditor::loadSampleForButton(int buttonIndex)
             // Load sample for the MIDI note
             if (sampler.loadSampleForMidiNote(midiNote, file))
             {
-                midiLearnLabel.setText("Sample assigned to pad " + String(buttonIndex + 1),
+                midiLearnLabel.setText("Sample assigned to pad " + PadLayout::getPadName(buttonIndex),
                                        NotificationType::sendNotification);
-                DEBUG_MIDI(String("Sample assigned to note ") + String(midiNote) + " (pad " + String(buttonIndex + 1) + ")");
-
-                // Update button UI using the found button pointer
-                DEBUG_MIDI(String("Updating button with buttonIndex=") + String(buttonIndex) + " with fileName");
-                targetButton->setFileName(file.getFileName());
-                // Trigger the button visuals
-                targetButton->setActive(true);
-                targetButton->flash();
-                targetButton->repaint();
+                DEBUG_MIDI(String("Sample assigned to note ") + String(midiNote) + " (pad " + PadLayout::getPadName(buttonIndex) + ")");
+
+                // Update the pad, and trigger its visuals
+                padGrid.setFileName(buttonIndex, file.getFileName());
+                padGrid.flash(buttonIndex);
                 DEBUG_MIDI(String("Button ") + String(buttonIndex) + " UI updated successfully");
 
-                // Play the sample immediately
+                // Play the sample immediately, as a click would
                 DEBUG_MIDI("Playing sample immediately after assignment");
-                MidiMessage noteOn = MidiMessage::noteOn(1, midiNote, uint8(100));
-                sampler.getMidiCollector().addMessageToQueue(noteOn);
-
-                // Schedule note-off
-                startNoteOffTimer(buttonIndex, midiNote);
+                playClickedNote(midiNote);
             }
             else
             {
@@ -639,30 +748,7 @@ void SamplerEditor::handleMidiMessage(const MidiMessage& msg)
 {
     int note = msg.getNoteNumber();
 
-    // Track which notes are playing (for pad visualization)
-    if (msg.isNoteOn() && note >= 0 && note < 128)
-    {
-        if (notePlaying.size() <= note)
-            notePlaying.resize(128);
-        if (noteVelocities.size() <= note)
-            noteVelocities.resize(128);
-
-        float velocity = msg.getVelocity() / 127.0f;  // Normalize to 0-1
-        notePlaying.set(note, true);
-        noteVelocities.set(note, velocity);
-        DEBUG_MIDI(String("NOTE ON: note ") + String(note) + " vel=" + String(int(velocity * 127)));
-    }
-    else if (msg.isNoteOff() && note >= 0 && note < 128)
-    {
-        if (notePlaying.size() <= note)
-            notePlaying.resize(128);
-        if (noteVelocities.size() <= note)
-            noteVelocities.resize(128);
-
-        notePlaying.set(note, false);
-        noteVelocities.set(note, 0.0f);
-        DEBUG_MIDI(String("NOTE OFF: note ") + String(note));
-    }
+    // Pad lights follow the voices (VoiceActivity), not the messages
 
     // Handle MIDI learn - assign note to selected button
     if (isMidiLearning && learningButtonIndex >= 0 && msg.isNoteOn())
@@ -673,8 +759,8 @@ void SamplerEditor::handleMidiMessage(const MidiMessage& msg)
 
         sampler.setNoteMapping(learningButtonIndex, note);
 
-        String buttonNum = String(learningButtonIndex + 1);
-        midiLearnLabel.setText("Button " + buttonNum + " -> " + getNoteName(note),
+        String buttonNum = PadLayout::getPadName(learningButtonIndex);
+        midiLearnLabel.setText("Pad " + buttonNum + " -> " + getNoteName(note),
                                NotificationType::sendNotification);
 
         // Exit learn mode
@@ -684,9 +770,8 @@ void SamplerEditor::handleMidiMessage(const MidiMessage& msg)
 
         DEBUG_MIDI(String("MIDI LEARN complete: button ") + buttonNum + " now mapped to note " + getNoteName(note));
 
-        // Refresh button display to show new note name
-        if (buttonToRepaint >= 0 && buttonToRepaint < buttons.size())
-            buttons[buttonToRepaint]->repaint();
+        // Refresh pad display to show new note name
+        padGrid.repaintPad(buttonToRepaint);
     }
 }
 
@@ -707,12 +792,13 @@ void SamplerEditor::exportAllSettings()
         DynamicObject* jsonObj = new DynamicObject();
         jsonObj->setProperty("version", "1.0");
         jsonObj->setProperty("oneShotMode", isOneShotMode);
+        jsonObj->setProperty("playMode", EngineSettings::modeToString(sampler.getEngineSettings().getDefaultMode()));
 
         // Export button mappings
         // NOTE: Samples are stored in midiNoteSamples, not buttons array
         // So we need to get the file path from midiNoteSamples based on the button's MIDI note mapping
         Array<var> buttonsArray;
-        for (int i = 0; i < 16; i++)
+        for (int i = 0; i < SamplerPlugin::numButtons; i++)
         {
             DynamicObject* buttonObj = new DynamicObject();
             buttonObj->setProperty("index", i);
@@ -729,6 +815,10 @@ void SamplerEditor::exportAllSettings()
                 buttonObj->setProperty("filePath", "");
             }
 
+            // Pads following the kit's mode leave it out
+            if (sampler.getEngineSettings().hasPadMode(i))
+                buttonObj->setProperty("mode", EngineSettings::modeToString(sampler.getEngineSettings().getPadMode(i)));
+
             buttonsArray.add(var(buttonObj));
         }
         jsonObj->setProperty("buttons", var(buttonsArray));
@@ -740,15 +830,56 @@ void SamplerEditor::exportAllSettings()
             DynamicObject* noteObj = new DynamicObject();
             noteObj->setProperty("midiNote", i);
 
-            if (sampler.getMidiNoteSample(i).isLoaded)
+            const ButtonSample& noteSample = sampler.getMidiNoteSample(i);
+            if (noteSample.isLoaded)
             {
-                noteObj->setProperty("filePath", sampler.getMidiNoteSample(i).filePath);
+                noteObj->setProperty("filePath", noteSample.filePath);
+                noteObj->setProperty("quality", Resampler::qualityToString(sampler.getSampleQuality(i)));
+
+                // Velocity layers and round-robin alternates, when there are any
+                if (noteSample.lowVelocity != 0 || noteSample.highVelocity != 127)
+                {
+                    noteObj->setProperty("velocityLow", noteSample.lowVelocity);
+                    noteObj->setProperty("velocityHigh", noteSample.highVelocity);
+                }
+                if (noteSample.selection != ZoneSelection::roundRobin)
+                    noteObj->setProperty("selection", ButtonSampleSound::selectionToString(noteSample.selection));
+
+                if (!noteSample.zones.isEmpty())
+                {
+                    Array<var> zonesArray;
+                    for (auto& zone : noteSample.zones)
+                    {
+                        DynamicObject* zoneObj = new DynamicObject();
+                        zoneObj->setProperty("filePath", zone.filePath);
+                        zoneObj->setProperty("velocityLow", zone.lowVelocity);
+                        zoneObj->setProperty("velocityHigh", zone.highVelocity);
+                        zonesArray.add(var(zoneObj));
+                    }
+                    noteObj->setProperty("zones", var(zonesArray));
+                }
             }
             else
             {
                 noteObj->setProperty("filePath", "");
             }
 
+            if (sampler.getChokeGroup(i) > 0)
+                noteObj->setProperty("chokeGroup", sampler.getChokeGroup(i));
+            if (sampler.getSampleOutput(i) != 0)
+                noteObj->setProperty("output", sampler.getSampleOutput(i));
+            if (sampler.getSamplePan(i) != 0.0f)
+                noteObj->setProperty("pan", sampler.getSamplePan(i));
+
+            const EnvelopeSettings envelope = sampler.getSampleEnvelope(i);
+            if (!envelope.isDefault())
+            {
+                noteObj->setProperty("attack", envelope.attack);
+                noteObj->setProperty("decay", envelope.decay);
+                noteObj->setProperty("sustain", envelope.sustain);
+                noteObj->setProperty("release", envelope.release);
+            }
+
             midiNotesArray.add(var(noteObj));
         }
         jsonObj->setProperty("midiNotes", var(midiNotesArray));
@@ -777,14 +908,15 @@ void SamplerEditor::exportAllSettings()
 void SamplerEditor::importAllSettings()
 {
     File initialDir = File::getSpecialLocation(File::userHomeDirectory);
-    jsonFileChooser = std::make_unique<FileChooser>("Import Settings", initialDir, "*.json");
+    jsonFileChooser = std::make_unique<FileChooser>("Import Settings", initialDir,
+                                                    String("*.json;*") + SampleBundle::fileExtension);
 
     jsonFileChooserCallback = [this](const FileChooser& fc)
     {
         File file = fc.getResult();
         if (file.exists())
         {
-            bool success = loadAllSamplesFromJson(file);
+            bool success = loadKitFile(file);
             if (success)
             {
                 midiLearnLabel.setText("Imported: " + file.getFileName(), NotificationType::sendNotification);
@@ -806,6 +938,89 @@ void SamplerEditor::importAllSettings()
     jsonFileChooser->launchAsync(FileBrowserComponent::openMode, jsonFileChooserCallback);
 }
 
+//==============================================================================
+void SamplerEditor::showExportMenu()
+{
+    PopupMenu menu;
+    menu.addItem("Export Settings (JSON)...", [this] { exportAllSettings(); });
+    menu.addItem("Save as Bundle...", [this] { exportBundle(false); });
+    menu.addItem("Save as Compressed Bundle...", [this] { exportBundle(true); });
+    menu.showMenuAsync(PopupMenu::Options().withTargetComponent(&exportButton));
+}
+
+// Save the whole kit, audio included, as one bundle file
+void SamplerEditor::exportBundle(bool compress)
+{
+    File initialDir = File::getSpecialLocation(File::userHomeDirectory);
+    jsonFileChooser = std::make_unique<FileChooser>("Save as Bundle", initialDir,
+                                                    String("*") + SampleBundle::fileExtension);
+
+    jsonFileChooser->launchAsync(FileBrowserComponent::saveMode | FileBrowserComponent::warnAboutOverwriting,
+                                 [this, compress](const FileChooser& fc)
+    {
+        File file = fc.getResult();
+        if (file == File())
+            return;
+
+        File targetFile = file.withFileExtension(SampleBundle::fileExtension);
+
+        midiLearnLabel.setText("Saving bundle...", NotificationType::sendNotification);
+
+        if (sampler.saveBundle(targetFile, compress))
+        {
+            DEBUG_MIDI("Saved bundle to: " + targetFile.getFullPathName());
+            midiLearnLabel.setText("Saved bundle: " + targetFile.getFileName(), NotificationType::sendNotification);
+            saveLastJsonFile(targetFile);  // Loads at startup like an exported JSON file
+        }
+        else
+        {
+            DEBUG_MIDI("Error: Could not save bundle to " + targetFile.getFullPathName());
+            midiLearnLabel.setText("Save bundle failed!", NotificationType::sendNotification);
+        }
+    });
+}
+
+// Load a bundle: its samples are playable as soon as this returns
+bool SamplerEditor::loadBundle(const File& bundleFile)
+{
+    if (!sampler.loadBundle(bundleFile))
+        return false;
+
+    isOneShotMode = sampler.getEngineSettings().getDefaultMode() == PlaybackMode::oneShot;
+    oneShotButton.setToggleState(isOneShotMode, NotificationType::dontSendNotification);
+
+    refreshPads();
+
+    int numLoaded = 0;
+    for (int note = 0; note < 128; note++)
+        if (sampler.hasSampleForMidiNote(note))
+            numLoaded++;
+
+    midiLearnLabel.setText("Imported: " + String(numLoaded) + " samples from bundle", NotificationType::sendNotification);
+    wakeUp();
+    return true;
+}
+
+// Show each pad's current sample; pads still loading fill in from handleSampleLoaded
+void SamplerEditor::refreshPads()
+{
+    for (int pad = 0; pad < SamplerPlugin::numButtons; pad++)
+    {
+        const int midiNote = sampler.getNoteMapping(pad);
+        const bool loaded = sampler.hasSampleForMidiNote(midiNote);
+
+        padGrid.setFileName(pad, loaded ? File(sampler.getMidiNoteSample(midiNote).filePath).getFileName() : String());
+        padGrid.repaintPad(pad);
+    }
+
+    showBank(sampler.getCurrentBank());
+}
+
+bool SamplerEditor::loadKitFile(const File& file)
+{
+    return SampleBundle::isBundleFile(file) ? loadBundle(file) : loadAllSamplesFromJson(file);
+}
+
 //==============================================================================
 // Load all samples from JSON file
 bool SamplerEditor::loadAllSamplesFromJson(const File& jsonFile)
@@ -836,22 +1051,34 @@ bool SamplerEditor::loadAllSamplesFromJson(const File& jsonFile)
         DEBUG_MIDI(String("  Property: ") + propName);
     }
 
-    int loadedCount = 0;
-    int failedCount = 0;
+    int queuedCount = 0;
+    int keptCount = 0;
+    importLoadedCount = 0;
+    importFailedCount = 0;
 
     // Load one-shot mode
     if (jsonObj->hasProperty("oneShotMode"))
     {
         DEBUG_MIDI("Found oneShotMode property");
         isOneShotMode = jsonObj->getProperty("oneShotMode");
-        oneShotButton.setToggleState(isOneShotMode, NotificationType::dontSendNotification);
-        OneShotMode::setEnabled(isOneShotMode);
+        sampler.getEngineSettings().setDefaultMode(isOneShotMode ? PlaybackMode::oneShot : PlaybackMode::gate);
     }
     else
     {
         DEBUG_MIDI("oneShotMode property NOT found");
     }
 
+    // Newer kits name the mode, which may also be loop or toggle
+    if (jsonObj->hasProperty("playMode"))
+    {
+        auto& settings = sampler.getEngineSettings();
+        settings.setDefaultMode(EngineSettings::modeFromString(jsonObj->getProperty("playMode").toString(),
+                                                               settings.getDefaultMode()));
+        isOneShotMode = settings.getDefaultMode() == PlaybackMode::oneShot;
+    }
+
+    oneShotButton.setToggleState(isOneShotMode, NotificationType::dontSendNotification);
+
     // Load button mappings only - samples are loaded from midiNotes section
     if (jsonObj->hasProperty("buttons"))
     {
@@ -875,29 +1102,29 @@ bool SamplerEditor::loadAllSamplesFromJson(const File& jsonFile)
                         DEBUG_MIDI(String("Button ") + String(index) + ": midiNote=" + String(midiNote) + " filePath=\"" + filePath + "\"");
 
                         // Set note mapping only - samples are loaded from midiNotes section
-                        if (index >= 0 && index < 16)
+                        if (index >= 0 && index < SamplerPlugin::numButtons)
                         {
                             sampler.setNoteMapping(index, midiNote);
-                            // Update the button UI - find the button with this buttonIndex
-                            for (int j = 0; j < buttons.size(); j++)
+
+                            // Pads without a mode of their own follow the kit
+                            if (btnObj->hasProperty("mode"))
+                                sampler.getEngineSettings().setPadMode(index, EngineSettings::modeFromString(
+                                    btnObj->getProperty("mode").toString(), PlaybackMode::gate));
+                            else
+                                sampler.getEngineSettings().clearPadMode(index);
+                            wakeUp();  // Pad state follows the new note on the next frame
+
+                            // Update the pad UI
+                            if (filePath.isNotEmpty())
                             {
-                                if (buttons[j]->getButtonIndex() == index)
-                                {
-                                    if (filePath.isNotEmpty())
-                                    {
-                                        // Will be updated when midiNotes section loads the sample
-                                        String msg = "Button " + String(index) + " (array pos " + String(j) + ") will be updated when sample loads";
-                                        DEBUG_MIDI(msg);
-                                    }
-                                    else
-                                    {
-                                        // Clear the button display for buttons without samples
-                                        buttons[j]->setFileName("");
-                                        buttons[j]->setLoaded(false);
-                                        buttons[j]->repaint();
-                                    }
-                                    break;
-                                }
+                                // Will be updated when midiNotes section loads the sample
+                                DEBUG_MIDI("Pad " + PadLayout::getPadName(index) + " will be updated when sample loads");
+                            }
+                            else
+                            {
+                                // Clear the pad display for pads without samples
+                                padGrid.setFileName(index, {});
+                                padGrid.repaintPad(index);
                             }
                         }
                     }
@@ -927,39 +1154,65 @@ bool SamplerEditor::loadAllSamplesFromJson(const File& jsonFile)
 
                         DEBUG_MIDI(String("MIDI Note ") + String(midiNote) + ": filePath=\"" + filePath + "\"");
 
-                        if (midiNote >= 0 && midiNote < 128 && filePath.isNotEmpty())
+                        // Choke groups and routing come with the kit; older kits have none
+                        sampler.setChokeGroup(midiNote, nObj->getProperty("chokeGroup"));
+                        sampler.setSampleOutput(midiNote, nObj->getProperty("output"));
+                        sampler.setSamplePan(midiNote, static_cast<float>(nObj->getProperty("pan")));
+
+                        EnvelopeSettings envelope;
+                        envelope.attack = static_cast<float>(nObj->getProperty("attack"));
+                        envelope.decay = static_cast<float>(nObj->getProperty("decay"));
+                        envelope.sustain = nObj->hasProperty("sustain") ? static_cast<float>(nObj->getProperty("sustain")) : 1.0f;
+                        envelope.release = static_cast<float>(nObj->getProperty("release"));
+                        sampler.setSampleEnvelope(midiNote, envelope);
+
+                        // Notes the new kit leaves empty are cleared
+                        if (midiNote >= 0 && midiNote < 128 && filePath.isEmpty() && sampler.hasSampleForMidiNote(midiNote))
+                        {
+                            sampler.clearMidiNoteSample(midiNote);
+                        }
+                        else if (midiNote >= 0 && midiNote < 128 && filePath.isNotEmpty())
                         {
                             File sampleFile(filePath);
                             if (sampleFile.exists())
                             {
-                                if (sampler.loadSampleForMidiNote(midiNote, sampleFile))
-                                {
-                                    // Also update the button UI for any button mapped to this MIDI note
-                                    for (int j = 0; j < buttons.size(); j++)
-                                    {
-                                        // Get the actual button number for this array position
-                                        int btnNum = buttons[j]->getButtonIndex();
-                                        // Check if this button is mapped to the current MIDI note
-                                        if (sampler.getNoteMapping(btnNum) == midiNote)
-                                        {
-                                            buttons[j]->setFileName(sampleFile.getFileName());
-                                            buttons[j]->setLoaded(true);
-                                            buttons[j]->repaint();
-                                            String msg = "Updated button " + String(btnNum) + " (array pos " + String(j) + ", mapped to note " + String(midiNote) + ") with file: " + sampleFile.getFileName();
-                                            DEBUG_MIDI(msg);
-                                            break;
-                                        }
-                                    }
-                                    loadedCount++;
-                                }
+                                // Older kits have no quality and keep the default
+                                ResampleQuality quality = ButtonSample::defaultQuality;
+                                if (nObj->hasProperty("quality"))
+                                    quality = Resampler::qualityFromString(nObj->getProperty("quality").toString(), ButtonSample::defaultQuality);
+
+                                // Unchanged files keep their audio. The rest are decoded in
+                                // the background and handleSampleLoaded updates the pads.
+                                if (sampler.reloadSampleForMidiNote(midiNote, sampleFile, quality))
+                                    queuedCount++;
                                 else
+                                    keptCount++;
+
+                                // Velocity layers and round-robin zones; older kits have none
+                                sampler.setZoneSelection(midiNote, ButtonSampleSound::selectionFromString(
+                                    nObj->getProperty("selection").toString(), ZoneSelection::roundRobin));
+                                sampler.setZoneVelocityRange(midiNote, 0,
+                                    nObj->hasProperty("velocityLow") ? (int) nObj->getProperty("velocityLow") : 0,
+                                    nObj->hasProperty("velocityHigh") ? (int) nObj->getProperty("velocityHigh") : 127);
+
+                                // Unchanged zones keep their audio too
+                                Array<SamplerPlugin::ZoneFile> zoneFiles;
+                                var zonesArray = nObj->getProperty("zones");
+                                for (int z = 0; z < zonesArray.size(); z++)
                                 {
-                                    failedCount++;
+                                    File zoneFile(zonesArray[z].getProperty("filePath", "").toString());
+                                    if (zoneFile.existsAsFile())
+                                        zoneFiles.add({ zoneFile,
+                                                        zonesArray[z].getProperty("velocityLow", 0),
+                                                        zonesArray[z].getProperty("velocityHigh", 127) });
+                                    else
+                                        importFailedCount++;
                                 }
+                                sampler.reloadSampleZones(midiNote, zoneFiles);
                             }
                             else
                             {
-                                failedCount++;
+                                importFailedCount++;
                             }
                         }
                     }
@@ -968,20 +1221,64 @@ bool SamplerEditor::loadAllSamplesFromJson(const File& jsonFile)
         }
     }
 
-    DEBUG_MIDI(String("Import summary: loaded=") + String(loadedCount) + " failed=" + String(failedCount));
-    midiLearnLabel.setText("Imported: " + String(loadedCount) + " samples, " + String(failedCount) + " failed",
-                          NotificationType::sendNotification);
+    // Kept samples count as loaded in the final summary
+    importLoadedCount = keptCount;
 
-    // Force repaint of all buttons to show loaded state
-    for (int j = 0; j < buttons.size(); j++)
-    {
-        buttons[j]->repaint();
-    }
+    DEBUG_MIDI(String("Import summary: queued=") + String(queuedCount) + " kept=" + String(keptCount) + " missing=" + String(importFailedCount));
+    if (queuedCount == 0)
+        midiLearnLabel.setText("Imported: " + String(keptCount) + " samples, " + String(importFailedCount) + " failed",
+                              NotificationType::sendNotification);
+    else
+        midiLearnLabel.setText("Loading samples...", NotificationType::sendNotification);
+
+    // Pads keeping their sample show it now; the rest fill in as they load
+    refreshPads();
 
     DEBUG_MIDI(String("loadAllSamplesFromJson EXIT - returning true"));
     return true;
 }
 
+//==============================================================================
+// Called on the message thread as each background load finishes
+void SamplerEditor::handleSampleLoaded(int buttonIndex, int midiNote, bool succeeded)
+{
+    if (!succeeded)
+    {
+        importFailedCount++;
+        return;
+    }
+
+    importLoadedCount++;
+
+    const String fileName = buttonIndex >= 0
+        ? File(sampler.getButton(buttonIndex).filePath).getFileName()
+        : File(sampler.getMidiNoteSample(midiNote).filePath).getFileName();
+
+    // Update the pad, or every pad mapped to this MIDI note, in any bank
+    for (int pad = 0; pad < SamplerPlugin::numButtons; pad++)
+    {
+        if (pad == buttonIndex || (buttonIndex < 0 && sampler.getNoteMapping(pad) == midiNote))
+        {
+            padGrid.setFileName(pad, fileName);
+            DEBUG_MIDI("Updated pad " + PadLayout::getPadName(pad) + " (mapped to note " + String(midiNote) + ") with file: " + fileName);
+        }
+    }
+}
+
+void SamplerEditor::handleLoadProgress(int numFinished, int numQueued)
+{
+    if (numFinished < numQueued)
+    {
+        midiLearnLabel.setText("Loading samples... " + String(numFinished) + "/" + String(numQueued),
+                              NotificationType::sendNotification);
+        return;
+    }
+
+    DEBUG_MIDI(String("Background load finished: loaded=") + String(importLoadedCount) + " failed=" + String(importFailedCount));
+    midiLearnLabel.setText("Imported: " + String(importLoadedCount) + " samples, " + String(importFailedCount) + " failed",
+                          NotificationType::sendNotification);
+}
+
 //==============================================================================
 // Save the last JSON file path to application settings
 void SamplerEditor::saveLastJsonFile(const File& file)
@@ -1031,7 +1328,7 @@ void SamplerEditor::loadLastJsonFileOnStartup()
             if (jsonFile.exists())
             {
                 DEBUG_MIDI(String("Auto-loading last JSON file: ") + filePath);
-                loadAllSamplesFromJson(jsonFile);
+                loadKitFile(jsonFile);
             }
             else
             {
@@ -15,15 +15,6 @@
 #include "juce.h"
 #include "SamplerPlugin.h"
 
-// Debug logging to file (same directory as executable)
-static File getEditorLogFile() { return File::getSpecialLocation(File::currentExecutableFile).getParentDirectory().getChildFile("debug.log"); }
-static void editorLogMessage(const String& msg)
-{
-    File logFile = getEditorLogFile();
-    logFile.appendText(Time::getCurrentTime().toString(true, true, true, true) + ": " + msg + "\n");
-}
-#define DEBUG_MIDI(msg) editorLogMessage(msg)
-
 //==============================================================================
 // Helper function for MIDI note names
 static String getMidiNoteDisplayName(int midiNote)
@@ -35,38 +26,43 @@ static String getMidiNoteDisplayName(int midiNote)
 }
 
 //==============================================================================
-// MIDI Status Display Component
-class MidiStatusDisplay : public Component,
-                          public Timer
+// MIDI Status Display Component. Has no timer of its own: the editor's frame
+// updates call advance while the last note is highlighted.
+class MidiStatusDisplay : public Component
 {
 public:
+    static constexpr uint32 highlightMs = 1000;
+
     MidiStatusDisplay()
     {
         lastNoteText = "---";
         velocityText = "---";
         channelText = "---";
-        startTimerHz(30);
     }
 
-    void timerCallback() override
+    void showMidiMessage(const MidiMessage& msg)
     {
-        if (fadeCounter > 0)
+        if (msg.isNoteOn())
         {
-            fadeCounter--;
+            lastNoteText = getMidiNoteDisplayName(msg.getNoteNumber());
+            velocityText = String(int(msg.getVelocity()));  // Already 0-127
+            channelText = String(msg.getChannel());
+            highlightUntil = Time::getMillisecondCounter() + highlightMs;
+            highlighted = true;
             repaint();
         }
     }
 
-    void showMidiMessage(const MidiMessage& msg)
+    // True while the last note is still highlighted
+    bool advance(uint32 now)
     {
-        if (msg.isNoteOn())
+        if (highlighted && static_cast<int32>(now - highlightUntil) >= 0)
         {
-            lastNoteText = getMidiNoteDisplayName(msg.getNoteNumber());
-            velocityText = String(int(msg.getVelocity()));  // Already 0-127
-            channelText = String(msg.getChannel());
-            fadeCounter = 30;  // 1 second display
+            highlighted = false;
             repaint();
         }
+
+        return highlighted;
     }
 
     void paint(Graphics& g) override
@@ -76,7 +72,7 @@ public:
         g.setColour(Colours::grey);
         g.drawRect(bounds, 1);
 
-        auto textColour = fadeCounter > 0 ? Colours::cyan : Colours::darkblue;
+        auto textColour = highlighted ? Colours::cyan : Colours::darkblue;
         g.setColour(textColour);
         g.setFont(Font(12.0f).withTypefaceStyle("Regular"));
 
@@ -94,52 +90,192 @@ private:
     String lastNoteText;
     String velocityText;
     String channelText;
-    int fadeCounter = 0;
+    uint32 highlightUntil = 0;
+    bool highlighted = false;
 };
 
 //==============================================================================
-class SamplerButtonUI : public Component
+// Engine load panel under the MIDI status bar. Click for export and reset.
+// It has no timer of its own: the editor's frame updates call update, so it
+// refreshes a few times a second while anything plays and holds still, with
+// the figures from the end of the last activity, while the editor is idle.
+class PerformancePanel : public Component
 {
 public:
-    SamplerButtonUI(int index, SamplerPlugin& plugin);
-    ~SamplerButtonUI();
+    static constexpr uint32 updateIntervalMs = 250;
+
+    explicit PerformancePanel(PerformanceMonitor& monitor)
+        : monitor(monitor)
+    {
+    }
+
+    // Reads the monitor at most every updateIntervalMs, unless forced, and
+    // repaints only if the text shown changed
+    void update(uint32 now, bool force = false)
+    {
+        if (!force && now - lastUpdateTime < updateIntervalMs)
+            return;
+
+        lastUpdateTime = now;
+        const auto snapshot = monitor.getSnapshot();
+
+        auto percent = [](double load) { return String(roundToInt(load * 100.0)) + "%"; };
+
+        const String newLoadText = "CPU " + percent(snapshot.lastLoad) + "  avg " + percent(snapshot.averageLoad)
+                                 + "  p50 " + percent(snapshot.p50Load) + "  p95 " + percent(snapshot.p95Load)
+                                 + "  p99 " + percent(snapshot.p99Load) + "  peak " + percent(snapshot.peakLoad);
+
+        const String newCountsText = "XRUNS " + String(snapshot.numOverruns) + " over / " + String(snapshot.numLateBlocks) + " late"
+                                   + "   VOICES " + String(snapshot.activeVoices) + " (peak " + String(snapshot.peakVoices) + ")"
+                                   + "   MIDI " + String(snapshot.averageLatencyMs, 1) + " ms avg / " + String(snapshot.maxLatencyMs, 1) + " max";
+
+        // Red once anything has dropped out
+        const bool newDroppedOut = snapshot.numOverruns > 0 || snapshot.numLateBlocks > 0;
+
+        if (newLoadText == loadText && newCountsText == countsText && newDroppedOut == droppedOut)
+            return;
+
+        loadText = newLoadText;
+        countsText = newCountsText;
+        droppedOut = newDroppedOut;
+        repaint();
+    }
+
+    void paint(Graphics& g) override
+    {
+        auto bounds = getLocalBounds();
+        g.fillAll(Colour(0xFF101010));
+        g.setColour(Colours::grey);
+        g.drawRect(bounds, 1);
+
+        g.setColour(droppedOut ? Colours::orangered : Colours::lightgreen);
+        g.setFont(Font(11.0f).withTypefaceStyle("Regular"));
+
+        g.drawText(loadText, bounds.reduced(6, 3).removeFromTop(14), Justification::centredLeft);
+        g.drawText(countsText, bounds.reduced(6, 3).removeFromBottom(14), Justification::centredLeft);
+    }
+
+    void mouseDown(const MouseEvent&) override
+    {
+        PopupMenu menu;
+        menu.addItem("Export Performance Stats...", [this] { exportStats(); });
+        menu.addItem("Reset Counters", [this]
+        {
+            monitor.reset();
+            update(Time::getMillisecondCounter(), true);
+        });
+        menu.showMenuAsync(PopupMenu::Options().withTargetComponent(this));
+    }
+
+private:
+    void exportStats()
+    {
+        fileChooser = std::make_unique<FileChooser>("Export performance stats (.csv or .json)",
+                                                    File::getSpecialLocation(File::userDocumentsDirectory).getChildFile("sampler-stats.csv"),
+                                                    "*.csv;*.json");
+
+        fileChooser->launchAsync(FileBrowserComponent::saveMode | FileBrowserComponent::canSelectFiles
+                                     | FileBrowserComponent::warnAboutOverwriting,
+                                 [this](const FileChooser& chooser)
+        {
+            auto file = chooser.getResult();
+            if (file == File())
+                return;
+
+            if (!file.hasFileExtension("csv;json"))
+                file = file.withFileExtension("csv");
+
+            if (!monitor.exportToFile(file))
+                DEBUG_MIDI("Failed to export performance stats to " + file.getFullPathName());
+        });
+    }
+
+    PerformanceMonitor& monitor;
+    String loadText, countsText;
+    bool droppedOut = false;
+    uint32 lastUpdateTime = 0;
+    std::unique_ptr<FileChooser> fileChooser;
+};
+
+//==============================================================================
+// Every pad, drawn as one component that shows the current bank's 4x4 grid.
+// State is kept for all banks, but only the shown pads are drawn or updated.
+// Each cell is rendered into a cached image when it changes, and paint
+// only copies the image, so a repaint costs the changed cells rather than the
+// whole grid, however many pads there are. Switching banks just points the
+// cells at other pads.
+class PadGrid : public Component
+{
+public:
+    explicit PadGrid(SamplerPlugin& plugin);
 
     void paint(Graphics& g) override;
     void resized() override;
     void mouseDown(const MouseEvent& e) override;
     void mouseDoubleClick(const MouseEvent& e) override;
 
-    void setFileName(const String& name);
-    void setLoaded(bool loaded) { isLoaded = loaded; }
-    void setActive(bool active);
-    bool getIsActive() const;
-    void flash();
-    void setVelocity(float vel) { velocity = vel; repaint(); }
-    float getVelocity() const { return velocity; }
+    void setBank(int newBank);
+    int getBank() const { return bank; }
+    bool isShown(int pad) const { return PadLayout::getBank(pad) == bank; }
+
+    void setFileName(int pad, const String& name);
+    void setLoaded(int pad, bool loaded);
+    void flash(int pad);
 
-    int getButtonIndex() const { return buttonIndex; }
+    // Redraws a pad whose note mapping has changed
+    void repaintPad(int pad);
+
+    // Frame update: what the pad's note is doing now (playhead 0 to 1, peak
+    // level since the last frame), redrawing only on a change. Returns true
+    // while the level meter is still falling.
+    bool setNoteState(int pad, int note, bool active, float vel, float newPlayhead, float peak);
+
+    // Frame update: fades the click flash, true while it is still visible
+    bool advanceFlash(int pad);
 
 private:
-    int buttonIndex;
+    struct Pad
+    {
+        String fileName;
+        bool isLoaded = false;
+        bool isActive = false;
+        float velocity = 0.0f;   // Current velocity (0.0 to 1.0)
+        float flashAlpha = 0.0f;
+        int displayedNote = -1;
+        float playhead = 0.0f;   // Of the newest voice on the note, 0 to 1
+        float level = 0.0f;      // Meter, falls back after each peak
+    };
+
+    static constexpr int cellMargin = 10;
+
+    // Pad 1 of the bank at bottom-left, pad 16 at top-right
+    Rectangle<int> getCellBounds(int cell) const;
+    int getPadAt(Point<int> position) const;
+
+    void markDirty(int pad);
+    void drawPad(Graphics& g, int pad, Rectangle<float> bounds) const;
+
     SamplerPlugin& sampler;
-    String fileName;
-    bool isActive;
-    bool isLoaded;
-    float velocity;  // Current velocity (0.0 to 1.0)
-    Colour defaultColor;
-    Colour activeColor;
-    Colour loadedColor;
-    Colour activeBorderColor;
-    Rectangle<float> flashRect;
-    float flashAlpha;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplerButtonUI)
+    Pad pads[PadLayout::numPads];
+    int bank = 0;
+
+    // The shown cells as last drawn, at the display's pixel scale
+    Image cache;
+    float cacheScale = 0.0f;
+    bool dirty[PadLayout::padsPerBank] = {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PadGrid)
 };
 
 //==============================================================================
+// Redraws are event driven. MIDI input and pad clicks wake the editor, which
+// then runs frame updates on the display's vblank. Each frame reads the
+// voices' state for every shown pad's note (VoiceActivity) and redraws only
+// pads whose light, playhead or meter moved. When nothing is sounding, animating
+// or arriving, the frame updates stop.
 class SamplerEditor : public AudioProcessorEditor,
-                      public Timer,
-                      public Button::Listener
+                      public Button::Listener,
+                      private AsyncUpdater
 {
 public:
     SamplerEditor(SamplerPlugin& plugin);
@@ -147,7 +283,6 @@ public:
 
     void paint(Graphics& g) override;
     void resized() override;
-    void timerCallback() override;
 
     void buttonClicked(Button* button) override;
 
@@ -156,9 +291,22 @@ public:
 
     void loadSampleForButton(int buttonIndex);
 
-    // Handle MIDI message for learn mode
+    // Shows another bank of pads; every bank keeps playing from MIDI
+    void showBank(int bank);
+
+    // Handle MIDI message for learn mode (message thread, from the frame updates)
     void handleMidiMessage(const MidiMessage& msg);
 
+    // How long a clicked pad's note is held. The engine sends the note-off,
+    // sample-accurately.
+    static constexpr double clickGateSeconds = 0.2;
+
+    // Plays a note as a pad click: a gated note-on through the live MIDI queue
+    void playClickedNote(int midiNote);
+
+    // Starts the frame updates if they are not running (any change to pads)
+    void wakeUp() { triggerAsyncUpdate(); }
+
     // Set the button index for MIDI learning
     void setLearningButtonIndex(int index)
     {
@@ -167,17 +315,6 @@ public:
         DEBUG_MIDI(String("setLearningButtonIndex: button=") + String(index));
     }
 
-    // Timer for sending note-off after clicking a pad
-    void startNoteOffTimer(int buttonIndex, int midiNote)
-    {
-        // Store the note-off info and start a short timer
-        pendingNoteOffButton = buttonIndex;
-        pendingNoteOffNote = midiNote;
-        startTimerHz(100);  // 100Hz - check every 10ms
-        noteOffStartTime = Time::getMillisecondCounter();
-        DEBUG_MIDI(String("Started note-off timer for button ") + String(buttonIndex) + " note " + String(midiNote));
-    }
-
     // Pending sample for MIDI learn assignment
     File pendingSampleFile;
     int sampleLearnButtonIndex = -1;  // Button index for sample learn
@@ -188,32 +325,37 @@ public:
     bool isSampleLearning = false;  // Sample learn mode active
     bool isOneShotMode = false;  // One-shot mode: play sample to completion regardless of note-off
 
-    // Removed setOneShotMode/getOneShotMode from SamplerPlugin - now using OneShotMode namespace
+    // The mode itself is the plugin's "playMode" parameter (EngineSettings)
 
     // Get the MIDI note mapping for a button
     int getNoteMapping(int buttonIndex) const { return sampler.getNoteMapping(buttonIndex); }
 
+    // Load a JSON kit or a kit bundle, by extension. JSON samples load in
+    // the background; the plugin's isLoadingSamples says when they're done.
+    bool loadKitFile(const File& file);
+
     // Get velocity for a mapped note (0.0 to 1.0, or 0 if not playing)
     float getNoteVelocity(int mappedNote) const
     {
-        if (mappedNote >= 0 && mappedNote < noteVelocities.size())
-            return noteVelocities[mappedNote];
+        auto& activity = sampler.getVoiceActivity();
+        if (mappedNote >= 0 && mappedNote < VoiceActivity::numNotes && activity.isSounding(mappedNote))
+            return activity.getVelocity(mappedNote);
         return 0.0f;
     }
 
 private:
     SamplerPlugin& sampler;
-    OwnedArray<SamplerButtonUI> buttons;
+    PadGrid padGrid;
+    OwnedArray<TextButton> bankButtons;  // One per bank, A to H
     TextButton midiLearnButton;
     TextButton sampleLearnButton;
     ToggleButton oneShotButton;  // One-shot mode toggle
-    TextButton exportButton;  // Export settings to JSON
-    TextButton importButton;  // Import settings from JSON
+    TextButton exportButton;  // Export settings to JSON or save a kit bundle
+    TextButton importButton;  // Import settings from JSON or a kit bundle
     Label midiLearnLabel;
     MidiStatusDisplay midiStatus;
+    PerformancePanel performancePanel;
     int learningButtonIndex;  // Button currently listening for MIDI note (-1 = none)
-    Array<float> noteVelocities;  // Track velocity for each note (0-127), 0 = not playing
-    Array<bool> notePlaying;  // Track which notes are currently playing (size 128) - kept for compatibility
 
     // File chooser for sample loading - kept alive to ensure callback executes
     std::unique_ptr<FileChooser> fileChooser;
@@ -223,18 +365,34 @@ private:
     std::unique_ptr<FileChooser> jsonFileChooser;
     std::function<void(const FileChooser&)> jsonFileChooserCallback;
 
-    // Note-off timer for click-triggered samples
-    int pendingNoteOffButton = -1;
-    int pendingNoteOffNote = -1;
-    uint32 noteOffStartTime = 0;
-    static const int NOTE_OFF_DELAY_MS = 200;  // How long each sample plays when clicked
+    // Frame updates: attached to the vblank only while something is changing.
+    // Input keeps them running a little longer, since its voices start on the
+    // audio thread's next block.
+    void handleAsyncUpdate() override;
+    bool updateFrame();
+    std::unique_ptr<VBlankAttachment> frameUpdates;
+    uint32 lastInputTime = 0;
+    static constexpr uint32 inputGraceMs = 250;
 
     // Import/export methods
     void exportAllSettings();
     void importAllSettings();
     bool loadAllSamplesFromJson(const File& jsonFile);
 
-    // Auto-load last JSON file
+    // Kit bundles: the whole kit, audio included, in one file that loads
+    // without decoding
+    void showExportMenu();
+    void exportBundle(bool compress);
+    bool loadBundle(const File& bundleFile);
+    void refreshPads();
+
+    // Background kit loading progress
+    void handleSampleLoaded(int buttonIndex, int midiNote, bool succeeded);
+    void handleLoadProgress(int numFinished, int numQueued);
+    int importLoadedCount = 0;  // Samples loaded by the current import
+    int importFailedCount = 0;  // Missing or undecodable files in the current import
+
+    // Auto-load the last JSON file or bundle
     void saveLastJsonFile(const File& file);
     void loadLastJsonFileOnStartup();
 
@@ -0,0 +1,396 @@
+/*
+  ==============================================================================
+
+    SamplerLog.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Real-time safe asynchronous logging
+
+  ==============================================================================
+*/
+
+#include "SamplerLog.h"
+
+#include <memory>
+
+namespace SamplerLog
+{
+namespace detail
+{
+   #if JUCE_DEBUG
+    std::atomic<int> currentLevel { static_cast<int>(Level::debug) };
+   #else
+    std::atomic<int> currentLevel { static_cast<int>(Level::error) };
+   #endif
+}
+
+namespace
+{
+    //==============================================================================
+    // One fixed-size log record (two cache lines)
+    struct Record
+    {
+        int64 ticks;            // Time::getHighResolutionTicks() at the call site
+        uint8 level;
+        uint8 event;
+        uint8 continuation;     // Number of text-only records that follow this one
+        uint8 textLength;
+        int32 args[3];
+        char text[104];
+    };
+
+    static_assert(sizeof(Record) == 128, "Log records must stay fixed-size");
+
+    constexpr int maxContinuationRecords = 7;
+
+    //==============================================================================
+    // Bounded ring of records. Producers on the audio, MIDI and message threads
+    // claim slots with a single compare-and-swap and publish them through a
+    // per-slot sequence number; the writer thread is the only consumer.
+    class RecordRing
+    {
+    public:
+        explicit RecordRing(size_t capacityPowerOfTwo)
+            : slots(new Slot[capacityPowerOfTwo]), mask(capacityPowerOfTwo - 1)
+        {
+            jassert(isPowerOfTwo(capacityPowerOfTwo));
+
+            for (size_t i = 0; i < capacityPowerOfTwo; ++i)
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        // Claims numRecords consecutive slots, or fails without blocking when full
+        bool push(const Record* records, int numRecords) noexcept
+        {
+            size_t pos = enqueuePos.load(std::memory_order_relaxed);
+
+            for (;;)
+            {
+                // The consumer frees slots in order, so if the last slot we need
+                // is free, every slot before it is free too
+                auto& last = slots[(pos + (size_t) numRecords - 1) & mask];
+                auto seq = last.sequence.load(std::memory_order_acquire);
+                auto diff = (intptr_t) seq - (intptr_t) (pos + (size_t) numRecords - 1);
+
+                if (diff == 0)
+                {
+                    if (enqueuePos.compare_exchange_weak(pos, pos + (size_t) numRecords, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            for (int i = 0; i < numRecords; ++i)
+            {
+                auto& slot = slots[(pos + (size_t) i) & mask];
+                slot.record = records[i];
+                slot.sequence.store(pos + (size_t) i + 1, std::memory_order_release);
+            }
+
+            return true;
+        }
+
+        // Writer thread only
+        bool pop(Record& result) noexcept
+        {
+            auto& slot = slots[dequeuePos & mask];
+
+            if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+                return false;
+
+            result = slot.record;
+            slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+            ++dequeuePos;
+            return true;
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> sequence { 0 };
+            Record record;
+        };
+
+        std::unique_ptr<Slot[]> slots;
+        const size_t mask;
+        alignas(64) std::atomic<size_t> enqueuePos { 0 };
+        alignas(64) size_t dequeuePos = 0;
+    };
+
+    //==============================================================================
+    // Formats and appends queued records to the log file
+    class Writer : public Thread
+    {
+    public:
+        Writer(RecordRing& r, std::atomic<uint32>& d, const File& file)
+            : Thread("SamplerLog writer"), ring(r), dropped(d), logFile(file)
+        {
+            startMillis = Time::currentTimeMillis();
+            startTicks = Time::getHighResolutionTicks();
+        }
+
+        ~Writer() override
+        {
+            stopThread(2000);
+        }
+
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                drain();
+                wait(flushIntervalMs);
+            }
+
+            drain();
+        }
+
+    private:
+        static constexpr int flushIntervalMs = 50;
+
+        void drain()
+        {
+            MemoryOutputStream batch;
+            Record record;
+
+            for (;;)
+            {
+                // Continuation records belonging to a message may not be
+                // published yet; pick the message up again next time round
+                if (pendingContinuations > 0)
+                {
+                    if (!ring.pop(record))
+                        break;
+
+                    pendingText += String::fromUTF8(record.text, record.textLength);
+
+                    if (--pendingContinuations == 0)
+                        writeLine(batch, pendingTicks, pendingText);
+
+                    continue;
+                }
+
+                if (!ring.pop(record))
+                    break;
+
+                if (static_cast<Event>(record.event) == Event::text)
+                {
+                    pendingText = String::fromUTF8(record.text, record.textLength);
+                    pendingTicks = record.ticks;
+                    pendingContinuations = record.continuation;
+
+                    if (pendingContinuations == 0)
+                        writeLine(batch, pendingTicks, pendingText);
+                }
+                else
+                {
+                    writeLine(batch, record.ticks, formatEvent(record));
+                }
+            }
+
+            auto numDropped = dropped.load(std::memory_order_relaxed);
+            if (numDropped != reportedDropped)
+            {
+                writeLine(batch, Time::getHighResolutionTicks(),
+                          "SamplerLog: " + String(numDropped - reportedDropped) + " records dropped (ring full)");
+                reportedDropped = numDropped;
+            }
+
+            if (batch.getDataSize() == 0)
+                return;
+
+            FileOutputStream stream(logFile);
+            if (stream.openedOk())
+            {
+                stream.write(batch.getData(), batch.getDataSize());
+                stream.flush();
+            }
+        }
+
+        void writeLine(MemoryOutputStream& batch, int64 ticks, const String& message)
+        {
+            auto millis = startMillis + (int64) (Time::highResolutionTicksToSeconds(ticks - startTicks) * 1000.0);
+            batch << Time(millis).toString(true, true, true, true) << ": " << message << "\n";
+        }
+
+        static String formatEvent(const Record& record)
+        {
+            switch (static_cast<Event>(record.event))
+            {
+                case Event::voiceStart:
+                    return "MidiSamplerVoice::startNote note=" + String(record.args[0]) +
+                           " velocity=" + String(record.args[1]);
+
+                case Event::voiceStop:
+                    return "MidiSamplerVoice::stopNote note=" + String(record.args[0]) +
+                           " isPlaying=" + String(record.args[1] != 0 ? "true" : "false");
+
+                case Event::midiIn:
+                {
+                    const uint8 bytes[] = { static_cast<uint8>(record.args[0]), static_cast<uint8>(record.args[1]),
+                                            static_cast<uint8>(record.args[2]) };
+                    const int size = jlimit(1, 3, MidiMessage::getMessageLengthFromFirstByte(bytes[0]));
+                    return "MIDI in: " + MidiMessage(bytes, size).getDescription();
+                }
+
+                case Event::text:
+                default:
+                    break;
+            }
+
+            return "Unknown log event " + String((int) record.event);
+        }
+
+        RecordRing& ring;
+        std::atomic<uint32>& dropped;
+        File logFile;
+        int64 startMillis = 0;
+        int64 startTicks = 0;
+        uint32 reportedDropped = 0;
+
+        String pendingText;
+        int64 pendingTicks = 0;
+        int pendingContinuations = 0;
+    };
+
+    //==============================================================================
+    struct LogState
+    {
+        RecordRing ring { 4096 };
+        std::atomic<uint32> dropped { 0 };
+        std::unique_ptr<Writer> writer;
+    };
+
+    LogState& getState()
+    {
+        static LogState state;
+        return state;
+    }
+
+    void pushRecords(const Record* records, int numRecords) noexcept
+    {
+        auto& state = getState();
+        if (!state.ring.push(records, numRecords))
+            state.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+//==============================================================================
+void setLevel(Level newLevel)
+{
+    detail::currentLevel.store(static_cast<int>(newLevel), std::memory_order_relaxed);
+}
+
+Level getLevel()
+{
+    return static_cast<Level>(detail::currentLevel.load(std::memory_order_relaxed));
+}
+
+Level levelFromString(const String& name, Level defaultLevel)
+{
+    for (auto level : { Level::off, Level::error, Level::info, Level::debug })
+        if (name.equalsIgnoreCase(levelToString(level)))
+            return level;
+
+    return defaultLevel;
+}
+
+String levelToString(Level level)
+{
+    switch (level)
+    {
+        case Level::off:   return "off";
+        case Level::error: return "error";
+        case Level::info:  return "info";
+        case Level::debug: return "debug";
+        default:           break;
+    }
+
+    return {};
+}
+
+void start(const File& logFile)
+{
+    auto& state = getState();
+    if (state.writer != nullptr)
+        return;
+
+    state.writer = std::make_unique<Writer>(state.ring, state.dropped, logFile);
+    state.writer->startThread(Thread::Priority::low);
+}
+
+void stop()
+{
+    getState().writer.reset();
+}
+
+void text(Level level, const String& message)
+{
+    if (!isEnabled(level))
+        return;
+
+    Record records[maxContinuationRecords + 1];
+    auto ticks = Time::getHighResolutionTicks();
+
+    auto utf8 = message.toRawUTF8();
+    auto remaining = (int) message.getNumBytesAsUTF8();
+    int numRecords = 0;
+
+    do
+    {
+        auto& record = records[numRecords];
+        auto chunk = jmin(remaining, (int) sizeof(record.text));
+
+        // Don't split a multi-byte character across two records
+        if (chunk < remaining)
+            while (chunk > 0 && (static_cast<uint8>(utf8[chunk]) & 0xc0) == 0x80)
+                --chunk;
+
+        record.ticks = ticks;
+        record.level = static_cast<uint8>(level);
+        record.event = static_cast<uint8>(Event::text);
+        record.continuation = 0;
+        record.textLength = static_cast<uint8>(chunk);
+        memcpy(record.text, utf8, (size_t) chunk);
+
+        utf8 += chunk;
+        remaining -= chunk;
+        ++numRecords;
+    }
+    while (remaining > 0 && numRecords <= maxContinuationRecords);
+
+    records[0].continuation = static_cast<uint8>(numRecords - 1);
+    pushRecords(records, numRecords);
+}
+
+void event(Level level, Event type, int a, int b, int c) noexcept
+{
+    if (!isEnabled(level))
+        return;
+
+    Record record;
+    record.ticks = Time::getHighResolutionTicks();
+    record.level = static_cast<uint8>(level);
+    record.event = static_cast<uint8>(type);
+    record.continuation = 0;
+    record.textLength = 0;
+    record.args[0] = a;
+    record.args[1] = b;
+    record.args[2] = c;
+
+    pushRecords(&record, 1);
+}
+
+uint32 getNumDropped() noexcept
+{
+    return getState().dropped.load(std::memory_order_relaxed);
+}
+}
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    SamplerLog.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Real-time safe asynchronous logging
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+
+#include <atomic>
+
+//==============================================================================
+// Logging that is safe to call from the audio and MIDI threads.
+//
+// Callers push fixed-size binary records into a lock-free ring; nothing is
+// formatted or written on the calling thread except copying the text. A
+// background writer thread drains the ring, formats the records and appends
+// them to the log file in batches.
+namespace SamplerLog
+{
+    enum class Level : int
+    {
+        off = 0,
+        error,
+        info,
+        debug
+    };
+
+    // Binary events recorded by the audio thread, formatted by the writer
+    enum class Event : uint8
+    {
+        text = 0,
+        voiceStart,     // a = note, b = velocity (0-127)
+        voiceStop,      // a = note, b = isPlaying
+        midiIn          // a, b, c = the message's bytes
+    };
+
+    namespace detail
+    {
+        extern std::atomic<int> currentLevel;
+    }
+
+    // Cheap enough to call before building any log string
+    inline bool isEnabled(Level level) noexcept
+    {
+        return static_cast<int>(level) <= detail::currentLevel.load(std::memory_order_relaxed);
+    }
+
+    void setLevel(Level newLevel);
+    Level getLevel();
+    Level levelFromString(const String& name, Level defaultLevel);
+    String levelToString(Level level);
+
+    // Start/stop the background writer (message thread only)
+    void start(const File& logFile);
+    void stop();
+
+    // Queue a text message (any thread; long messages span several records)
+    void text(Level level, const String& message);
+
+    // Queue a binary event without any string work (audio thread)
+    void event(Level level, Event type, int a = 0, int b = 0, int c = 0) noexcept;
+
+    // Records lost because the ring was full
+    uint32 getNumDropped() noexcept;
+}
+
+#define SAMPLER_LOG(level, msg) \
+    do { if (SamplerLog::isEnabled(level)) SamplerLog::text(level, msg); } while (false)
+
+#define DEBUG_MIDI(msg) SAMPLER_LOG(SamplerLog::Level::debug, msg)
@@ -11,41 +11,473 @@
 */
 
 #include "SamplerPlugin.h"
-#include "SamplerEditor.h"
+#if !SAMPLER_HEADLESS
+ #include "SamplerEditor.h"
+#endif
+#include "SampleRenderKernels.h"
+#include "SampleResampler.h"
+#include "SampleBundle.h"
 
 //==============================================================================
-// One-shot mode namespace implementation
-namespace OneShotMode
+ButtonSampleSound::ButtonSampleSound(int buttonIndex, const Array<SampleZone>& sampleZones, int rootNote,
+                                     ResampleQuality quality, int outputBus, float pan, ZoneSelection selection,
+                                     const EnvelopeSettings& envelope)
+    : buttonIndex(buttonIndex), rootNote(rootNote), quality(quality), outputBus(outputBus), pan(pan),
+      attack(envelope.attack), decay(envelope.decay), sustain(envelope.sustain), release(envelope.release),
+      zones(sampleZones), selection(selection)
 {
-    bool isEnabled = false;
+    jassert(!zones.isEmpty() && zones.size() <= ButtonSample::maxZones);
 
-    void setEnabled(bool enable)
+    // Alternates of one layer end up next to each other
+    std::stable_sort(zones.begin(), zones.end(), [](const SampleZone& a, const SampleZone& b)
     {
-        isEnabled = enable;
+        return a.lowVelocity != b.lowVelocity ? a.lowVelocity < b.lowVelocity : a.highVelocity < b.highVelocity;
+    });
+
+    int numLayers = 0;
+    int rangeLow[ButtonSample::maxZones], rangeHigh[ButtonSample::maxZones];
+    Random random;
+
+    for (int first = 0; first < zones.size();)
+    {
+        int end = first + 1;
+        while (end < zones.size() && zones.getReference(end).lowVelocity == zones.getReference(first).lowVelocity
+               && zones.getReference(end).highVelocity == zones.getReference(first).highVelocity)
+            ++end;
+
+        const int numAlternates = end - first;
+        auto& layer = layers[numLayers];
+        layer.firstZone = first;
+        layer.sequenceLength = static_cast<uint32>(numAlternates * (maxSequenceLength / numAlternates));
+
+        // Round robin goes in order. Random plays shuffled passes over the
+        // alternates, never repeating one across the join between passes.
+        for (uint32 i = 0; i < layer.sequenceLength; i += static_cast<uint32>(numAlternates))
+        {
+            for (int j = 0; j < numAlternates; ++j)
+                layer.sequence[i + static_cast<uint32>(j)] = static_cast<uint8>(j);
+
+            if (selection == ZoneSelection::random && numAlternates > 1)
+            {
+                for (int j = numAlternates; --j > 0;)
+                    std::swap(layer.sequence[i + static_cast<uint32>(j)], layer.sequence[i + static_cast<uint32>(random.nextInt(j + 1))]);
+
+                if (i > 0 && layer.sequence[i] == layer.sequence[i - 1])
+                    std::swap(layer.sequence[i], layer.sequence[i + 1]);
+            }
+        }
+
+        rangeLow[numLayers] = zones.getReference(first).lowVelocity;
+        rangeHigh[numLayers] = zones.getReference(first).highVelocity;
+        ++numLayers;
+        first = end;
+    }
+
+    // Each velocity goes to the last layer covering it, or failing that the
+    // nearest one
+    for (int velocity = 0; velocity < 128; ++velocity)
+    {
+        int best = 0;
+        int bestDistance = std::numeric_limits<int>::max();
+
+        for (int i = 0; i < numLayers; ++i)
+        {
+            const int distance = velocity < rangeLow[i] ? rangeLow[i] - velocity
+                               : velocity > rangeHigh[i] ? velocity - rangeHigh[i] : 0;
+
+            if (distance <= bestDistance)
+            {
+                best = i;
+                bestDistance = distance;
+            }
+        }
+
+        velocityToLayer[velocity] = static_cast<uint8>(best);
+    }
+}
+
+String ButtonSampleSound::selectionToString(ZoneSelection zoneSelection)
+{
+    return zoneSelection == ZoneSelection::random ? "random" : "roundRobin";
+}
+
+ZoneSelection ButtonSampleSound::selectionFromString(const String& name, ZoneSelection defaultSelection)
+{
+    for (auto candidate : { ZoneSelection::roundRobin, ZoneSelection::random })
+        if (name.equalsIgnoreCase(selectionToString(candidate)))
+            return candidate;
+
+    return defaultSelection;
+}
+
+//==============================================================================
+void MidiSamplerVoice::renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    alignas(16) float left[RenderKernels::maxSegmentSize];
+    alignas(16) float right[RenderKernels::maxSegmentSize];
+    float* const scratch[] = { left, right };
+
+    // A stolen or choked note keeps fading out under whatever comes next
+    if (fadeSamplesLeft > 0)
+        renderFadeOut(outputBuffer, startSample, numSamples, scratch);
+
+    if (current.sample == nullptr)
+    {
+        // A released note with nothing to play ends here
+        if (!isPlaying && isVoiceActive())
+            endNote();
+        return;
+    }
+
+    const int totalLength = current.sample->getTotalLength();
+    float peak = 0.0f;
+
+    const bool looping = current.looping;
+
+    for (int done = 0; done < numSamples && !envelope.isFinished();)
+    {
+        // Segments stop at envelope stage changes, so each one takes a
+        // single gain ramp; a sample about to run out is faded to silence
+        if (!looping)
+            envelope.fadeOutBefore(RenderKernels::numSamplesBeforeEnd(current.position, current.pitchRatio, totalLength));
+
+        const int segment = nextSegment(current, scratch, jmin(numSamples - done, envelope.getSamplesInStage()));
+
+        if (segment == 0)
+        {
+            if (looping && current.sample->getLoop() == nullptr && restartLoop())
+                continue;
+            break;
+        }
+
+        envelope.apply(scratch, current.numChannels, segment);
+
+        // Level for the pad's meter and for voice stealing, at the gains it
+        // is played with
+        for (int ch = 0; ch < current.numChannels; ++ch)
+        {
+            const auto range = FloatVectorOperations::findMinAndMax(scratch[ch], segment);
+            const float gain = current.numChannels > 1 ? (ch == 0 ? current.leftGain : current.rightGain)
+                                                       : jmax(current.leftGain, current.rightGain);
+            peak = jmax(peak, gain * jmax(-range.getStart(), range.getEnd()));
+        }
+
+        addToOutput(outputBuffer, current, startSample + done, scratch, segment);
+        done += segment;
+    }
+
+    outputLevel = envelope.isAttacking() ? jmax(peak, velocity) : peak;
+    reportPlayed(peak);
+
+    // Sample or release ended; loops only end with their release
+    if (envelope.isFinished()
+        || (!looping && RenderKernels::numSamplesBeforeEnd(current.position, current.pitchRatio, totalLength) == 0))
+    {
+        isPlaying = false;
+        endNote();
+    }
+}
+
+bool MidiSamplerVoice::restartLoop()
+{
+    const int totalLength = current.sample->getTotalLength();
+
+    if (totalLength <= 0)
+        return false;
+
+    current.position = std::fmod(current.position, static_cast<double>(totalLength));
+
+    // The stream has read on past the end; restart it where the preload ends
+    if (current.streamId != 0)
+    {
+        stream->stop();
+        current.streamId = stream->start(current.sample.get(),
+                                         jmax(0, current.sample->getNumSamples() - SampleStreamer::overlapFrames));
+    }
+
+    return true;
+}
+
+void MidiSamplerVoice::renderFadeOut(AudioBuffer<float>& outputBuffer, int startSample, int numSamples, float* const* scratch)
+{
+    const int length = jmin(numSamples, fadeSamplesLeft);
+    const float step = fadeLevel / static_cast<float>(fadeLength);
+
+    for (int done = 0; done < length;)
+    {
+        const int segment = nextSegment(fade, scratch, length - done);
+
+        if (segment == 0)
+        {
+            fadeSamplesLeft = 0;
+            break;
+        }
+
+        // Linear ramp down to silence, continuing across segments and blocks
+        for (int ch = 0; ch < fade.numChannels; ++ch)
+            RenderKernels::applyGainRamp(scratch[ch], static_cast<float>(fadeSamplesLeft) * step, -step, segment);
+
+        addToOutput(outputBuffer, fade, startSample + done, scratch, segment);
+        fadeSamplesLeft -= segment;
+        done += segment;
+    }
+
+    if (fadeSamplesLeft <= 0)
+        releaseFade();
+}
+
+void MidiSamplerVoice::fadeOutNote()
+{
+    if (current.sample != nullptr && !envelope.isFinished())
+    {
+        // A fade still running from an earlier steal is cut short
+        releaseFade();
+
+        fade = current;
+        fadeSound = getCurrentlyPlayingSound();
+        fadeLength = jmax(1, roundToInt(getSampleRate() * fadeOutSeconds));
+        fadeSamplesLeft = fadeLength;
+        fadeLevel = envelope.getLevel();
+
+        // The stream stays with the voice for the next note
+        captureFadeWindow();
+        fade.streamId = 0;
+    }
+
+    SamplerLog::event(SamplerLog::Level::debug, SamplerLog::Event::voiceStop, midiNoteNumber, isPlaying ? 1 : 0);
+
+    isPlaying = false;
+    endNote();
+}
+
+// Copies the stream frames the fade will read, while they are still there.
+// Only frames past what the preload covers come from the stream, so a fade
+// starting in the preload saves from where the preload stops serving reads.
+void MidiSamplerVoice::captureFadeWindow()
+{
+    fade.fromFadeWindow = false;
+    fadeWindowFrames = 0;
+
+    if (stream == nullptr || fade.streamId == 0 || !fade.sample->isStreamed())
+        return;
+
+    const int preloadLength = fade.sample->getNumSamples();
+    const double lastPosition = fade.position + fade.pitchRatio * (fadeLength - 1);
+    const int end = jmin(fade.sample->getTotalLength(),
+                         static_cast<int>(lastPosition) + SampleStreamer::kernelMargin + 1);
+
+    fadeWindowStart = jmax(static_cast<int>(fade.position), preloadLength - SampleStreamer::kernelMargin)
+                      - SampleStreamer::kernelMargin;
+
+    if (end <= fadeWindowStart)
+        return;
+
+    const float* window[SampleStreamer::maxChannels] = {};
+    const int ready = stream->getWindow(fade.streamId, fadeWindowStart, window);
+
+    // Whatever the disk hasn't delivered, or doesn't fit, fades out of silence
+    fadeWindowFrames = jmin(ready, end - fadeWindowStart, fadeWindow.getNumSamples());
+
+    if (fadeWindowFrames <= 0)
+    {
+        fadeWindowFrames = 0;
+        return;
+    }
+
+    for (int ch = 0; ch < fade.numChannels; ++ch)
+        FloatVectorOperations::copy(fadeWindow.getWritePointer(ch), window[ch], fadeWindowFrames);
+
+    fade.fromFadeWindow = true;
+}
+
+void MidiSamplerVoice::addToOutput(AudioBuffer<float>& outputBuffer, const Playback& playback, int startSample,
+                                   const float* const* scratch, int numSamples) const noexcept
+{
+    // Disabled or missing buses play through the main output
+    int firstChannel = 0;
+    int numBusChannels = jmin(2, outputBuffer.getNumChannels());
+
+    if (buses != nullptr)
+    {
+        const int bus = isPositiveAndBelow(playback.outputBus, OutputBusLayout::maxBuses)
+                            && buses->numChannels[playback.outputBus] > 0 ? playback.outputBus : 0;
+
+        firstChannel = buses->firstChannel[bus];
+        numBusChannels = jmin(2, buses->numChannels[bus], outputBuffer.getNumChannels() - firstChannel);
+    }
+
+    RenderKernels::addToBus(outputBuffer, firstChannel, numBusChannels, startSample,
+                            scratch[0], scratch[playback.numChannels > 1 ? 1 : 0],
+                            playback.leftGain, playback.rightGain, numSamples);
+}
+
+int MidiSamplerVoice::mixSegment(Playback& playback, float* const* scratch, int maxSamples)
+{
+    const auto& sample = *playback.sample;
+    const double position = playback.position;
+    const double pitchRatio = playback.pitchRatio;
+
+    const bool streamed = sample.isStreamed();
+    const bool converted = sample.needsConversion();
+    const int totalLength = sample.getTotalLength();
+    const int preloadLength = sample.getNumSamples();
+
+    // Left and right, or one channel for mono; further channels are ignored,
+    // as streams and decode windows only carry two
+    const int numSourceChannels = playback.numChannels;
+
+    // Each segment stops at the end of the block, the end of the sample
+    // or the size of the scratch buffer, whichever comes first
+    int segment = jmin(maxSamples, RenderKernels::maxSegmentSize,
+                       RenderKernels::numSamplesBeforeEnd(position, pitchRatio, totalLength));
+
+    if (segment <= 0)
+        return 0;
+
+    // Where this segment reads from: the in-memory audio, or for a
+    // streamed sample past its preload, a window of the voice's stream
+    const float* const* source = sample.buffer.getArrayOfReadPointers();
+    const float* window[SampleStreamer::maxChannels] = {};
+    int sourceStart = 0;
+    int sourceLength = preloadLength;
+
+    if (converted)
+    {
+        // Convert just the frames this segment's taps touch
+        const int maxForWindow = static_cast<int>((decodeWindowFrames - 4 * SampleStreamer::kernelMargin) / pitchRatio);
+        segment = jmin(segment, jmax(1, maxForWindow));
+
+        sourceStart = static_cast<int>(position) - SampleStreamer::kernelMargin;
+        sourceLength = jmin(decodeWindowFrames,
+                            static_cast<int>(position + pitchRatio * (segment - 1)) + SampleStreamer::kernelMargin + 1 - sourceStart);
+
+        sample.readFrames(sourceStart, sourceLength, decodeWindow.getArrayOfWritePointers(), numSourceChannels);
+        source = decodeWindow.getArrayOfReadPointers();
+    }
+    else if (streamed)
+    {
+        const int inPreload = RenderKernels::numSamplesBeforeEnd(position, pitchRatio,
+                                                                 preloadLength - SampleStreamer::kernelMargin);
+        if (inPreload > 0)
+        {
+            segment = jmin(segment, inPreload);
+        }
+        else
+        {
+            // Keep the segment's reads inside one stream window
+            const int maxForWindow = static_cast<int>((SampleStreamer::bufferFrames - 4 * SampleStreamer::kernelMargin) / pitchRatio);
+            segment = jmin(segment, jmax(1, maxForWindow));
+
+            sourceStart = static_cast<int>(position) - SampleStreamer::kernelMargin;
+            const int needed = static_cast<int>(position + pitchRatio * (segment - 1)) + SampleStreamer::kernelMargin + 1 - sourceStart;
+            const int ready = playback.fromFadeWindow ? getFadeWindow(sourceStart, window)
+                            : stream != nullptr ? stream->getWindow(playback.streamId, sourceStart, window) : 0;
+
+            // Disk fell behind: leave a gap rather than drift out of time
+            if (ready < needed && sourceStart + ready < totalLength)
+            {
+                if (stream != nullptr && playback.streamId != 0)
+                    stream->addUnderrun();
+
+                for (int ch = 0; ch < numSourceChannels; ++ch)
+                    FloatVectorOperations::clear(scratch[ch], segment);
+                playback.position += pitchRatio * segment;
+                return segment;
+            }
+
+            source = window;
+            sourceLength = jmin(ready, totalLength - sourceStart);
+        }
+    }
+
+    const double readPosition = position - sourceStart;
+
+    const bool unity = pitchRatio == 1.0 && position == std::floor(position);
+
+    for (int ch = 0; ch < numSourceChannels; ++ch)
+    {
+        if (unity)
+            RenderKernels::mixDownUnity(scratch[ch], source + ch, 1, static_cast<int>(readPosition), 1.0f, segment);
+        else
+            Resampler::mixDown(playback.quality, scratch[ch], source + ch, 1, sourceLength,
+                               readPosition, pitchRatio, 1.0f, segment);
+    }
+
+    playback.position += pitchRatio * segment;
+    return segment;
+}
+
+int MidiSamplerVoice::mixLoopSegment(Playback& playback, float* const* scratch, int maxSamples)
+{
+    const auto& loop = *playback.sample->getLoop();
+    const int crossfadeStart = loop.getCrossfadeStart();
+
+    // The one wrap check, per segment
+    if (playback.position >= loop.getEnd())
+    {
+        playback.position = loop.getStart() + std::fmod(playback.position - loop.getStart(), static_cast<double>(loop.getLength()));
+        playback.inLoopTail = false;
+    }
+
+    // Up to the crossfade the sample plays as it is
+    const int beforeTail = RenderKernels::numSamplesBeforeEnd(playback.position, playback.pitchRatio, crossfadeStart);
+
+    if (beforeTail > 0)
+        return mixSegment(playback, scratch, jmin(maxSamples, beforeTail));
+
+    // A streamed sample's stream restarts where the loop comes back to,
+    // while the tail plays from memory
+    if (!playback.inLoopTail)
+    {
+        playback.inLoopTail = true;
+
+        if (playback.streamId != 0)
+        {
+            stream->stop();
+            playback.streamId = stream->start(playback.sample.get(),
+                                              jmax(0, jmax(loop.getStart(), playback.sample->getNumSamples()) - SampleStreamer::overlapFrames));
+        }
     }
 
-    bool getEnabled()
+    const int segment = jmin(maxSamples, RenderKernels::maxSegmentSize,
+                             RenderKernels::numSamplesBeforeEnd(playback.position, playback.pitchRatio, loop.getEnd()));
+
+    if (segment <= 0)
+        return 0;
+
+    const double readPosition = playback.position - loop.getTailStart();
+    const bool unity = playback.pitchRatio == 1.0 && playback.position == std::floor(playback.position);
+
+    for (int ch = 0; ch < playback.numChannels; ++ch)
     {
-        return isEnabled;
+        if (unity)
+            RenderKernels::mixDownUnity(scratch[ch], loop.getTail() + ch, 1, static_cast<int>(readPosition), 1.0f, segment);
+        else
+            Resampler::mixDown(playback.quality, scratch[ch], loop.getTail() + ch, 1, loop.getTailLength(),
+                               readPosition, playback.pitchRatio, 1.0f, segment);
     }
+
+    playback.position += playback.pitchRatio * segment;
+    return segment;
 }
 
 //==============================================================================
 SamplerPlugin::SamplerPlugin()
+    : AudioProcessor(createBusesProperties())
 {
-    // Initialize 16 buttons
+    // Initialize every bank's buttons
     buttons.clear();
-    for (int i = 0; i < 16; i++)
+    for (int i = 0; i < numButtons; i++)
     {
         ButtonSample button;
         buttons.add(button);
     }
 
-    // Initialize note mapping (C2 to D3 = notes 36-51 for 16 buttons)
+    // Initialize note mapping (bank A is C2 to D#3 = notes 36-51)
     noteMapping.clear();
-    for (int i = 0; i < 16; i++)
+    for (int i = 0; i < numButtons; i++)
     {
-        noteMapping.add(36 + i); // Start from C2 (MIDI note 36)
+        noteMapping.add(PadLayout::getDefaultNote(i));
     }
 
     // Initialize MIDI note samples array (128 notes)
@@ -59,11 +491,18 @@ SamplerPlugin::SamplerPlugin()
     // Register audio formats - use registerBasicFormats which registers all built-in formats
     formatManager.registerBasicFormats();
 
-    // Add 16 voices to the synth (polyphonic)
-    for (int i = 0; i < 16; i++)
-    {
-        synth.addVoice(new MidiSamplerVoice());
-    }
+    // Build the resampler's coefficient tables before any audio runs
+    Resampler::initialiseTables();
+
+    // Background decoding for kits: slots 0-127 are MIDI notes, then the
+    // buttons, then each note's extra zones
+    loader = std::make_unique<SampleLoader>(numLoaderSlots,
+        [this](const File& file, DecodedSample& decoded) { return decodeSampleFile(file, decoded); },
+        [this] { triggerAsyncUpdate(); });
+
+    // Voices (polyphonic), each with its own disk stream
+    streamer = std::make_unique<SampleStreamer>(formatManager, maxVoices);
+    allocateVoices();
 
     // Initialize default program
     setCurrentProgram(0);
@@ -71,6 +510,14 @@ SamplerPlugin::SamplerPlugin()
 
 SamplerPlugin::~SamplerPlugin()
 {
+    // Loader and conversion jobs use the cache and format manager
+    loader.reset();
+    conversionPool.removeAllJobs(true, 10000);
+    cancelPendingUpdate();
+
+    // Voices stop their streams as they go, so they go first
+    synth.clearVoices();
+
     // Clear all buttons
     for (int i = 0; i < buttons.size(); i++)
     {
@@ -81,8 +528,25 @@ SamplerPlugin::~SamplerPlugin()
 //==============================================================================
 void SamplerPlugin::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    (void)samplesPerBlock;
-    midiCollector.reset(sampleRate);
+    midiInputQueue.reset(sampleRate);
+    performanceMonitor.restart();
+
+    // The whole pool exists before the first block
+    allocateVoices();
+    updateBusLayout();
+    preparedBlockSize.store(samplesPerBlock);
+    configureRenderPool();
+
+    // Room for a dense block of host and live MIDI, so merging never allocates
+    mergedMidi.ensureSize(midiScratchBytes);
+
+    // Voices use this to correct for the files' own sample rates
+    synth.setCurrentPlaybackSampleRate(sampleRate);
+
+    // Re-convert samples in the background if the device rate has changed
+    currentSampleRate.store(sampleRate);
+    if (convertOnLoad.load())
+        triggerAsyncUpdate();
 }
 
 void SamplerPlugin::releaseResources()
@@ -92,32 +556,156 @@ void SamplerPlugin::releaseResources()
 //==============================================================================
 void SamplerPlugin::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 {
-    // Get MIDI from the collector (Bluetooth devices, etc.)
-    MidiBuffer collectorMidi;
-    midiCollector.removeNextBlockOfMessages(collectorMidi, buffer.getNumSamples());
+    // Nothing from here on may touch the heap (see AllocationTrap)
+    const AllocationTrap::ScopedRealtimeSection realtime;
+
+    const int numSamples = buffer.getNumSamples();
+    performanceMonitor.beginBlock(numSamples, getSampleRate());
+
+    // No inputs: voices add their buses straight into a silent buffer
+    buffer.clear();
+
+    // Live MIDI (input devices, pad clicks) is merged with the host's into a
+    // preallocated buffer; with nothing live queued the host's is used as-is
+    MidiBuffer* midi = &midiMessages;
+
+    if (midiInputQueue.hasPendingEvents())
+    {
+        mergedMidi.clear();
+        mergedMidi.addEvents(midiMessages, 0, numSamples, 0);
+        const double triggerLatency = midiInputQueue.removeNextBlockOfMessages(mergedMidi, numSamples);
+        midi = &mergedMidi;
 
-    // Combine incoming MIDI with collector MIDI
-    MidiBuffer allMidi = midiMessages;
-    allMidi.addEvents(collectorMidi, 0, -1, 0);
+        if (triggerLatency >= 0)
+            performanceMonitor.addTriggerLatency(triggerLatency);
+    }
+
+    // Parameters are read once, here; voices use the snapshot
+    engineSettings.fillSnapshot(synth.getEngineSnapshot());
 
-    // Debug: log if there's any MIDI to process
-    int midiCount = allMidi.getNumEvents();
     // Process all MIDI through the synthesizer
-    synth.renderNextBlock(buffer, allMidi, 0, buffer.getNumSamples());
+    synth.beginBlock();
+    synth.renderNextBlock(buffer, *midi, 0, numSamples);
+    synth.endBlock();
+
+    performanceMonitor.endBlock(synth.getNumVoicesRendered());
+}
+
+void SamplerPlugin::setNonRealtime(bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime(isNonRealtime);
+
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+        if (auto* voice = dynamic_cast<MidiSamplerVoice*>(synth.getVoice(i)))
+            voice->setOfflineQuality(isNonRealtime);
+}
+
+//==============================================================================
+AudioProcessor::BusesProperties SamplerPlugin::createBusesProperties()
+{
+    // A main stereo output, then extra stereo outputs that start disabled
+    auto properties = BusesProperties().withOutput("Main", AudioChannelSet::stereo(), true);
+
+    for (int bus = 1; bus < numOutputBuses; ++bus)
+        properties = properties.withOutput("Out " + String(bus + 1), AudioChannelSet::stereo(), false);
+
+    return properties;
+}
+
+bool SamplerPlugin::isBusesLayoutSupported(const BusesLayout& layouts) const
+{
+    const auto main = layouts.getMainOutputChannelSet();
+
+    if (main != AudioChannelSet::mono() && main != AudioChannelSet::stereo())
+        return false;
+
+    for (int bus = 1; bus < layouts.outputBuses.size(); ++bus)
+    {
+        const auto& set = layouts.outputBuses.getReference(bus);
+        if (!set.isDisabled() && set != AudioChannelSet::stereo())
+            return false;
+    }
+
+    return layouts.getMainInputChannelSet().isDisabled();
+}
+
+// Where each bus' channels are in processBlock's buffer for the current layout
+void SamplerPlugin::updateBusLayout()
+{
+    OutputBusLayout layout;
+
+    for (int bus = 0; bus < numOutputBuses; ++bus)
+    {
+        const auto* outputBus = getBus(false, bus);
+        const bool enabled = outputBus != nullptr && outputBus->isEnabled();
+
+        layout.firstChannel[bus] = enabled ? getChannelIndexInProcessBlockBuffer(false, bus, 0) : 0;
+        layout.numChannels[bus] = enabled ? outputBus->getNumberOfChannels() : 0;
+    }
+
+    synth.setBusLayout(layout);
+}
+
+void SamplerPlugin::processorLayoutsChanged()
+{
+    updateBusLayout();
+    configureRenderPool();
+}
+
+//==============================================================================
+void SamplerPlugin::setNumVoices(int newNumVoices)
+{
+    numVoices.store(jlimit(minVoices, maxVoices, newNumVoices));
+    allocateVoices();
+}
+
+// Grows or shrinks the pool to numVoices. Not called from the audio thread;
+// addVoice and removeVoice take the synth's lock, so a block in progress
+// finishes first. Voices removed mid-note are cut off.
+void SamplerPlugin::allocateVoices()
+{
+    const int target = numVoices.load();
+
+    while (synth.getNumVoices() < target)
+    {
+        auto* voice = new MidiSamplerVoice(streamer->getStream(synth.getNumVoices()), &synth.getBusLayout(),
+                                           &synth.getVoiceActivity(), &synth.getEngineSnapshot());
+        voice->setOfflineQuality(isNonRealtime());
+        synth.addVoice(voice);
+    }
+
+    while (synth.getNumVoices() > target)
+        synth.removeVoice(synth.getNumVoices() - 1);
+}
+
+void SamplerPlugin::setRenderThreads(int numThreads)
+{
+    renderThreads.store(jlimit(0, VoiceRenderPool::maxWorkers, numThreads));
+    configureRenderPool();
+}
+
+void SamplerPlugin::configureRenderPool()
+{
+    synth.setRenderThreads(renderThreads.load(), jmax(1, getTotalNumOutputChannels()), preparedBlockSize.load());
 }
 
 //==============================================================================
 AudioProcessorEditor* SamplerPlugin::createEditor()
 {
+   #if SAMPLER_HEADLESS
+    return nullptr;
+   #else
     return new SamplerEditor(*this);
+   #endif
 }
 
 //==============================================================================
 void SamplerPlugin::getStateInformation(MemoryBlock& destData)
 {
     std::unique_ptr<XmlElement> xml(new XmlElement("SamplerState"));
+    xml->setAttribute("bank", currentBank.load());
 
-    for (int i = 0; i < 16; i++)
+    for (int i = 0; i < numButtons; i++)
     {
         XmlElement* buttonXml = xml->createNewChildElement("Button");
         buttonXml->setAttribute("index", i);
@@ -125,6 +713,9 @@ void SamplerPlugin::getStateInformation(MemoryBlock& destData)
         buttonXml->setAttribute("noteMapping", noteMapping[i]);
     }
 
+    if (auto settingsXml = engineSettings.createXml())
+        xml->addChildElement(settingsXml.release());
+
     String xmlString = xml->toString();
     destData.replaceAll(xmlString.toRawUTF8(), xmlString.length() + 1);
 }
@@ -136,26 +727,31 @@ void SamplerPlugin::setStateInformation(const void* data, int sizeInBytes)
 
     if (xml != nullptr && xml->hasTagName("SamplerState"))
     {
-        for (int i = 0; i < 16; i++)
+        setCurrentBank(xml->getIntAttribute("bank", 0));
+
+        // Older states have no parameters and keep the current ones
+        for (auto* settingsXml : xml->getChildIterator())
+            if (EngineSettings::isSettingsXml(*settingsXml))
+                engineSettings.restoreFromXml(*settingsXml);
+
+        // Pads whose file is unchanged keep their audio; only new or edited
+        // files are decoded, in the background like a kit import, and
+        // applyLoadedSamples publishes each one as it finishes
+        for (auto* buttonXml : xml->getChildWithTagNameIterator("Button"))
         {
-            XmlElement* buttonXml = xml->getChildByName("Button");
-            if (buttonXml != nullptr)
-            {
-                int index = buttonXml->getIntAttribute("index");
-                if (index >= 0 && index < 16)
-                {
-                    ButtonSample& sample = buttons.getReference(index);
-                    sample.clear();
-                    sample.filePath = buttonXml->getStringAttribute("filePath");
-                    noteMapping.set(index, buttonXml->getIntAttribute("noteMapping"));
-
-                    if (sample.filePath.isNotEmpty())
-                    {
-                        File file(sample.filePath);
-                        loadSample(index, file);
-                    }
-                }
-            }
+            int index = buttonXml->getIntAttribute("index", -1);
+            if (index < 0 || index >= numButtons)
+                continue;
+
+            const String filePath = buttonXml->getStringAttribute("filePath");
+            setNoteMapping(index, buttonXml->getIntAttribute("noteMapping"));
+
+            if (filePath.isEmpty())
+                clearSample(index);
+            else if (!buttons.getReference(index).isCurrentFor(File(filePath)))
+                loadSampleAsync(index, File(filePath));
+            else
+                loader->cancel(loaderSlotForButton(index));  // An earlier state's load must not replace it
         }
     }
 }
@@ -163,32 +759,20 @@ void SamplerPlugin::setStateInformation(const void* data, int sizeInBytes)
 //==============================================================================
 bool SamplerPlugin::loadSample(int buttonIndex, const File& file)
 {
-    if (buttonIndex < 0 || buttonIndex >= 16)
+    if (buttonIndex < 0 || buttonIndex >= numButtons)
         return false;
 
     ButtonSample& sample = buttons.getReference(buttonIndex);
     clearSample(buttonIndex);
 
-    std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
-
-    if (reader != nullptr)
+    DecodedSample decoded;
+    if (decodeSampleFile(file, decoded))
     {
-        AudioSampleBuffer* buffer = new AudioSampleBuffer(
-            reader->numChannels,
-            static_cast<int>(reader->lengthInSamples)
-        );
-
-        reader->read(buffer, 0, static_cast<int>(reader->lengthInSamples), 0, true, true);
-
-        sample.sampleBuffer = buffer;
-        sample.filePath = file.getFullPathName();
-        sample.sourceSampleRate = static_cast<float>(reader->sampleRate);
-        sample.isLoaded = true;
+        sample.assign(std::move(decoded), file);
         sample.rootNote = noteMapping[buttonIndex];
 
         // Add sound to synth
-        auto* sound = new ButtonSampleSound(buttonIndex, buffer, sample.sourceSampleRate, sample.rootNote);
-        synth.addSound(sound);
+        publishSound(buttonIndex, sample.rootNote, createSound(buttonIndex, sample));
 
         return true;
     }
@@ -198,52 +782,32 @@ bool SamplerPlugin::loadSample(int buttonIndex, const File& file)
 
 void SamplerPlugin::clearSample(int buttonIndex)
 {
-    if (buttonIndex >= 0 && buttonIndex < 16)
+    if (buttonIndex >= 0 && buttonIndex < numButtons)
     {
-        buttons.getReference(buttonIndex).clear();
+        // Drop any load still in flight, then unpublish the sound
+        loader->cancel(loaderSlotForButton(buttonIndex));
+        publishSound(buttonIndex, -1, nullptr);
 
-        // Remove associated sound from synth
-        for (int i = synth.getNumSounds() - 1; i >= 0; --i)
-        {
-            if (auto* sound = dynamic_cast<ButtonSampleSound*>(synth.getSound(i).get()))
-            {
-                if (sound->buttonIndex == buttonIndex)
-                {
-                    synth.removeSound(i);
-                }
-            }
-        }
+        buttons.getReference(buttonIndex).clear();
     }
 }
 
 //==============================================================================
 void SamplerPlugin::setNoteMapping(int buttonIndex, int midiNote)
 {
-    if (buttonIndex < 0 || buttonIndex >= 16)
+    if (buttonIndex < 0 || buttonIndex >= numButtons || noteMapping[buttonIndex] == midiNote)
         return;
 
     noteMapping.set(buttonIndex, midiNote);
+    engineSettings.setPadNote(buttonIndex, midiNote);
 
-    // Remove and re-add the sound so synth re-evaluates appliesToNote
-    for (int i = synth.getNumSounds() - 1; i >= 0; --i)
+    // Publish a copy of the sound that answers the new note
+    if (auto* sound = synth.getButtonSound(buttonIndex))
     {
-        if (auto* sound = dynamic_cast<ButtonSampleSound*>(synth.getSound(i).get()))
-        {
-            if (sound->buttonIndex == buttonIndex)
-            {
-                // Store the sound data before removing
-                AudioSampleBuffer* buffer = sound->sampleBuffer;
-                float sampleRate = sound->sourceSampleRate;
-
-                // Remove old sound
-                synth.removeSound(i);
-
-                // Create new sound with updated rootNote
-                auto* newSound = new ButtonSampleSound(buttonIndex, buffer, sampleRate, midiNote);
-                synth.addSound(newSound);
-                break;
-            }
-        }
+        publishSound(buttonIndex, midiNote,
+                     new ButtonSampleSound(buttonIndex, sound->getZones(), midiNote, sound->quality.load(),
+                                           sound->outputBus.load(), sound->pan.load(), sound->getSelection(),
+                                           sound->getEnvelope()));
     }
 }
 
@@ -257,26 +821,14 @@ bool SamplerPlugin::loadSampleForMidiNote(int midiNote, const File& file)
     ButtonSample& sample = midiNoteSamples.getReference(midiNote);
     clearMidiNoteSample(midiNote);
 
-    std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
-
-    if (reader != nullptr)
+    DecodedSample decoded;
+    if (decodeSampleFile(file, decoded))
     {
-        AudioSampleBuffer* buffer = new AudioSampleBuffer(
-            reader->numChannels,
-            static_cast<int>(reader->lengthInSamples)
-        );
-
-        reader->read(buffer, 0, static_cast<int>(reader->lengthInSamples), 0, true, true);
-
-        sample.sampleBuffer = buffer;
-        sample.filePath = file.getFullPathName();
-        sample.sourceSampleRate = static_cast<float>(reader->sampleRate);
-        sample.isLoaded = true;
+        sample.assign(std::move(decoded), file);
         sample.rootNote = midiNote;
 
         // Add sound to synth with rootNote = midiNote so it responds to that note
-        auto* sound = new ButtonSampleSound(-1, buffer, sample.sourceSampleRate, midiNote);
-        synth.addSound(sound);
+        publishSound(-1, midiNote, createSound(-1, sample));
 
         return true;
     }
@@ -288,21 +840,249 @@ void SamplerPlugin::clearMidiNoteSample(int midiNote)
 {
     if (midiNote >= 0 && midiNote < 128)
     {
+        // Drop any load still in flight, then unpublish the sound
+        loader->cancel(midiNote);
+        for (int zone = 1; zone < maxZones; ++zone)
+            loader->cancel(loaderSlotForZone(midiNote, zone));
+        publishSound(-1, midiNote, nullptr);
+
         midiNoteSamples.getReference(midiNote).clear();
+    }
+}
 
-        // Remove associated sound from synth
-        for (int i = synth.getNumSounds() - 1; i >= 0; --i)
+void SamplerPlugin::setSampleQuality(int midiNote, ResampleQuality quality)
+{
+    if (midiNote < 0 || midiNote >= 128)
+        return;
+
+    midiNoteSamples.getReference(midiNote).quality = quality;
+
+    // Voices pick the new quality up on their next note-on
+    if (auto* sound = synth.getNoteSound(midiNote))
+        sound->quality.store(quality);
+}
+
+ResampleQuality SamplerPlugin::getSampleQuality(int midiNote) const
+{
+    if (midiNote < 0 || midiNote >= midiNoteSamples.size())
+        return ButtonSample::defaultQuality;
+    return midiNoteSamples.getReference(midiNote).quality;
+}
+
+void SamplerPlugin::setSampleOutput(int midiNote, int bus)
+{
+    if (midiNote < 0 || midiNote >= 128)
+        return;
+
+    bus = jlimit(0, numOutputBuses - 1, bus);
+    midiNoteSamples.getReference(midiNote).outputBus = bus;
+
+    if (auto* sound = synth.getNoteSound(midiNote))
+        sound->outputBus.store(bus);
+}
+
+int SamplerPlugin::getSampleOutput(int midiNote) const
+{
+    if (midiNote < 0 || midiNote >= midiNoteSamples.size())
+        return 0;
+    return midiNoteSamples.getReference(midiNote).outputBus;
+}
+
+void SamplerPlugin::setSamplePan(int midiNote, float pan)
+{
+    if (midiNote < 0 || midiNote >= 128)
+        return;
+
+    pan = jlimit(-1.0f, 1.0f, pan);
+    midiNoteSamples.getReference(midiNote).pan = pan;
+
+    if (auto* sound = synth.getNoteSound(midiNote))
+        sound->pan.store(pan);
+}
+
+float SamplerPlugin::getSamplePan(int midiNote) const
+{
+    if (midiNote < 0 || midiNote >= midiNoteSamples.size())
+        return 0.0f;
+    return midiNoteSamples.getReference(midiNote).pan;
+}
+
+void SamplerPlugin::setSampleEnvelope(int midiNote, const EnvelopeSettings& envelope)
+{
+    if (midiNote < 0 || midiNote >= 128)
+        return;
+
+    EnvelopeSettings limited;
+    limited.attack = jlimit(0.0f, maxEnvelopeSeconds, envelope.attack);
+    limited.decay = jlimit(0.0f, maxEnvelopeSeconds, envelope.decay);
+    limited.sustain = jlimit(0.0f, 1.0f, envelope.sustain);
+    limited.release = jlimit(0.0f, maxEnvelopeSeconds, envelope.release);
+    midiNoteSamples.getReference(midiNote).envelope = limited;
+
+    if (auto* sound = synth.getNoteSound(midiNote))
+        sound->setEnvelope(limited);
+}
+
+EnvelopeSettings SamplerPlugin::getSampleEnvelope(int midiNote) const
+{
+    if (midiNote < 0 || midiNote >= midiNoteSamples.size())
+        return {};
+    return midiNoteSamples.getReference(midiNote).envelope;
+}
+
+//==============================================================================
+bool SamplerPlugin::addSampleZone(int midiNote, const File& file, int lowVelocity, int highVelocity)
+{
+    if (midiNote < 0 || midiNote >= 128)
+        return false;
+
+    ButtonSample& sample = midiNoteSamples.getReference(midiNote);
+
+    if (sample.zones.size() >= maxZones - 1)
+        return false;
+
+    ButtonSample::Zone zone;
+    zone.filePath = file.getFullPathName();
+    zone.lowVelocity = jlimit(0, 127, lowVelocity);
+    zone.highVelocity = jlimit(zone.lowVelocity, 127, highVelocity);
+    sample.zones.add(zone);
+
+    // Published with the note's sound once it has loaded
+    loader->queue(loaderSlotForZone(midiNote, sample.zones.size()), file, sample.quality);
+    return true;
+}
+
+int SamplerPlugin::reloadSampleZones(int midiNote, const Array<ZoneFile>& zoneFiles)
+{
+    if (midiNote < 0 || midiNote >= 128)
+        return 0;
+
+    ButtonSample& sample = midiNoteSamples.getReference(midiNote);
+    const int numZones = jmin(zoneFiles.size(), maxZones - 1);
+
+    Array<ButtonSample::Zone> newZones;
+    bool changed = numZones != sample.zones.size();
+    int numQueued = 0;
+
+    for (int i = 0; i < numZones; ++i)
+    {
+        const auto& request = zoneFiles.getReference(i);
+        const int low = jlimit(0, 127, request.lowVelocity);
+        const int high = jlimit(low, 127, request.highVelocity);
+        const int slot = loaderSlotForZone(midiNote, i + 1);
+
+        if (i < sample.zones.size() && sample.zones.getReference(i).isCurrentFor(request.file))
         {
-            if (auto* sound = dynamic_cast<ButtonSampleSound*>(synth.getSound(i).get()))
-            {
-                // For MIDI note samples, buttonIndex is -1 and rootNote is the midiNote
-                if (sound->buttonIndex == -1 && sound->rootNote == midiNote)
-                {
-                    synth.removeSound(i);
-                }
-            }
+            // A load queued by an earlier kit must not replace the kept audio
+            loader->cancel(slot);
+
+            auto kept = sample.zones.getReference(i);
+            changed = changed || kept.lowVelocity != low || kept.highVelocity != high;
+            kept.lowVelocity = low;
+            kept.highVelocity = high;
+            newZones.add(kept);
+            continue;
         }
+
+        ButtonSample::Zone zone;
+        zone.filePath = request.file.getFullPathName();
+        zone.lowVelocity = low;
+        zone.highVelocity = high;
+        newZones.add(zone);
+
+        loader->queue(slot, request.file, sample.quality);
+        changed = true;
+        ++numQueued;
     }
+
+    for (int zone = numZones + 1; zone < maxZones; ++zone)
+        loader->cancel(loaderSlotForZone(midiNote, zone));
+
+    if (!changed)
+        return 0;
+
+    sample.zones.swapWith(newZones);
+
+    if (sample.isLoaded)
+        publishSound(-1, midiNote, createSound(-1, sample));
+
+    return numQueued;
+}
+
+void SamplerPlugin::clearSampleZones(int midiNote)
+{
+    if (midiNote < 0 || midiNote >= 128)
+        return;
+
+    ButtonSample& sample = midiNoteSamples.getReference(midiNote);
+
+    for (int zone = 1; zone < maxZones; ++zone)
+        loader->cancel(loaderSlotForZone(midiNote, zone));
+
+    if (sample.zones.isEmpty())
+        return;
+
+    sample.zones.clear();
+
+    if (sample.isLoaded)
+        publishSound(-1, midiNote, createSound(-1, sample));
+}
+
+int SamplerPlugin::getNumSampleZones(int midiNote) const
+{
+    if (midiNote < 0 || midiNote >= midiNoteSamples.size())
+        return 0;
+    return 1 + midiNoteSamples.getReference(midiNote).zones.size();
+}
+
+void SamplerPlugin::setZoneVelocityRange(int midiNote, int zone, int lowVelocity, int highVelocity)
+{
+    if (midiNote < 0 || midiNote >= 128)
+        return;
+
+    ButtonSample& sample = midiNoteSamples.getReference(midiNote);
+
+    if (zone < 0 || zone > sample.zones.size())
+        return;
+
+    lowVelocity = jlimit(0, 127, lowVelocity);
+    highVelocity = jlimit(lowVelocity, 127, highVelocity);
+
+    int& low = zone == 0 ? sample.lowVelocity : sample.zones.getReference(zone - 1).lowVelocity;
+    int& high = zone == 0 ? sample.highVelocity : sample.zones.getReference(zone - 1).highVelocity;
+
+    if (low == lowVelocity && high == highVelocity)
+        return;
+
+    low = lowVelocity;
+    high = highVelocity;
+
+    // The selection tables are part of the sound, so it is rebuilt
+    if (sample.isLoaded)
+        publishSound(-1, midiNote, createSound(-1, sample));
+}
+
+void SamplerPlugin::setZoneSelection(int midiNote, ZoneSelection selection)
+{
+    if (midiNote < 0 || midiNote >= 128)
+        return;
+
+    ButtonSample& sample = midiNoteSamples.getReference(midiNote);
+
+    if (sample.selection == selection)
+        return;
+
+    sample.selection = selection;
+
+    if (sample.isLoaded)
+        publishSound(-1, midiNote, createSound(-1, sample));
+}
+
+ZoneSelection SamplerPlugin::getZoneSelection(int midiNote) const
+{
+    if (midiNote < 0 || midiNote >= midiNoteSamples.size())
+        return ZoneSelection::roundRobin;
+    return midiNoteSamples.getReference(midiNote).selection;
 }
 
 bool SamplerPlugin::isMidiNoteAssigned(int midiNote) const
@@ -311,3 +1091,593 @@ bool SamplerPlugin::isMidiNoteAssigned(int midiNote) const
         return false;
     return midiNoteSamples[midiNote].isLoaded;
 }
+
+//==============================================================================
+// Decodes a file, on any thread. With convert-on-load enabled the device-rate
+// copy comes from the cache when possible, and only that copy is kept.
+bool SamplerPlugin::decodeSampleFile(const File& file, DecodedSample& decoded)
+{
+    const double targetRate = currentSampleRate.load();
+    const bool convert = convertOnLoad.load() && targetRate > 0;
+
+    if (convert)
+    {
+        if (auto cached = rateCache.find(file, targetRate))
+        {
+            decoded.convertedSample = cached;
+            decoded.sourceSampleRate = cached->sampleRate;
+            return true;
+        }
+    }
+
+    // A file already read with the same settings is shared rather than
+    // decoded again. Converted copies are shared through the rate cache.
+    const String settings = String(useMemoryMapping.load() ? "mapped" : "decoded")
+                          + " " + SampleData::formatToString(sampleFormat.load())
+                          + " " + String(streamingThreshold.load()) + "/" + String(preloadMilliseconds.load())
+                          + " loop " + String(loopCrossfadeSeconds.load());
+    const auto cacheKey = SampleCache::makeKey(file, settings);
+
+    // The file's loop, if it has one, gets its tail here rather than when it plays
+    auto loopPoints = [this](const AudioFormatReader& reader)
+    {
+        return LoopPoints::fromMetadata(reader.metadataValues, static_cast<int>(reader.lengthInSamples),
+                                        roundToInt(loopCrossfadeSeconds.load() * reader.sampleRate));
+    };
+
+    auto withLoop = [](SampleData* sample, const LoopPoints& points, AudioFormatReader* reader = nullptr)
+    {
+        if (points.isValid())
+            sample->setLoop(SampleLoop::create(*sample, points, reader));
+        return sample;
+    };
+
+    auto share = [&](SampleData* sample) -> SampleData::Ptr
+    {
+        return convert ? SampleData::Ptr(sample) : sampleCache->add(cacheKey, sample);
+    };
+
+    if (!convert)
+    {
+        if (auto cached = sampleCache->find(cacheKey))
+        {
+            decoded.sourceSample = cached;
+            decoded.sourceSampleRate = cached->sampleRate;
+            return true;
+        }
+    }
+
+    // Uncompressed PCM: map the file instead of decoding it. Convert-on-load
+    // wants float copies at the device rate, so it decodes as before.
+    if (!convert && useMemoryMapping.load())
+    {
+        if (auto mapped = createMappedReader(file))
+        {
+            decoded.sourceSampleRate = mapped->sampleRate;
+            const auto points = loopPoints(*mapped);
+            decoded.sourceSample = share(withLoop(new SampleData(std::move(mapped)), points));
+            return true;
+        }
+    }
+
+    std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr)
+        return false;
+
+    decoded.sourceSampleRate = reader->sampleRate;
+
+    // Too big for memory: keep the attack and stream the rest. Streamed
+    // samples play at the file's rate even with convert-on-load enabled.
+    const int64 decodedBytes = reader->lengthInSamples * static_cast<int64>(reader->numChannels) * static_cast<int64>(sizeof(float));
+    const int64 threshold = streamingThreshold.load();
+
+    if (threshold > 0 && decodedBytes > threshold)
+    {
+        const int totalLength = static_cast<int>(reader->lengthInSamples);
+        const int preloadLength = jlimit(4 * SampleStreamer::overlapFrames, totalLength,
+                                         static_cast<int>(reader->sampleRate * preloadMilliseconds.load() / 1000.0));
+
+        AudioSampleBuffer preload(static_cast<int>(reader->numChannels), preloadLength);
+        reader->read(&preload, 0, preloadLength, 0, true, true);
+
+        decoded.sourceSample = share(withLoop(new SampleData(std::move(preload), reader->sampleRate, file, totalLength),
+                                              loopPoints(*reader), reader.get()));
+        return true;
+    }
+
+    AudioSampleBuffer buffer(
+        static_cast<int>(reader->numChannels),
+        static_cast<int>(reader->lengthInSamples)
+    );
+
+    reader->read(&buffer, 0, static_cast<int>(reader->lengthInSamples), 0, true, true);
+
+    // Packed formats trade a little precision for memory; converted copies
+    // are shared through the cache and stay float
+    if (convert)
+        decoded.convertedSample = rateCache.add(file, buffer, reader->sampleRate, targetRate, loopPoints(*reader));
+    else if (sampleFormat.load() != SampleFormat::float32)
+        decoded.sourceSample = share(withLoop(new SampleData(buffer, reader->sampleRate, sampleFormat.load()), loopPoints(*reader)));
+    else
+        decoded.sourceSample = share(withLoop(new SampleData(std::move(buffer), reader->sampleRate), loopPoints(*reader)));
+
+    return true;
+}
+
+// Maps a WAV/AIFF file for direct playback, or returns nullptr if the format
+// can't be mapped or the file is big enough that it should be streamed
+std::unique_ptr<MemoryMappedAudioFormatReader> SamplerPlugin::createMappedReader(const File& file) const
+{
+    auto* format = formatManager.findFormatForFileExtension(file.getFileExtension());
+
+    if (format == nullptr)
+        return nullptr;
+
+    std::unique_ptr<MemoryMappedAudioFormatReader> reader(format->createMemoryMappedReader(file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+        return nullptr;
+
+    const int64 decodedBytes = reader->lengthInSamples * static_cast<int64>(reader->numChannels) * static_cast<int64>(sizeof(float));
+    const int64 threshold = streamingThreshold.load();
+
+    if ((threshold > 0 && decodedBytes > threshold) || !reader->mapEntireFile())
+        return nullptr;
+
+    // Page the attack in now so the first hit doesn't wait on the disk
+    const int64 attackLength = jmin(reader->lengthInSamples,
+                                    static_cast<int64>(reader->sampleRate * preloadMilliseconds.load() / 1000.0));
+    for (int64 i = 0; i < attackLength; i += 1024)
+        reader->touchSample(i);
+
+    return reader;
+}
+
+ButtonSampleSound* SamplerPlugin::createSound(int buttonIndex, const ButtonSample& sample) const
+{
+    // Zones still loading join the sound once they arrive
+    Array<SampleZone> zones;
+    zones.add({ sample.getPlaybackSample(), sample.lowVelocity, sample.highVelocity });
+
+    for (auto& zone : sample.zones)
+        if (auto zoneSample = zone.getPlaybackSample())
+            zones.add({ zoneSample, zone.lowVelocity, zone.highVelocity });
+
+    return new ButtonSampleSound(buttonIndex, zones, sample.rootNote, sample.quality,
+                                 sample.outputBus, sample.pan, sample.selection, sample.envelope);
+}
+
+// Atomically swaps the sound for a button (buttonIndex >= 0) or a MIDI note
+// sample (buttonIndex == -1). Voices still playing the old sound keep it alive.
+void SamplerPlugin::publishSound(int buttonIndex, int midiNote, ButtonSampleSound* newSound)
+{
+    if (buttonIndex >= 0)
+        synth.setButtonSound(buttonIndex, newSound);
+    else
+        synth.setNoteSound(midiNote, newSound);
+}
+
+//==============================================================================
+void SamplerPlugin::loadSampleAsync(int buttonIndex, const File& file)
+{
+    if (buttonIndex < 0 || buttonIndex >= numButtons)
+        return;
+
+    loader->queue(loaderSlotForButton(buttonIndex), file, buttons.getReference(buttonIndex).quality);
+}
+
+void SamplerPlugin::loadSampleForMidiNoteAsync(int midiNote, const File& file, ResampleQuality quality)
+{
+    if (midiNote < 0 || midiNote >= 128)
+        return;
+
+    loader->queue(midiNote, file, quality);
+}
+
+bool SamplerPlugin::reloadSampleForMidiNote(int midiNote, const File& file, ResampleQuality quality)
+{
+    if (midiNote < 0 || midiNote >= 128)
+        return false;
+
+    if (midiNoteSamples.getReference(midiNote).isCurrentFor(file))
+    {
+        // A load queued by an earlier kit must not replace the kept audio
+        loader->cancel(midiNote);
+        setSampleQuality(midiNote, quality);
+        return false;
+    }
+
+    loadSampleForMidiNoteAsync(midiNote, file, quality);
+    return true;
+}
+
+// Message thread: commit finished loads and publish their sounds
+void SamplerPlugin::applyLoadedSamples()
+{
+    SampleLoader::Result result;
+    bool anyFinished = false;
+
+    while (loader->popResult(result))
+    {
+        anyFinished = true;
+
+        // Extra zones become part of their note's sound
+        const int zoneSlots = result.slot - loaderSlotForZone(0, 1);
+
+        if (zoneSlots >= 0)
+        {
+            const int midiNote = zoneSlots / (maxZones - 1);
+            const int zone = zoneSlots % (maxZones - 1);
+            ButtonSample& sample = midiNoteSamples.getReference(midiNote);
+
+            if (result.succeeded && zone < sample.zones.size())
+            {
+                auto& target = sample.zones.getReference(zone);
+                target.sourceSample = std::move(result.decoded.sourceSample);
+                target.convertedSample = std::move(result.decoded.convertedSample);
+                target.fileModificationTime = result.file.getLastModificationTime().toMilliseconds();
+                target.fileSize = result.file.getSize();
+
+                if (sample.isLoaded)
+                    publishSound(-1, midiNote, createSound(-1, sample));
+            }
+            else if (!result.succeeded)
+            {
+                DEBUG_MIDI("Failed to load zone " + result.file.getFullPathName());
+            }
+            continue;
+        }
+
+        const bool isButton = result.slot >= SamplerSynth::numNotes;
+        const int buttonIndex = isButton ? result.slot - SamplerSynth::numNotes : -1;
+        const int midiNote = isButton ? noteMapping[buttonIndex] : result.slot;
+
+        if (result.succeeded)
+        {
+            ButtonSample& sample = isButton ? buttons.getReference(buttonIndex)
+                                            : midiNoteSamples.getReference(midiNote);
+
+            sample.assign(std::move(result.decoded), result.file);
+            sample.rootNote = midiNote;
+            sample.quality = result.quality;
+
+            // One swap replaces the old sound; its audio goes to the reclaimer
+            publishSound(buttonIndex, midiNote, createSound(buttonIndex, sample));
+
+            DEBUG_MIDI("Loaded " + result.file.getFileName() + " for note " + String(midiNote));
+        }
+        else
+        {
+            DEBUG_MIDI("Failed to load " + result.file.getFullPathName());
+        }
+
+        if (onSampleLoaded != nullptr)
+            onSampleLoaded(buttonIndex, midiNote, result.succeeded);
+    }
+
+    // Samples the new ones replaced may now be idle
+    if (anyFinished)
+        sampleCache->trim();
+
+    if (anyFinished && onLoadProgress != nullptr)
+        onLoadProgress(loader->getNumFinished(), loader->getNumQueued());
+}
+
+//==============================================================================
+void SamplerPlugin::setConvertOnLoad(bool shouldConvert)
+{
+    convertOnLoad.store(shouldConvert);
+
+    // Convert anything already loaded at its native rate
+    if (shouldConvert)
+    {
+        requestedConversionRate = 0.0;
+        rebuildConvertedSamples();
+    }
+}
+
+void SamplerPlugin::handleAsyncUpdate()
+{
+    // Publish whatever the loader and conversion threads have finished, then
+    // start a new conversion pass if the device rate has moved on since
+    applyLoadedSamples();
+    applyConvertedSamples();
+    rebuildConvertedSamples();
+}
+
+// Message thread: queue a background conversion of every loaded file
+void SamplerPlugin::rebuildConvertedSamples()
+{
+    const double targetRate = currentSampleRate.load();
+
+    if (!convertOnLoad.load() || targetRate <= 0 || targetRate == requestedConversionRate)
+        return;
+
+    requestedConversionRate = targetRate;
+
+    // Streamed samples are never converted, that would decode them in full
+    StringArray paths;
+    for (auto& sample : buttons)
+        if (sample.isLoaded && !sample.isStreamed())
+            paths.addIfNotAlreadyThere(sample.filePath);
+    for (auto& sample : midiNoteSamples)
+    {
+        if (sample.isLoaded && !sample.isStreamed())
+            paths.addIfNotAlreadyThere(sample.filePath);
+
+        for (auto& zone : sample.zones)
+            if (zone.getPlaybackSample() != nullptr && !zone.getPlaybackSample()->isStreamed())
+                paths.addIfNotAlreadyThere(zone.filePath);
+    }
+
+    if (paths.isEmpty())
+        return;
+
+    DEBUG_MIDI("Converting " + String(paths.size()) + " samples to " + String(targetRate) + " Hz");
+
+    conversionPool.addJob([this, paths, targetRate]
+    {
+        for (auto& path : paths)
+            rateCache.findOrCreate(formatManager, File(path), targetRate, loopCrossfadeSeconds.load());
+
+        finishedConversionRate.store(targetRate);
+        triggerAsyncUpdate();
+    });
+}
+
+// Message thread: swap converted buffers into the synth's sounds
+void SamplerPlugin::applyConvertedSamples()
+{
+    const double rate = finishedConversionRate.exchange(0.0);
+
+    // Results for a rate the device has already left are discarded
+    if (rate <= 0 || rate != currentSampleRate.load())
+        return;
+
+    for (int i = 0; i < buttons.size(); ++i)
+    {
+        ButtonSample& sample = buttons.getReference(i);
+        if (!sample.isLoaded || sample.isStreamed())
+            continue;
+
+        auto converted = rateCache.find(File(sample.filePath), rate);
+        if (converted != nullptr && converted != sample.convertedSample)
+        {
+            sample.convertedSample = converted;
+            sample.rootNote = noteMapping[i];
+            publishSound(i, sample.rootNote, createSound(i, sample));
+        }
+    }
+
+    for (int note = 0; note < midiNoteSamples.size(); ++note)
+    {
+        ButtonSample& sample = midiNoteSamples.getReference(note);
+        if (!sample.isLoaded || sample.isStreamed())
+            continue;
+
+        bool changed = false;
+
+        auto converted = rateCache.find(File(sample.filePath), rate);
+        if (converted != nullptr && converted != sample.convertedSample)
+        {
+            sample.convertedSample = converted;
+            changed = true;
+        }
+
+        for (auto& zone : sample.zones)
+        {
+            if (zone.getPlaybackSample() == nullptr || zone.getPlaybackSample()->isStreamed())
+                continue;
+
+            auto convertedZone = rateCache.find(File(zone.filePath), rate);
+            if (convertedZone != nullptr && convertedZone != zone.convertedSample)
+            {
+                zone.convertedSample = convertedZone;
+                changed = true;
+            }
+        }
+
+        if (changed)
+            publishSound(-1, note, createSound(-1, sample));
+    }
+
+    rateCache.removeUnused();
+    DEBUG_MIDI("Converted samples now playing at " + String(rate) + " Hz");
+}
+
+//==============================================================================
+bool SamplerPlugin::saveBundle(const File& file, bool compress)
+{
+    SampleBundle::Kit kit;
+    kit.sampleRate = currentSampleRate.load();
+    kit.defaultMode = engineSettings.getDefaultMode();
+
+    for (int i = 0; i < SampleBundle::numPads; ++i)
+    {
+        kit.noteMapping[i] = noteMapping[i];
+        kit.padHasMode[i] = engineSettings.hasPadMode(i);
+        kit.padModes[i] = engineSettings.getPadMode(i);
+    }
+
+    // Notes with a sample, and empty notes whose settings aren't the defaults
+    for (int note = 0; note < midiNoteSamples.size(); ++note)
+    {
+        const ButtonSample& sample = midiNoteSamples.getReference(note);
+        const int chokeGroup = synth.getChokeGroup(note);
+
+        if (!sample.isLoaded && chokeGroup == 0 && sample.outputBus == 0 && sample.pan == 0.0f && sample.envelope.isDefault())
+            continue;
+
+        SampleBundle::Entry entry;
+        entry.midiNote = note;
+        entry.outputBus = sample.outputBus;
+        entry.pan = sample.pan;
+        entry.chokeGroup = chokeGroup;
+        entry.envelope = sample.envelope;
+
+        if (sample.isLoaded)
+        {
+            entry.filePath = sample.filePath;
+            entry.quality = sample.quality;
+            entry.lowVelocity = sample.lowVelocity;
+            entry.highVelocity = sample.highVelocity;
+            entry.selection = static_cast<int>(sample.selection);
+            entry.sample = getBundleAudio(sample.getPlaybackSample(), kit.sampleRate);
+
+            if (entry.sample == nullptr)
+            {
+                DEBUG_MIDI("Bundle: could not read " + sample.filePath);
+                return false;
+            }
+        }
+
+        kit.entries.add(entry);
+
+        if (!sample.isLoaded)
+            continue;
+
+        // Zones that have loaded follow their note's main sample
+        int zoneIndex = 0;
+
+        for (auto& zone : sample.zones)
+        {
+            if (zone.getPlaybackSample() == nullptr)
+                continue;
+
+            SampleBundle::Entry zoneEntry(entry);
+            zoneEntry.zone = ++zoneIndex;
+            zoneEntry.filePath = zone.filePath;
+            zoneEntry.lowVelocity = zone.lowVelocity;
+            zoneEntry.highVelocity = zone.highVelocity;
+            zoneEntry.sample = getBundleAudio(zone.getPlaybackSample(), kit.sampleRate);
+
+            if (zoneEntry.sample == nullptr)
+            {
+                DEBUG_MIDI("Bundle: could not read " + zone.filePath);
+                return false;
+            }
+
+            kit.entries.add(zoneEntry);
+        }
+    }
+
+    return SampleBundle::write(file, kit, sampleFormat.load(), compress);
+}
+
+// All of a sample's audio at targetRate (its own rate when that is 0).
+// Streamed samples are decoded from their file in full.
+SampleData::Ptr SamplerPlugin::getBundleAudio(SampleData::Ptr playback, double targetRate)
+{
+    if (targetRate <= 0)
+        targetRate = playback->sampleRate;
+
+    if (!playback->isStreamed() && playback->sampleRate == targetRate)
+        return playback;
+
+    AudioSampleBuffer audio;
+    double rate = playback->sampleRate;
+
+    if (playback->isStreamed())
+    {
+        std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(playback->sourceFile));
+
+        if (reader == nullptr)
+            return nullptr;
+
+        audio.setSize(static_cast<int>(reader->numChannels), static_cast<int>(reader->lengthInSamples));
+        reader->read(&audio, 0, audio.getNumSamples(), 0, true, true);
+        rate = reader->sampleRate;
+    }
+    else
+    {
+        audio.setSize(playback->getNumChannels(), playback->getTotalLength());
+        playback->readFrames(0, audio.getNumSamples(), audio.getArrayOfWritePointers(), audio.getNumChannels());
+    }
+
+    if (rate != targetRate)
+        audio = SampleRateCache::convert(audio, rate, targetRate);
+
+    SampleData::Ptr result = new SampleData(std::move(audio), targetRate);
+
+    if (auto* loop = playback->getLoop())
+        result->setLoop(SampleLoop::create(*result, loop->points.scaled(targetRate / rate)));
+
+    return result;
+}
+
+bool SamplerPlugin::loadBundle(const File& file)
+{
+    SampleBundle::Kit kit;
+
+    if (!SampleBundle::read(file, kit))
+        return false;
+
+    engineSettings.setDefaultMode(kit.defaultMode);
+
+    for (int i = 0; i < SampleBundle::numPads; ++i)
+    {
+        if (kit.padHasMode[i])
+            engineSettings.setPadMode(i, kit.padModes[i]);
+        else
+            engineSettings.clearPadMode(i);
+    }
+
+    for (int note = 0; note < midiNoteSamples.size(); ++note)
+    {
+        clearMidiNoteSample(note);
+        synth.setChokeGroup(note, 0);
+    }
+
+    for (int i = 0; i < SampleBundle::numPads; ++i)
+        setNoteMapping(i, kit.noteMapping[i]);
+
+    // Audio saved at another rate is resampled by the voices as it plays;
+    // convert-on-load only comes back in when the device rate next changes
+    for (auto& entry : kit.entries)
+    {
+        ButtonSample& sample = midiNoteSamples.getReference(entry.midiNote);
+
+        if (entry.zone > 0)
+        {
+            if (entry.sample != nullptr && sample.zones.size() < maxZones - 1)
+            {
+                ButtonSample::Zone zone;
+                zone.sourceSample = entry.sample;
+                zone.filePath = entry.filePath;
+                zone.lowVelocity = entry.lowVelocity;
+                zone.highVelocity = entry.highVelocity;
+                sample.zones.add(zone);
+            }
+            continue;
+        }
+
+        if (entry.sample != nullptr)
+        {
+            DecodedSample decoded;
+            decoded.sourceSample = entry.sample;
+            decoded.sourceSampleRate = entry.sample->sampleRate;
+
+            sample.assign(std::move(decoded), entry.filePath);
+            sample.rootNote = entry.midiNote;
+            sample.quality = entry.quality;
+            sample.lowVelocity = entry.lowVelocity;
+            sample.highVelocity = entry.highVelocity;
+            sample.selection = entry.selection == static_cast<int>(ZoneSelection::random) ? ZoneSelection::random
+                                                                                       : ZoneSelection::roundRobin;
+        }
+
+        setChokeGroup(entry.midiNote, entry.chokeGroup);
+        setSampleOutput(entry.midiNote, entry.outputBus);
+        setSamplePan(entry.midiNote, entry.pan);
+        setSampleEnvelope(entry.midiNote, entry.envelope);
+    }
+
+    // One sound per note, with all of its zones
+    for (int note = 0; note < midiNoteSamples.size(); ++note)
+        if (midiNoteSamples.getReference(note).isLoaded)
+            publishSound(-1, note, createSound(-1, midiNoteSamples.getReference(note)));
+
+    DEBUG_MIDI("Loaded bundle " + file.getFileName() + " (" + String(kit.entries.size()) + " notes)");
+    return true;
+}
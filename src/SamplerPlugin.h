@@ -13,51 +13,197 @@
 #pragma once
 
 #include "juce.h"
+#include "SamplerLog.h"
+#include "SampleResampler.h"
+#include "SampleRateCache.h"
+#include "SampleCache.h"
+#include "SampleLoader.h"
+#include "SamplerSynth.h"
+#include "SampleStreamer.h"
+#include "MidiInputQueue.h"
+#include "MidiUiQueue.h"
+#include "SampleRenderKernels.h"
+#include "VoiceEnvelope.h"
+#include "PerformanceMonitor.h"
+#include "EngineSettings.h"
+#include "AllocationTrap.h"
+
+#include <atomic>
+
+// Set by targets that build the engine without its editor (SamplerBenchmark)
+#ifndef SAMPLER_HEADLESS
+ #define SAMPLER_HEADLESS 0
+#endif
 
 //==============================================================================
-// Forward declarations for one-shot mode access
-namespace OneShotMode
+// How a note picks between zones that share a velocity range
+enum class ZoneSelection : int
 {
-    extern bool isEnabled;
-    extern void setEnabled(bool enable);
-    extern bool getEnabled();
-}
+    roundRobin = 0,     // In turn
+    random              // At random, never the same one twice running
+};
+
+// One sample of a sound and the velocities it answers. Zones with the same
+// range are alternates within one velocity layer.
+struct SampleZone
+{
+    SampleData::Ptr sample;
+    int lowVelocity = 0;
+    int highVelocity = 127;
+};
 
 //==============================================================================
 class ButtonSample
 {
 public:
-    ButtonSample() : sampleBuffer(nullptr), sourceSampleRate(0), isLoaded(false), rootNote(60) {}
+    ButtonSample() : sourceSampleRate(0), isLoaded(false), rootNote(60), quality(defaultQuality), outputBus(0), pan(0.0f) {}
 
-    AudioSampleBuffer* sampleBuffer;
+    static constexpr ResampleQuality defaultQuality = ResampleQuality::hermite;
+    static constexpr int maxZones = 8;  // Including the main sample
+    static constexpr int64 notFromFile = -1;
+
+    // A velocity layer or round-robin alternate beside the main sample,
+    // loaded from its own file
+    struct Zone
+    {
+        SampleData::Ptr sourceSample;
+        SampleData::Ptr convertedSample;
+        String filePath;
+        int64 fileModificationTime = 0;     // Like the main sample's, set once it has loaded
+        int64 fileSize = notFromFile;
+        int lowVelocity = 0;
+        int highVelocity = 127;
+
+        bool isCurrentFor(const File& file) const
+        {
+            return getPlaybackSample() != nullptr && filePath == file.getFullPathName()
+                && fileModificationTime == file.getLastModificationTime().toMilliseconds()
+                && fileSize == file.getSize();
+        }
+
+        // Null until its file has loaded
+        SampleData::Ptr getPlaybackSample() const
+        {
+            return convertedSample != nullptr ? convertedSample : sourceSample;
+        }
+    };
+
+    SampleData::Ptr sourceSample;       // Decoded at the file's own rate, may be null when converted
+    SampleData::Ptr convertedSample;    // Copy at the device rate when convert-on-load is enabled
     String filePath;
     float sourceSampleRate;
     bool isLoaded;
     int rootNote;
+    ResampleQuality quality;
+    int outputBus;   // 0 is the main output
+    float pan;       // -1 (left) to 1 (right)
+    int64 fileModificationTime = 0;  // Of filePath when it was loaded, to spot edits
+    int64 fileSize = 0;              // notFromFile if the audio wasn't decoded from filePath
+    int lowVelocity = 0;             // Velocities the main sample answers
+    int highVelocity = 127;
+    Array<Zone> zones;               // Extra zones, up to maxZones - 1
+    ZoneSelection selection = ZoneSelection::roundRobin;
+    EnvelopeSettings envelope;
+
+    // The audio voices should play
+    SampleData::Ptr getPlaybackSample() const
+    {
+        return convertedSample != nullptr ? convertedSample : sourceSample;
+    }
+
+    // Streamed samples only hold their attack in memory
+    bool isStreamed() const { return sourceSample != nullptr && sourceSample->isStreamed(); }
 
+    // True if this holds file's audio and the file hasn't changed on disk
+    // since. Modification time and size stand in for a content hash, which
+    // would mean reading the whole file.
+    bool isCurrentFor(const File& file) const
+    {
+        return isLoaded && filePath == file.getFullPathName()
+            && fileModificationTime == file.getLastModificationTime().toMilliseconds()
+            && fileSize == file.getSize();
+    }
+
+    // Takes over audio decoded by SamplerPlugin::decodeSampleFile. Routing
+    // and the other zones belong to the pad, so they survive loading a new
+    // main file.
+    void assign(DecodedSample&& decoded, const File& file)
+    {
+        assign(std::move(decoded), file.getFullPathName());
+        fileModificationTime = file.getLastModificationTime().toMilliseconds();
+        fileSize = file.getSize();
+    }
+
+    // Audio that only remembers where it came from (a bundle's, already
+    // resampled and packed): it never counts as current for that file, so
+    // importing the file itself decodes it again
+    void assign(DecodedSample&& decoded, const String& path)
+    {
+        const int keptBus = outputBus;
+        const float keptPan = pan;
+        const int keptLow = lowVelocity;
+        const int keptHigh = highVelocity;
+        const ZoneSelection keptSelection = selection;
+        const EnvelopeSettings keptEnvelope = envelope;
+        Array<Zone> keptZones;
+        keptZones.swapWith(zones);
+
+        clear();
+        outputBus = keptBus;
+        pan = keptPan;
+        lowVelocity = keptLow;
+        highVelocity = keptHigh;
+        selection = keptSelection;
+        envelope = keptEnvelope;
+        zones.swapWith(keptZones);
+        sourceSample = std::move(decoded.sourceSample);
+        convertedSample = std::move(decoded.convertedSample);
+        filePath = path;
+        fileModificationTime = 0;
+        fileSize = notFromFile;
+        sourceSampleRate = static_cast<float>(decoded.sourceSampleRate);
+        isLoaded = true;
+    }
+
+    // Only drops this pad's references; sounds and voices still using the
+    // audio keep it alive until the reclaimer frees it
     void clear()
     {
-        if (sampleBuffer != nullptr)
-        {
-            delete sampleBuffer;
-            sampleBuffer = nullptr;
-        }
+        sourceSample = nullptr;
+        convertedSample = nullptr;
         filePath = "";
+        fileModificationTime = 0;
+        fileSize = 0;
         sourceSampleRate = 0;
         isLoaded = false;
         rootNote = 60;
+        quality = defaultQuality;
+        outputBus = 0;
+        pan = 0.0f;
+        lowVelocity = 0;
+        highVelocity = 127;
+        zones.clear();
+        selection = ZoneSelection::roundRobin;
+        envelope = {};
     }
 };
 
 //==============================================================================
-// SynthesiserSound for each button sample
+// SynthesiserSound for each button sample.
+//
+// A sound holds one or more zones. Its constructor sorts them into velocity
+// layers and precomputes a 128-entry table from velocity to layer, plus a
+// pick sequence for each layer: in order for round robin, shuffled for
+// random. Choosing a sample at note-on is then a table lookup and one
+// atomic counter step, whatever the zone layout.
 class ButtonSampleSound : public SynthesiserSound
 {
 public:
-    ButtonSampleSound(int buttonIndex, AudioSampleBuffer* buffer, float sampleRate, int rootNote)
-        : buttonIndex(buttonIndex), sampleBuffer(buffer), sourceSampleRate(sampleRate), rootNote(rootNote)
-    {
-    }
+    ButtonSampleSound(int buttonIndex, const Array<SampleZone>& zones, int rootNote,
+                      ResampleQuality quality = ButtonSample::defaultQuality,
+                      int outputBus = 0, float pan = 0.0f,
+                      ZoneSelection selection = ZoneSelection::roundRobin,
+                      const EnvelopeSettings& envelope = {});
 
     bool appliesToNote(int midiNote) override { return midiNote == rootNote; }
     bool appliesToChannel(int midiChannel) override { (void)midiChannel; return true; }
@@ -65,20 +211,86 @@ public:
     void setRootNote(int newRootNote) { rootNote = newRootNote; }
     int getRootNote() const { return rootNote; }
 
-    int buttonIndex;
-    AudioSampleBuffer* sampleBuffer;
-    float sourceSampleRate;
+    // Audio thread, at note-on: the sample to play at this velocity (0-1)
+    SampleData* selectSample(float velocity) noexcept
+    {
+        auto& layer = layers[velocityToLayer[jlimit(0, 127, roundToInt(velocity * 127.0f))]];
+        const uint32 step = layer.counter.fetch_add(1, std::memory_order_relaxed);
+        return zones.getReference(layer.firstZone + layer.sequence[step % layer.sequenceLength]).sample.get();
+    }
+
+    const Array<SampleZone>& getZones() const noexcept { return zones; }
+    ZoneSelection getSelection() const noexcept { return selection; }
+
+    EnvelopeSettings getEnvelope() const noexcept
+    {
+        return { attack.load(), decay.load(), sustain.load(), release.load() };
+    }
+
+    void setEnvelope(const EnvelopeSettings& envelope) noexcept
+    {
+        attack.store(envelope.attack);
+        decay.store(envelope.decay);
+        sustain.store(envelope.sustain);
+        release.store(envelope.release);
+    }
+
+    static String selectionToString(ZoneSelection selection);
+    static ZoneSelection selectionFromString(const String& name, ZoneSelection defaultSelection);
+
+    const int buttonIndex;
     int rootNote;
+    std::atomic<ResampleQuality> quality;  // Read by voices at note-on
+    std::atomic<int> outputBus;            // Likewise
+    std::atomic<float> pan;
+    std::atomic<float> attack, decay, sustain, release;  // Read at note-on, like quality
+
+private:
+    static constexpr int maxSequenceLength = 64;
+
+    // Zones with the same velocity range, consecutive in zones
+    struct Layer
+    {
+        int firstZone = 0;
+        uint32 sequenceLength = 1;  // A whole number of passes over the zones
+        uint8 sequence[maxSequenceLength] = {};
+        std::atomic<uint32> counter { 0 };
+    };
+
+    Array<SampleZone> zones;    // Immutable; samples shared with the pad and any voice playing them
+    const ZoneSelection selection;
+    Layer layers[ButtonSample::maxZones];
+    uint8 velocityToLayer[128] = {};
 };
 
 //==============================================================================
 class MidiSamplerVoice : public SynthesiserVoice
 {
 public:
-    MidiSamplerVoice()
+    // Stolen and choked notes fade out over this long instead of cutting off,
+    // whatever the release time of their envelope
+    static constexpr double fadeOutSeconds = 0.005;
+
+    // stream plays the part of streamed samples past their preload; buses
+    // says where each output bus is (nullptr: everything to the first two
+    // channels); activity, if given, hears about notes starting and ending;
+    // settings gives each note's playback mode (nullptr: gate)
+    explicit MidiSamplerVoice(SampleStreamer::Stream* stream = nullptr,
+                              const OutputBusLayout* buses = nullptr,
+                              VoiceActivity* activity = nullptr,
+                              const EngineSnapshot* settings = nullptr)
+        : stream(stream), buses(buses), activity(activity), settings(settings)
     {
     }
 
+    ~MidiSamplerVoice() override
+    {
+        if (current.streamId != 0)
+            stream->stop();
+
+        reportSounding(-1);
+    }
+
     bool canPlaySound(SynthesiserSound* sound) override
     {
         (void)sound;
@@ -89,64 +301,110 @@ public:
     {
         (void)currentPitchWheelPosition;
 
-        // Debug log
-        File logFile = File::getSpecialLocation(File::currentExecutableFile).getParentDirectory().getChildFile("debug.log");
-        logFile.appendText(Time::getCurrentTime().toString(true, true, true, true) +
-            ": MidiSamplerVoice::startNote note=" + String(midiNoteNumber) +
-            " velocity=" + String(int(velocity * 127)) + "\n");
+        // Debug log (binary record, formatted on the log writer thread)
+        SamplerLog::event(SamplerLog::Level::debug, SamplerLog::Event::voiceStart, midiNoteNumber, int(velocity * 127));
 
         this->midiNoteNumber = midiNoteNumber;
         this->velocity = velocity;
         this->isPlaying = true;
-        this->position = 0;
+        outputLevel = velocity;
+        mode = settings != nullptr ? settings->getMode(midiNoteNumber) : PlaybackMode::gate;
+        current.position = 0;
+        current.looping = mode == PlaybackMode::loop;
+        current.inLoopTail = false;
+        envelope.start({}, getSampleRate());
+
+        // A stolen voice may still be streaming its previous note
+        if (current.streamId != 0)
+        {
+            stream->stop();
+            current.streamId = 0;
+        }
 
-        // Set up from sound
+        // Set up from sound. The voice's reference is never the last one:
+        // the sound (kept alive by this voice) holds the sample too
         if (auto* buttonSound = dynamic_cast<ButtonSampleSound*>(sound))
         {
-            sampleBuffer = buttonSound->sampleBuffer;
-            sourceSampleRate = buttonSound->sourceSampleRate;
+            current.sample = buttonSound->selectSample(velocity);
+            sourceSampleRate = current.sample != nullptr ? current.sample->sampleRate : 0.0;
             rootNote = buttonSound->rootNote;
+            current.quality = offlineQuality.load() ? ResampleQuality::sinc : buttonSound->quality.load();
 
-            // Calculate pitch ratio for pitch shifting
+            // Routing, with velocity folded into the pan gains
+            current.outputBus = buttonSound->outputBus.load();
+            current.numChannels = current.sample != nullptr ? jmin(2, current.sample->getNumChannels()) : 1;
+            RenderKernels::panGains(buttonSound->pan.load(), current.numChannels > 1, current.leftGain, current.rightGain);
+            current.leftGain *= velocity;
+            current.rightGain *= velocity;
+
+            envelope.start(buttonSound->getEnvelope(), getSampleRate());
+
+            // Large files: start reading past the preload right away
+            if (current.sample != nullptr && current.sample->isStreamed() && stream != nullptr)
+                current.streamId = stream->start(current.sample.get(),
+                                                 jmax(0, current.sample->getNumSamples() - SampleStreamer::overlapFrames));
+
+            // Calculate pitch ratio for pitch shifting, correcting for the
+            // difference between the file's rate and the device rate
             if (sourceSampleRate > 0)
             {
-                pitchRatio = pow(2.0, (midiNoteNumber - rootNote) / 12.0);
+                current.pitchRatio = pow(2.0, (midiNoteNumber - rootNote) / 12.0);
+
+                if (getSampleRate() > 0)
+                    current.pitchRatio *= sourceSampleRate / getSampleRate();
             }
             else
             {
-                pitchRatio = 1.0f;
+                current.pitchRatio = 1.0;
             }
         }
         else
         {
-            sampleBuffer = nullptr;
-            pitchRatio = 1.0f;
+            current.sample = nullptr;
+            current.pitchRatio = 1.0;
         }
+
+        reportSounding(current.sample != nullptr ? midiNoteNumber : -1);
     }
 
     void stopNote(float velocity, bool allowTailOff) override
     {
         (void)velocity;
 
-        // In one-shot mode, ignore note-off and let sample play to completion
-        if (OneShotMode::getEnabled())
+        // One-shots play to completion and toggles until they are hit
+        // again, so neither listens to note-off
+        if (mode == PlaybackMode::oneShot || mode == PlaybackMode::toggle)
         {
-            return;  // Don't stop - let sample play to completion
+            return;
         }
 
-        // Debug log
-        File logFile = File::getSpecialLocation(File::currentExecutableFile).getParentDirectory().getChildFile("debug.log");
-        logFile.appendText(Time::getCurrentTime().toString(true, true, true, true) +
-            ": MidiSamplerVoice::stopNote note=" + String(midiNoteNumber) +
-            " isPlaying=" + String(isPlaying ? "true" : "false") + "\n");
-
-        isPlaying = false;
+        // Without tail-off, take the fast release stolen voices use
         if (!allowTailOff)
         {
-            clearCurrentNote();
+            fadeOutNote();
+            return;
         }
+
+        releaseNote();
+    }
+
+    // Audio thread: lets the note play on through its envelope's release,
+    // whatever its mode
+    void releaseNote()
+    {
+        // Debug log (binary record, formatted on the log writer thread)
+        SamplerLog::event(SamplerLog::Level::debug, SamplerLog::Event::voiceStop, midiNoteNumber, isPlaying ? 1 : 0);
+
+        isPlaying = false;
+        envelope.release();
     }
 
+    // Audio thread, under the synth's lock: ends the current note (even in
+    // one-shot mode, or while it is releasing) and lets it fade out over
+    // fadeOutSeconds from its envelope's level while the voice is reused.
+    // Used for voice stealing and choke groups.
+    void fadeOutNote();
+
     void pitchWheelMoved(int newPitchWheelValue) override
     {
         (void)newPitchWheelValue;
@@ -158,67 +416,172 @@ public:
         (void)newControllerValue;
     }
 
-    void renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override
+    // Renders in constant-ratio segments with the kernels in SampleRenderKernels
+    // and SampleResampler
+    void renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override;
+
+    bool isPlayingNote() const { return isPlaying; }
+    int getMidiNote() const { return midiNoteNumber; }
+
+    // False once the voice is idle and has no fade to finish
+    bool needsRendering() const noexcept { return isVoiceActive() || fadeSamplesLeft > 0; }
+
+    // How loud the current note is, for choosing a voice to steal: the peak
+    // of its last block, as heard, so a hard hit that has decayed ranks
+    // below a fresh soft one. A note counts at its velocity until it has
+    // been through its attack. Released notes count as silent, so they go
+    // first.
+    float getCurrentLevel() const noexcept { return isPlaying ? outputLevel : 0.0f; }
+
+    // Offline renders always use the best interpolation
+    void setOfflineQuality(bool shouldUseOfflineQuality) { offlineQuality.store(shouldUseOfflineQuality); }
+
+private:
+    static constexpr int decodeWindowFrames = 4096;
+
+    // Read state of one note; the voice has one for the note it is playing
+    // and one for a note fading out underneath it
+    struct Playback
     {
-        if (sampleBuffer == nullptr || !isPlaying)
-            return;
+        SampleData::Ptr sample;
+        double position = 0.0;
+        double pitchRatio = 1.0;
+        ResampleQuality quality = ButtonSample::defaultQuality;
+        uint32 streamId = 0;  // Stream request, 0 if not streaming
+        int numChannels = 1;  // Rendered channels: 2 for stereo sources
+        int outputBus = 0;
+        float leftGain = 0.0f;
+        float rightGain = 0.0f;
+        bool looping = false;     // Loop mode
+        bool inLoopTail = false;  // Reading the loop's tail rather than the sample
+        bool fromFadeWindow = false;  // Past a streamed preload, reads fadeWindow instead of the stream
+    };
+
+    // Renders the next segment of up to maxSamples into scratch (one channel
+    // per source channel, at unity gain) and advances position. Returns the
+    // segment length, 0 once the sample has ended. Past a streamed sample's
+    // preload, a playback without a stream request reads silence, unless it
+    // reads from the fade window.
+    int mixSegment(Playback& playback, float* const* scratch, int maxSamples);
+
+    // Like mixSegment, for a looping playback of a sample with a SampleLoop:
+    // reads the sample up to the crossfade, then the loop's tail, and jumps
+    // back by the loop length between segments. Never runs out.
+    int mixLoopSegment(Playback& playback, float* const* scratch, int maxSamples);
+
+    int nextSegment(Playback& playback, float* const* scratch, int maxSamples)
+    {
+        return playback.looping && playback.sample->getLoop() != nullptr ? mixLoopSegment(playback, scratch, maxSamples)
+                                                                         : mixSegment(playback, scratch, maxSamples);
+    }
+
+    // Adds a rendered segment straight into the playback's bus
+    void addToOutput(AudioBuffer<float>& outputBuffer, const Playback& playback, int startSample,
+                     const float* const* scratch, int numSamples) const noexcept;
 
-        for (int i = 0; i < numSamples; ++i)
+    void renderFadeOut(AudioBuffer<float>& outputBuffer, int startSample, int numSamples, float* const* scratch);
+
+    // Loop mode, for samples without loop points: back to the start once
+    // the sample has played through. False if there is nothing to loop.
+    bool restartLoop();
+
+    // Drops the sample before the sound, so the sound still owns it
+    void endNote()
+    {
+        if (current.streamId != 0)
         {
-            int outputIndex = startSample + i;
+            stream->stop();
+            current.streamId = 0;
+        }
 
-            // Read from sample
-            float sample = 0.0f;
-            for (int ch = 0; ch < sampleBuffer->getNumChannels(); ++ch)
-            {
-                float* channelData = sampleBuffer->getWritePointer(ch);
-                int samplePos = static_cast<int>(position) % sampleBuffer->getNumSamples();
-                sample += channelData[samplePos];
-            }
-            sample /= sampleBuffer->getNumChannels();
+        current.sample = nullptr;
+        clearCurrentNote();
+        reportSounding(-1);
+    }
 
-            // Apply pitch ratio
-            position += pitchRatio;
+    // Tells the activity block which note this voice is sounding (-1: none)
+    void reportSounding(int note) noexcept
+    {
+        if (activity == nullptr || note == soundingNote)
+            return;
 
-            // Check if sample ended
-            if (position >= sampleBuffer->getNumSamples())
-            {
-                isPlaying = false;
-                clearCurrentNote();
-                break;
-            }
+        if (soundingNote >= 0)
+            activity->noteEnded(soundingNote, this);
+        if (note >= 0)
+            activity->noteStarted(note, velocity, this);
 
-            // Write to output
-            for (int ch = 0; ch < outputBuffer.getNumChannels(); ++ch)
-            {
-                outputBuffer.getWritePointer(ch)[outputIndex] += sample * velocity;
-            }
-        }
+        soundingNote = note;
     }
 
-    bool isPlayingNote() const { return isPlaying; }
-    int getMidiNote() const { return midiNoteNumber; }
+    // Once per block: where the current note is and how loud it was
+    void reportPlayed(float peak) noexcept
+    {
+        if (activity == nullptr || soundingNote < 0 || current.sample == nullptr)
+            return;
 
-    void setSample(ButtonSampleSound* sound)
+        const int length = current.sample->getTotalLength();
+        const float playhead = length > 0 ? jlimit(0.0f, 1.0f, static_cast<float>(current.position / length)) : 0.0f;
+        activity->notePlayed(soundingNote, this, playhead, peak);
+    }
+
+    void releaseFade()
     {
-        sampleBuffer = sound->sampleBuffer;
-        sourceSampleRate = sound->sourceSampleRate;
-        rootNote = sound->rootNote;
+        fadeSamplesLeft = 0;
+        fade.sample = nullptr;
+        fadeSound = nullptr;
+        fadeWindowFrames = 0;
     }
 
-private:
-    bool isPlaying = false;
+    // The stream stays with the voice for its next note, so a fade past a
+    // streamed note's preload keeps what it will read in fadeWindow. Frames
+    // [fadeWindowStart, fadeWindowStart + return value) from start onwards.
+    int getFadeWindow(int start, const float** channels) const noexcept
+    {
+        const int offset = start - fadeWindowStart;
+
+        if (offset < 0 || offset >= fadeWindowFrames)
+            return 0;
+
+        for (int ch = 0; ch < SampleStreamer::maxChannels; ++ch)
+            channels[ch] = fadeWindow.getReadPointer(ch) + offset;
+
+        return fadeWindowFrames - offset;
+    }
+
+    void captureFadeWindow();
+
+    bool isPlaying = false;  // Key (or one-shot) held; false once releasing
     float velocity = 0.0f;
-    double position = 0.0;
-    float pitchRatio = 1.0f;
+    float outputLevel = 0.0f;  // For getCurrentLevel
+    VoiceEnvelope envelope;
     int midiNoteNumber = 60;
     int rootNote = 60;
-    AudioSampleBuffer* sampleBuffer = nullptr;
-    float sourceSampleRate = 44100.0;
+    Playback current;
+    AudioSampleBuffer decodeWindow { SampleStreamer::maxChannels, decodeWindowFrames };  // Mapped and packed samples, converted per segment
+    SampleStreamer::Stream* stream = nullptr;
+    const OutputBusLayout* buses = nullptr;
+    VoiceActivity* activity = nullptr;
+    const EngineSnapshot* settings = nullptr;
+    PlaybackMode mode = PlaybackMode::gate;  // Of the current note, from settings at note-on
+    int soundingNote = -1;  // As last reported to activity
+    double sourceSampleRate = 44100.0;
+    std::atomic<bool> offlineQuality { false };
+
+    // A stolen or choked note. Holding its sound means the reclaimer, not
+    // this voice, frees it.
+    Playback fade;
+    SynthesiserSound::Ptr fadeSound;
+    int fadeSamplesLeft = 0;
+    int fadeLength = 1;
+    float fadeLevel = 1.0f;  // Envelope level the fade started from
+    AudioSampleBuffer fadeWindow { SampleStreamer::maxChannels, decodeWindowFrames };
+    int fadeWindowStart = 0;
+    int fadeWindowFrames = 0;
 };
 
 //==============================================================================
-class SamplerPlugin : public AudioProcessor
+class SamplerPlugin : public AudioProcessor,
+                      private AsyncUpdater
 {
 public:
     SamplerPlugin();
@@ -228,9 +591,12 @@ public:
     void releaseResources() override;
 
     void processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
+    bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
+    void processorLayoutsChanged() override;
+    void setNonRealtime(bool isNonRealtime) noexcept override;
 
     AudioProcessorEditor* createEditor() override;
-    bool hasEditor() const override { return true; }
+    bool hasEditor() const override { return !SAMPLER_HEADLESS; }
 
     const String getName() const override { return "16-Button MIDI Sampler"; }
 
@@ -250,9 +616,17 @@ public:
     Array<ButtonSample>& getButtons() { return buttons; }
     ButtonSample& getButton(int index) { return buttons.getReference(index); }
 
+    // Pads (PadLayout): buttonIndex runs over every bank
+    static constexpr int numButtons = PadLayout::numPads;
+
     void setNoteMapping(int buttonIndex, int midiNote);
     int getNoteMapping(int buttonIndex) const { return noteMapping[buttonIndex]; }
 
+    // The bank the editor shows, saved with the state. Pads in every bank
+    // keep playing from MIDI whichever is shown.
+    void setCurrentBank(int bank) { currentBank.store(jlimit(0, PadLayout::numBanks - 1, bank)); }
+    int getCurrentBank() const { return currentBank.load(); }
+
     bool loadSample(int buttonIndex, const File& file);
     void clearSample(int buttonIndex);
 
@@ -265,19 +639,231 @@ public:
         return midiNote >= 0 && midiNote < midiNoteSamples.size() && midiNoteSamples[midiNote].isLoaded;
     }
 
+    // Interpolation quality used when the sample on a MIDI note is pitched
+    void setSampleQuality(int midiNote, ResampleQuality quality);
+    ResampleQuality getSampleQuality(int midiNote) const;
+
+    // Output routing per MIDI note sample. Bus 0 is the main output; buses
+    // 1-7 are extra stereo outputs ("Out 2" to "Out 8"), disabled until the
+    // host or audio device enables them - until then their voices play
+    // through the main output. Pan runs from -1 (left) to 1 (right).
+    static constexpr int numOutputBuses = OutputBusLayout::maxBuses;
+
+    void setSampleOutput(int midiNote, int bus);
+    int getSampleOutput(int midiNote) const;
+    void setSamplePan(int midiNote, float pan);
+    float getSamplePan(int midiNote) const;
+
+    // Amplitude envelope per MIDI note sample, in seconds (sustain 0-1).
+    // The default holds full level until note-off and then stops within
+    // VoiceEnvelope::minReleaseSeconds. In one-shot mode notes ignore
+    // note-off, so only attack and decay apply.
+    static constexpr float maxEnvelopeSeconds = 30.0f;
+
+    void setSampleEnvelope(int midiNote, const EnvelopeSettings& envelope);
+    EnvelopeSettings getSampleEnvelope(int midiNote) const;
+
+    // Velocity layers and round-robin alternates on a MIDI note sample.
+    // Zone 0 is the note's main sample; up to maxZones - 1 more are loaded
+    // in the background from their own files. Every velocity plays the zone
+    // whose range covers it (the nearest one if none does), and zones with
+    // the same range take turns or are picked at random.
+    static constexpr int maxZones = ButtonSample::maxZones;
+
+    bool addSampleZone(int midiNote, const File& file, int lowVelocity, int highVelocity);
+    void clearSampleZones(int midiNote);  // Keeps the main sample
+
+    // Replaces the note's extra zones, as a kit import does. A zone whose
+    // file is the one already in that place and unchanged on disk keeps its
+    // audio; only the others are queued, and the sound is only republished
+    // if something changed. Returns how many were queued.
+    struct ZoneFile
+    {
+        File file;
+        int lowVelocity = 0;
+        int highVelocity = 127;
+    };
+
+    int reloadSampleZones(int midiNote, const Array<ZoneFile>& zoneFiles);
+    int getNumSampleZones(int midiNote) const;  // Including the main sample
+    void setZoneVelocityRange(int midiNote, int zone, int lowVelocity, int highVelocity);
+    void setZoneSelection(int midiNote, ZoneSelection selection);
+    ZoneSelection getZoneSelection(int midiNote) const;
+
+    // Convert-on-load: resample each file once to the device rate so unity
+    // pitch playback is a straight copy. Samples are re-converted in the
+    // background whenever the device rate changes.
+    void setConvertOnLoad(bool shouldConvert);
+    bool getConvertOnLoad() const { return convertOnLoad.load(); }
+
+    // Disk streaming: files that would decode to more than the threshold keep
+    // only their first preload milliseconds in memory and stream the rest
+    // from disk. A threshold of 0 turns streaming off. Both settings apply
+    // to samples loaded afterwards.
+    static constexpr int64 defaultStreamingThreshold = 64 * 1024 * 1024;
+    static constexpr int defaultPreloadMilliseconds = 500;
+
+    void setStreamingThreshold(int64 bytes) { streamingThreshold.store(jmax((int64) 0, bytes)); }
+    int64 getStreamingThreshold() const { return streamingThreshold.load(); }
+    void setPreloadMilliseconds(int milliseconds) { preloadMilliseconds.store(jmax(10, milliseconds)); }
+    int getPreloadMilliseconds() const { return preloadMilliseconds.load(); }
+    int getNumStreamUnderruns() const { return streamer->getNumUnderruns(); }
+
+    // Memory mapping: uncompressed WAV/AIFF files below the streaming
+    // threshold are mapped rather than decoded, and converted to float by
+    // the voices as they play. Not used while convert-on-load is enabled.
+    void setUseMemoryMapping(bool shouldMap) { useMemoryMapping.store(shouldMap); }
+    bool getUseMemoryMapping() const { return useMemoryMapping.load(); }
+
+    // Storage format for samples decoded into memory. Compact formats are
+    // widened to float by the voices as they play. Applies to samples loaded
+    // afterwards.
+    void setSampleFormat(SampleFormat format) { sampleFormat.store(format); }
+    SampleFormat getSampleFormat() const { return sampleFormat.load(); }
+
+    // Loop playback: a sample whose file has a loop (a WAV smpl chunk)
+    // repeats that region in loop mode, crossfading its end into its start
+    // over this long; others loop the whole sample with no crossfade. The
+    // crossfade is mixed at load time, so it applies to samples loaded
+    // afterwards.
+    static constexpr double defaultLoopCrossfadeSeconds = 0.01;
+
+    void setLoopCrossfade(double seconds) { loopCrossfadeSeconds.store(jlimit(0.0, 1.0, seconds)); }
+    double getLoopCrossfade() const { return loopCrossfadeSeconds.load(); }
+
+    // Decoded files are shared through a process-wide cache, so a file on
+    // several notes is decoded and held once. Samples no pad uses any more
+    // stay cached, for instant reassignment, until the memory budget is
+    // reached.
+    void setSampleCacheBudget(int64 bytes) { sampleCache->setBudget(bytes); }
+    int64 getSampleCacheBudget() const { return sampleCache->getBudget(); }
+
+    // Voice pool: voices are allocated up front, when the size changes and
+    // in prepareToPlay, never at note-on. Each has its own disk stream.
+    static constexpr int minVoices = 16;
+    static constexpr int maxVoices = SamplerSynth::maxVoices;
+    static constexpr int defaultVoices = 32;
+
+    void setNumVoices(int numVoices);
+    int getNumVoices() const { return numVoices.load(); }
+
+    // Playback modes and the rest of this instance's parameters, exposed to
+    // the host. Voices see changes from the next block on.
+    EngineSettings& getEngineSettings() { return engineSettings; }
+
+    // Which voice is taken over once all of them are busy
+    void setVoiceStealing(VoiceStealing policy) { synth.setVoiceStealing(policy); }
+    VoiceStealing getVoiceStealing() const { return synth.getVoiceStealing(); }
+
+    // Parallel rendering: when enough voices are playing they are spread
+    // over this many helper threads as well as the audio thread. 0 (the
+    // default) renders everything on the audio thread.
+    void setRenderThreads(int numThreads);
+    int getRenderThreads() const { return renderThreads.load(); }
+
+    // Choke groups by MIDI note (buttons play their mapped note): a note-on
+    // fades out the other notes in its group. Group 0 chokes nothing.
+    void setChokeGroup(int midiNote, int group) { synth.setChokeGroup(midiNote, group); }
+    int getChokeGroup(int midiNote) const { return synth.getChokeGroup(midiNote); }
+
+    // Background loading: files are decoded on the loader's thread pool and
+    // each finished sound is swapped into the synth on the message thread.
+    // Results are reported through onSampleLoaded (buttonIndex is -1 for
+    // MIDI note samples) and onLoadProgress.
+    void loadSampleAsync(int buttonIndex, const File& file);
+    void loadSampleForMidiNoteAsync(int midiNote, const File& file,
+                                    ResampleQuality quality = ButtonSample::defaultQuality);
+    bool isLoadingSamples() const { return loader->isBusy(); }
+
+    // Kit reload: like loadSampleForMidiNoteAsync, except that a note already
+    // holding this exact file, unchanged on disk, keeps its audio and only
+    // takes the new quality. Returns true if a load was queued.
+    bool reloadSampleForMidiNote(int midiNote, const File& file,
+                                 ResampleQuality quality = ButtonSample::defaultQuality);
+
+    // Kit bundles (SampleBundle): every MIDI note sample, its settings and
+    // the pad mapping in one file, with the audio saved at the device rate
+    // in the current sample format. Loading maps the file and replaces every
+    // MIDI note sample straight away, without decoding anything.
+    bool saveBundle(const File& file, bool compress);
+    bool loadBundle(const File& file);
+
+    std::function<void(int buttonIndex, int midiNote, bool succeeded)> onSampleLoaded;
+    std::function<void(int numFinished, int numQueued)> onLoadProgress;
+
     // Check if any sample is assigned to a MIDI note (for UI display)
     bool isMidiNoteAssigned(int midiNote) const;
 
     Synthesiser& getSynth() { return synth; }
-    MidiMessageCollector& getMidiCollector() { return midiCollector; }
+
+    // Which notes have voices sounding, for pad lights
+    VoiceActivity& getVoiceActivity() { return synth.getVoiceActivity(); }
+    // Live MIDI from input devices and the editor's pads
+    MidiInputQueue& getMidiInputQueue() { return midiInputQueue; }
+    // Live input for the editor to display, drained on its timer
+    MidiUiQueue& getMidiUiQueue() { return midiUiQueue; }
+    // Audio-thread load, xruns, voice count and live MIDI trigger latency
+    PerformanceMonitor& getPerformanceMonitor() { return performanceMonitor; }
 
 private:
-    Synthesiser synth;
+    SamplerSynth synth;
+    EngineSettings engineSettings { *this };
     Array<ButtonSample> buttons;
     Array<int> noteMapping;
+    std::atomic<int> currentBank { 0 };
     Array<ButtonSample> midiNoteSamples;  // Samples indexed by MIDI note (0-127)
     AudioFormatManager formatManager;
-    MidiMessageCollector midiCollector;
+    MidiInputQueue midiInputQueue;
+    MidiUiQueue midiUiQueue;
+    PerformanceMonitor performanceMonitor;
+    MidiBuffer mergedMidi;  // Host + live MIDI for one block, sized in prepareToPlay
+    static constexpr int midiScratchBytes = 16384;  // About 1500 short messages
+
+    SharedResourcePointer<SampleCache> sampleCache;
+
+    // Convert-on-load state
+    SampleRateCache rateCache;
+    ThreadPool conversionPool { 1 };
+    std::atomic<bool> convertOnLoad { false };
+    std::atomic<double> currentSampleRate { 0.0 };
+    std::atomic<double> finishedConversionRate { 0.0 };
+    double requestedConversionRate = 0.0;  // Message thread only
+
+    // Disk streaming state (one stream for each voice the pool can hold)
+    std::unique_ptr<SampleStreamer> streamer;
+    std::atomic<int> numVoices { defaultVoices };
+    std::atomic<int> renderThreads { 0 };
+    std::atomic<int> preparedBlockSize { 512 };
+    std::atomic<int64> streamingThreshold { defaultStreamingThreshold };
+    std::atomic<int> preloadMilliseconds { defaultPreloadMilliseconds };
+    std::atomic<bool> useMemoryMapping { true };
+    std::atomic<SampleFormat> sampleFormat { SampleFormat::float32 };
+    std::atomic<double> loopCrossfadeSeconds { defaultLoopCrossfadeSeconds };
+
+    // Background loader (declared last so it stops before anything it uses)
+    std::unique_ptr<SampleLoader> loader;
+
+    static int loaderSlotForButton(int buttonIndex) { return SamplerSynth::numNotes + buttonIndex; }
+    static int loaderSlotForZone(int midiNote, int zone)
+    {
+        return SamplerSynth::numNotes + SamplerSynth::numButtons + midiNote * (maxZones - 1) + zone - 1;
+    }
+    static constexpr int numLoaderSlots = SamplerSynth::numNotes + SamplerSynth::numButtons
+                                        + SamplerSynth::numNotes * (maxZones - 1);
+
+    static BusesProperties createBusesProperties();
+    void updateBusLayout();
+    void allocateVoices();
+    void configureRenderPool();
+    bool decodeSampleFile(const File& file, DecodedSample& decoded);
+    std::unique_ptr<MemoryMappedAudioFormatReader> createMappedReader(const File& file) const;
+    SampleData::Ptr getBundleAudio(SampleData::Ptr playback, double targetRate);
+    ButtonSampleSound* createSound(int buttonIndex, const ButtonSample& sample) const;
+    void publishSound(int buttonIndex, int midiNote, ButtonSampleSound* newSound);
+    void applyLoadedSamples();
+    void rebuildConvertedSamples();
+    void applyConvertedSamples();
+    void handleAsyncUpdate() override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplerPlugin)
 };
@@ -0,0 +1,301 @@
+/*
+  ==============================================================================
+
+    SamplerSynth.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Synthesiser with lock-free sound publication
+
+  ==============================================================================
+*/
+
+#include "SamplerSynth.h"
+#include "SamplerPlugin.h"
+
+//==============================================================================
+SamplerSynth::SamplerSynth()
+{
+    for (auto& slot : noteSounds)
+        slot.store(nullptr);
+    for (auto& slot : buttonSounds)
+        slot.store(nullptr);
+    for (auto& group : chokeGroups)
+        group.store(0);
+
+    rebuildNoteTable();
+}
+
+SamplerSynth::~SamplerSynth()
+{
+    // Voices report to voiceActivity as they go, so they go first
+    clearVoices();
+
+    delete noteTable.exchange(nullptr);
+
+    // Drop the slots' references
+    for (auto& slot : noteSounds)
+        if (auto* sound = slot.exchange(nullptr))
+            sound->decReferenceCount();
+    for (auto& slot : buttonSounds)
+        if (auto* sound = slot.exchange(nullptr))
+            sound->decReferenceCount();
+}
+
+//==============================================================================
+void SamplerSynth::setNoteSound(int midiNote, ButtonSampleSound* sound)
+{
+    jassert(isPositiveAndBelow(midiNote, numNotes));
+
+    // Each published sound holds one reference on behalf of its slot
+    if (sound != nullptr)
+        sound->incReferenceCount();
+
+    // The old sound is retired only once no new lookup can find it
+    auto* previous = noteSounds[midiNote].exchange(sound);
+    rebuildNoteTable();
+    retire(previous);
+}
+
+void SamplerSynth::setButtonSound(int buttonIndex, ButtonSampleSound* sound)
+{
+    jassert(isPositiveAndBelow(buttonIndex, numButtons));
+
+    if (sound != nullptr)
+        sound->incReferenceCount();
+
+    auto* previous = buttonSounds[buttonIndex].exchange(sound);
+    rebuildNoteTable();
+    retire(previous);
+}
+
+ButtonSampleSound* SamplerSynth::getNoteSound(int midiNote) const noexcept
+{
+    return isPositiveAndBelow(midiNote, numNotes) ? noteSounds[midiNote].load() : nullptr;
+}
+
+ButtonSampleSound* SamplerSynth::getButtonSound(int buttonIndex) const noexcept
+{
+    return isPositiveAndBelow(buttonIndex, numButtons) ? buttonSounds[buttonIndex].load() : nullptr;
+}
+
+//==============================================================================
+void SamplerSynth::noteOn(int midiChannel, int midiNoteNumber, float velocity)
+{
+    if (!isPositiveAndBelow(midiNoteNumber, numNotes))
+        return;
+
+    // Constant-time lookup of every layer on this note
+    const auto& entry = noteTable.load(std::memory_order_acquire)->notes[midiNoteNumber];
+
+    if (entry.numLayers == 0)
+        return;
+
+    const int chokeGroup = chokeGroups[midiNoteNumber].load(std::memory_order_relaxed);
+
+    const ScopedLock sl(lock);
+
+    // A toggle note that is still held is released by the next hit
+    if (engineSnapshot.getMode(midiNoteNumber) == PlaybackMode::toggle)
+    {
+        bool released = false;
+
+        for (auto* voice : voices)
+        {
+            auto* samplerVoice = static_cast<MidiSamplerVoice*>(voice);
+
+            if (samplerVoice->getCurrentlyPlayingNote() == midiNoteNumber && samplerVoice->isPlayingNote()
+                && voice->isPlayingChannel(midiChannel))
+            {
+                samplerVoice->releaseNote();
+                released = true;
+            }
+        }
+
+        if (released)
+            return;
+    }
+
+    // Every voice belongs to this synth and is a MidiSamplerVoice
+    for (auto* voice : voices)
+    {
+        const int note = voice->getCurrentlyPlayingNote();
+
+        // If hitting a note that's still ringing, stop it first
+        if (note == midiNoteNumber && voice->isPlayingChannel(midiChannel))
+            stopVoice(voice, 1.0f, true);
+        else if (chokeGroup > 0 && note >= 0 && note != midiNoteNumber
+                 && chokeGroups[note].load(std::memory_order_relaxed) == chokeGroup)
+            static_cast<MidiSamplerVoice*>(voice)->fadeOutNote();
+    }
+
+    for (int i = 0; i < entry.numLayers; ++i)
+    {
+        auto* voice = findFreeVoice(entry.layers[i], midiChannel, midiNoteNumber, isNoteStealingEnabled());
+
+        // A stolen voice fades its old note out while it starts the new one
+        if (voice != nullptr && voice->isVoiceActive())
+            static_cast<MidiSamplerVoice*>(voice)->fadeOutNote();
+
+        startVoice(voice, entry.layers[i], midiChannel, midiNoteNumber, velocity);
+    }
+}
+
+SynthesiserVoice* SamplerSynth::findVoiceToSteal(SynthesiserSound* soundToPlay, int midiChannel,
+                                                 int midiNoteNumber) const
+{
+    (void)soundToPlay;
+    (void)midiChannel;
+
+    const auto policy = voiceStealing.load(std::memory_order_relaxed);
+
+    // Voices that have already been released go first whatever the policy
+    auto rank = [policy, midiNoteNumber](const MidiSamplerVoice& voice)
+    {
+        if (!voice.isPlayingNote())
+            return 0;
+        return policy == VoiceStealing::sameNoteFirst && voice.getCurrentlyPlayingNote() == midiNoteNumber ? 1 : 2;
+    };
+
+    const MidiSamplerVoice* best = nullptr;
+
+    for (auto* v : voices)
+    {
+        const auto& voice = *static_cast<const MidiSamplerVoice*>(v);
+
+        if (best == nullptr)
+        {
+            best = &voice;
+            continue;
+        }
+
+        const int voiceRank = rank(voice);
+        const int bestRank = rank(*best);
+
+        if (voiceRank != bestRank)
+        {
+            if (voiceRank < bestRank)
+                best = &voice;
+            continue;
+        }
+
+        if (policy == VoiceStealing::quietest && voice.getCurrentLevel() != best->getCurrentLevel())
+        {
+            if (voice.getCurrentLevel() < best->getCurrentLevel())
+                best = &voice;
+            continue;
+        }
+
+        if (voice.wasStartedBefore(*best))
+            best = &voice;
+    }
+
+    return const_cast<MidiSamplerVoice*>(best);
+}
+
+//==============================================================================
+void SamplerSynth::renderVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    // Idle voices are skipped, so the pool only splits real work
+    int numToRender = 0;
+
+    for (auto* voice : voices)
+        if (static_cast<MidiSamplerVoice*>(voice)->needsRendering() && numToRender < maxVoices)
+            renderList[numToRender++] = voice;
+
+    numVoicesRendered = jmax(numVoicesRendered, numToRender);
+    renderPool->render(renderList, numToRender, outputAudio, startSample, numSamples);
+}
+
+void SamplerSynth::setBusLayout(const OutputBusLayout& newLayout)
+{
+    const ScopedLock sl(lock);
+    busLayout = newLayout;
+}
+
+void SamplerSynth::setRenderThreads(int numThreads, int numChannels, int maxBlockSize)
+{
+    const ScopedLock changing(renderPoolChangeLock);
+
+    if (renderPool->isConfiguredFor(numThreads, numChannels, maxBlockSize))
+        return;
+
+    // Starting the new helpers and stopping the old ones both happen outside
+    // the synth's lock, so the audio thread only ever waits for the swap.
+    // renderNextBlock holds the lock, so the old pool is idle once swapped out.
+    auto newPool = std::make_unique<VoiceRenderPool>();
+    newPool->configure(numThreads, numChannels, maxBlockSize);
+
+    {
+        const ScopedLock sl(lock);
+        std::swap(renderPool, newPool);
+    }
+}
+
+String SamplerSynth::voiceStealingToString(VoiceStealing policy)
+{
+    switch (policy)
+    {
+        case VoiceStealing::quietest:      return "Quietest";
+        case VoiceStealing::sameNoteFirst: return "Same Note First";
+        case VoiceStealing::oldest:        break;
+    }
+    return "Oldest";
+}
+
+//==============================================================================
+void SamplerSynth::setChokeGroup(int midiNote, int group) noexcept
+{
+    if (isPositiveAndBelow(midiNote, numNotes))
+        chokeGroups[midiNote].store(jlimit(0, maxChokeGroups, group));
+}
+
+int SamplerSynth::getChokeGroup(int midiNote) const noexcept
+{
+    return isPositiveAndBelow(midiNote, numNotes) ? chokeGroups[midiNote].load() : 0;
+}
+
+//==============================================================================
+void SamplerSynth::rebuildNoteTable()
+{
+    auto* table = new NoteTable();
+
+    // Button layers first, then the note's own sample, as they trigger
+    for (auto& slot : buttonSounds)
+    {
+        if (auto* sound = slot.load())
+        {
+            if (isPositiveAndBelow(sound->rootNote, numNotes))
+            {
+                // Leaves room for the note's own sample
+                auto& entry = table->notes[sound->rootNote];
+                if (entry.numLayers < NoteTable::maxLayers - 1)
+                    entry.layers[entry.numLayers++] = sound;
+            }
+        }
+    }
+
+    for (int note = 0; note < numNotes; ++note)
+    {
+        if (auto* sound = noteSounds[note].load())
+        {
+            auto& entry = table->notes[note];
+            entry.layers[entry.numLayers++] = sound;
+        }
+    }
+
+    // The audio thread may still be reading the old table
+    if (auto* previous = noteTable.exchange(table, std::memory_order_acq_rel))
+        reclaimer.retire(previous);
+}
+
+//==============================================================================
+void SamplerSynth::retire(ButtonSampleSound* sound)
+{
+    if (sound == nullptr)
+        return;
+
+    // The reclaimer's reference replaces the slot's
+    reclaimer.retire(sound);
+    sound->decReferenceCount();
+}
@@ -0,0 +1,243 @@
+/*
+  ==============================================================================
+
+    SamplerSynth.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Synthesiser with lock-free sound publication
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+#include "SampleReclaimer.h"
+#include "VoiceRenderPool.h"
+#include "EngineSettings.h"
+#include "PadLayout.h"
+
+#include <atomic>
+
+class ButtonSampleSound;
+
+// Where each output bus sits in the processBlock buffer. A bus with no
+// channels is disabled and its voices fall back to the main bus.
+struct OutputBusLayout
+{
+    static constexpr int maxBuses = 8;
+
+    int firstChannel[maxBuses] = { 0 };
+    int numChannels[maxBuses] = { 2 };
+};
+
+// Which voice a note-on takes over when every voice is busy
+enum class VoiceStealing : int
+{
+    oldest = 0,     // The note started longest ago
+    quietest,       // The note playing quietest right now, oldest first on a tie
+    sameNoteFirst   // A voice already playing this note, otherwise the oldest
+};
+
+// What each note's voices are doing, for the pads in the editor.
+//
+// Voices report their note starting and ending, and once per block where
+// their playhead is and how loud they were, from whichever thread renders
+// them. Each note has its own cache line of relaxed atomics; the newest
+// voice on a note owns its playhead, and peaks from all of them are merged.
+// The editor reads this at frame rate without calling into the synth or
+// taking its lock, and repaints only the pads whose state changed.
+class VoiceActivity
+{
+public:
+    static constexpr int numNotes = 128;
+
+    // Voices, on any render thread
+    void noteStarted(int note, float velocity, const void* voice) noexcept
+    {
+        auto& state = notes[note];
+        state.velocity.store(velocity, std::memory_order_relaxed);
+        state.playhead.store(0.0f, std::memory_order_relaxed);
+        state.owner.store(voice, std::memory_order_relaxed);
+        state.count.fetch_add(1, std::memory_order_relaxed);
+        numSounding.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void noteEnded(int note, const void* voice) noexcept
+    {
+        auto& state = notes[note];
+        const void* owner = voice;
+        state.owner.compare_exchange_strong(owner, nullptr, std::memory_order_relaxed);
+        state.count.fetch_sub(1, std::memory_order_relaxed);
+        numSounding.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Voices, once per block: playhead as a fraction of the sample, and the
+    // block's peak level
+    void notePlayed(int note, const void* voice, float playhead, float peak) noexcept
+    {
+        auto& state = notes[note];
+
+        if (state.owner.load(std::memory_order_relaxed) == voice)
+            state.playhead.store(playhead, std::memory_order_relaxed);
+
+        float current = state.peak.load(std::memory_order_relaxed);
+        while (peak > current && !state.peak.compare_exchange_weak(current, peak, std::memory_order_relaxed)) {}
+    }
+
+    // Message thread
+    bool isSounding(int note) const noexcept { return notes[note].count.load(std::memory_order_relaxed) > 0; }
+    float getVelocity(int note) const noexcept { return notes[note].velocity.load(std::memory_order_relaxed); }
+    float getPlayhead(int note) const noexcept { return notes[note].playhead.load(std::memory_order_relaxed); }
+    bool isAnySounding() const noexcept { return numSounding.load(std::memory_order_relaxed) > 0; }
+
+    // Highest peak since the last resetPeaks
+    float getPeak(int note) const noexcept { return notes[note].peak.load(std::memory_order_relaxed); }
+
+    void resetPeaks() noexcept
+    {
+        for (auto& state : notes)
+            state.peak.store(0.0f, std::memory_order_relaxed);
+    }
+
+private:
+    struct alignas(64) NoteState
+    {
+        std::atomic<int> count { 0 };             // Voices sounding the note
+        std::atomic<float> velocity { 0.0f };     // Of the latest note-on
+        std::atomic<float> playhead { 0.0f };     // 0 to 1, of the owner's sample
+        std::atomic<float> peak { 0.0f };         // Linear, any voice on the note
+        std::atomic<const void*> owner { nullptr };
+    };
+
+    NoteState notes[numNotes];
+    std::atomic<int> numSounding { 0 };
+};
+
+//==============================================================================
+// Synthesiser whose sounds live in fixed per-note and per-button slots
+// rather than in Synthesiser's own sound array.
+//
+// Whenever a slot changes, the message thread rebuilds a note table listing
+// the sounds that answer each of the 128 notes and swaps it in atomically.
+// Note-on is then a single table lookup: no scan over sounds, no virtual
+// appliesToNote calls, and the audio thread never sees a half-built sound
+// or waits on a lock while a kit loads. A swapped-out sound is handed to the SampleReclaimer, which
+// frees it (and its sample data) on its own thread once the audio thread can
+// no longer be holding its raw pointer and no voice is still playing it.
+//
+// Each note plays in its PlaybackMode, taken from an EngineSnapshot the
+// plugin refreshes at the start of every block. A note-on on a toggle note
+// that is already sounding releases it instead of starting another voice.
+//
+// When the voice pool is exhausted a voice is stolen by priority, and the
+// stolen note fades out briefly rather than clicking. Notes can share a
+// choke group: starting one fades out the others (open/closed hi-hat).
+//
+// Voices with something to play can be rendered in parallel by a
+// VoiceRenderPool; by default they all render on the audio thread.
+class SamplerSynth : public Synthesiser
+{
+public:
+    static constexpr int numNotes = 128;
+    static constexpr int numButtons = PadLayout::numPads;
+    static constexpr int maxVoices = 256;
+
+    SamplerSynth();
+    ~SamplerSynth() override;
+
+    // Message thread: publish a sound (or nullptr) for a MIDI note sample or a button
+    void setNoteSound(int midiNote, ButtonSampleSound* sound);
+    void setButtonSound(int buttonIndex, ButtonSampleSound* sound);
+
+    // Message thread: the sound currently published in a slot, or nullptr
+    ButtonSampleSound* getNoteSound(int midiNote) const noexcept;
+    ButtonSampleSound* getButtonSound(int buttonIndex) const noexcept;
+
+    // Audio thread: bracket each processBlock so retirement knows when the
+    // audio thread has moved past a swap
+    void beginBlock() noexcept { reclaimer.beginBlock(); numVoicesRendered = 0; }
+    void endBlock() noexcept { reclaimer.endBlock(); }
+
+    // Starts a voice for every sound published on this note, after choking
+    // the other notes in its group
+    void noteOn(int midiChannel, int midiNoteNumber, float velocity) override;
+
+    // Any thread; read at note-on
+    void setVoiceStealing(VoiceStealing policy) noexcept { voiceStealing.store(policy); }
+    VoiceStealing getVoiceStealing() const noexcept { return voiceStealing.load(); }
+
+    static String voiceStealingToString(VoiceStealing policy);
+
+    // Any thread: group 0 means the note chokes nothing
+    static constexpr int maxChokeGroups = 16;
+    void setChokeGroup(int midiNote, int group) noexcept;
+    int getChokeGroup(int midiNote) const noexcept;
+
+    // Audio thread, before rendering each block: the settings voices read.
+    // Voices keep a pointer to it.
+    EngineSnapshot& getEngineSnapshot() noexcept { return engineSnapshot; }
+    const EngineSnapshot& getEngineSnapshot() const noexcept { return engineSnapshot; }
+
+    // Not the audio thread: where voices find their buses in the buffer
+    void setBusLayout(const OutputBusLayout& newLayout);
+    const OutputBusLayout& getBusLayout() const noexcept { return busLayout; }
+
+    // Not the audio thread: helper threads for parallel rendering (0 renders
+    // inline), sized for blocks of up to maxBlockSize samples
+    void setRenderThreads(int numThreads, int numChannels, int maxBlockSize);
+    int getNumRenderThreads() const noexcept { return renderPool->getNumWorkers(); }
+
+    SampleReclaimer& getReclaimer() noexcept { return reclaimer; }
+
+    // Voices report into this; the editor reads it
+    VoiceActivity& getVoiceActivity() noexcept { return voiceActivity; }
+
+    // Audio thread: most voices that had something to play in this block
+    int getNumVoicesRendered() const noexcept { return numVoicesRendered; }
+
+protected:
+    SynthesiserVoice* findVoiceToSteal(SynthesiserSound* soundToPlay, int midiChannel,
+                                       int midiNoteNumber) const override;
+    void renderVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples) override;
+
+private:
+    // Immutable once published. Holds raw pointers: every sound in it is
+    // either still in its slot or waiting in the reclaimer.
+    struct NoteTable : public ReferenceCountedObject
+    {
+        // A bank's worth of pads can stack their own samples on one note
+        static constexpr int maxLayers = PadLayout::padsPerBank + 1;
+
+        struct Entry
+        {
+            ButtonSampleSound* layers[maxLayers];
+            int numLayers = 0;
+        };
+
+        Entry notes[numNotes];
+    };
+
+    void rebuildNoteTable();
+    void retire(ButtonSampleSound* sound);
+
+    SampleReclaimer reclaimer;
+    std::atomic<NoteTable*> noteTable { nullptr };
+
+    std::atomic<ButtonSampleSound*> noteSounds[numNotes];
+    std::atomic<ButtonSampleSound*> buttonSounds[numButtons];
+
+    std::atomic<VoiceStealing> voiceStealing { VoiceStealing::sameNoteFirst };
+    std::atomic<int> chokeGroups[numNotes];
+
+    OutputBusLayout busLayout;
+    EngineSnapshot engineSnapshot;
+    VoiceActivity voiceActivity;
+    std::unique_ptr<VoiceRenderPool> renderPool { std::make_unique<VoiceRenderPool>() };  // Swapped under the lock
+    CriticalSection renderPoolChangeLock;  // Serialises setRenderThreads, never taken by the audio thread
+    SynthesiserVoice* renderList[maxVoices];  // Voices with something to play this sub-block
+    int numVoicesRendered = 0;                // Audio thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplerSynth)
+};
@@ -0,0 +1,180 @@
+/*
+  ==============================================================================
+
+    VoiceEnvelope.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Per-voice amplitude envelope, applied as linear gain ramps
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+#include "SampleRenderKernels.h"
+
+//==============================================================================
+// Envelope times in seconds; sustain is a level from 0 to 1. With the
+// defaults a note starts at full level and holds it until released.
+struct EnvelopeSettings
+{
+    float attack = 0.0f;
+    float decay = 0.0f;
+    float sustain = 1.0f;
+    float release = 0.0f;
+
+    bool isDefault() const noexcept { return attack == 0.0f && decay == 0.0f && sustain == 1.0f && release == 0.0f; }
+};
+
+//==============================================================================
+// Linear ADSR for one voice.
+//
+// The voice renders in segments that never cross a stage boundary
+// (getSamplesInStage), so each segment's envelope is a single straight
+// ramp, applied to the whole segment at once with
+// RenderKernels::applyGainRamp rather than stepped sample by sample.
+// Releases are never shorter than minReleaseSeconds, and a sample that is
+// about to run out is faded over that time too, so notes never end on a
+// step.
+class VoiceEnvelope
+{
+public:
+    static constexpr double minReleaseSeconds = 0.002;
+
+    // At note-on
+    void start(const EnvelopeSettings& settings, double sampleRate) noexcept
+    {
+        const double rate = sampleRate > 0 ? sampleRate : 44100.0;
+
+        attackSamples = roundToInt(jmax(0.0f, settings.attack) * rate);
+        decaySamples = roundToInt(jmax(0.0f, settings.decay) * rate);
+        sustainLevel = jlimit(0.0f, 1.0f, settings.sustain);
+        declickSamples = jmax(1, roundToInt(minReleaseSeconds * rate));
+        releaseSamples = jmax(declickSamples, roundToInt(jmax(0.0f, settings.release) * rate));
+
+        level = 0.0f;
+        enterStage(Stage::attack);
+    }
+
+    // At note-off
+    void release() noexcept
+    {
+        if (stage != Stage::finished && stage != Stage::release)
+            fadeOut(releaseSamples);
+    }
+
+    // A sample with numSamples left to play: if that is within the declick
+    // time, fade so it is silent as it ends
+    void fadeOutBefore(int numSamples) noexcept
+    {
+        if (numSamples <= declickSamples && getSamplesUntilSilent() > numSamples)
+            fadeOut(numSamples);
+    }
+
+    bool isFinished() const noexcept { return stage == Stage::finished; }
+    bool isAttacking() const noexcept { return stage == Stage::attack; }
+    float getLevel() const noexcept { return level; }
+
+    // Samples until the envelope changes direction; segments stop there
+    int getSamplesInStage() const noexcept
+    {
+        return stage == Stage::sustain ? std::numeric_limits<int>::max() : stageSamplesLeft;
+    }
+
+    // Scales numSamples of each channel (no more than getSamplesInStage)
+    // and advances the envelope past them
+    void apply(float* const* channels, int numChannels, int numSamples) noexcept
+    {
+        jassert(numSamples <= getSamplesInStage());
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            RenderKernels::applyGainRamp(channels[ch], level, step, numSamples);
+
+        if (stage == Stage::sustain)
+            return;
+
+        level += step * static_cast<float>(numSamples);
+        stageSamplesLeft -= numSamples;
+
+        if (stageSamplesLeft <= 0)
+            enterStage(static_cast<Stage>(static_cast<int>(stage) + 1));
+    }
+
+private:
+    enum class Stage { attack = 0, decay, sustain, release, finished };
+
+    int getSamplesUntilSilent() const noexcept
+    {
+        return stage == Stage::release ? stageSamplesLeft
+             : stage == Stage::finished ? 0 : std::numeric_limits<int>::max();
+    }
+
+    void fadeOut(int numSamples) noexcept
+    {
+        stage = Stage::release;
+        stageSamplesLeft = jmax(1, numSamples);
+        step = -level / static_cast<float>(stageSamplesLeft);
+    }
+
+    void enterStage(Stage newStage) noexcept
+    {
+        stage = newStage;
+        step = 0.0f;
+
+        switch (stage)
+        {
+            case Stage::attack:
+                if (attackSamples > 0)
+                {
+                    stageSamplesLeft = attackSamples;
+                    step = (1.0f - level) / static_cast<float>(attackSamples);
+                    return;
+                }
+                level = 1.0f;
+                enterStage(Stage::decay);
+                return;
+
+            case Stage::decay:
+                level = 1.0f;
+                if (decaySamples > 0 && sustainLevel < 1.0f)
+                {
+                    stageSamplesLeft = decaySamples;
+                    step = (sustainLevel - 1.0f) / static_cast<float>(decaySamples);
+                    return;
+                }
+                enterStage(Stage::sustain);
+                return;
+
+            case Stage::sustain:
+                // Decaying to silence ends the note
+                level = sustainLevel;
+                if (level <= 0.0f)
+                    enterStage(Stage::finished);
+                return;
+
+            case Stage::release:
+                // Only reached through fadeOut
+                jassertfalse;
+                enterStage(Stage::finished);
+                return;
+
+            case Stage::finished:
+                level = 0.0f;
+                stageSamplesLeft = 0;
+                return;
+        }
+    }
+
+    Stage stage = Stage::finished;
+    float level = 0.0f;
+    float step = 0.0f;
+    int stageSamplesLeft = 0;
+
+    int attackSamples = 0;
+    int decaySamples = 0;
+    int releaseSamples = 1;
+    int declickSamples = 1;
+    float sustainLevel = 1.0f;
+};
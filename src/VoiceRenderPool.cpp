@@ -0,0 +1,249 @@
+/*
+  ==============================================================================
+
+    VoiceRenderPool.cpp
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Parallel voice rendering across a small pool of real-time threads
+
+  ==============================================================================
+*/
+
+#include "VoiceRenderPool.h"
+#include "AllocationTrap.h"
+
+#include <thread>
+
+//==============================================================================
+class VoiceRenderPool::Worker : public Thread
+{
+public:
+    Worker(VoiceRenderPool& owner, int participant, float* const* scratchChannels, int numChannels, int maxBlockSize)
+        : Thread("Voice render " + String(participant)),
+          pool(owner),
+          index(participant),
+          scratch(scratchChannels, numChannels, maxBlockSize)
+    {
+    }
+
+    void run() override
+    {
+        uint32 lastGeneration = pool.jobGeneration.load();
+
+        while (!threadShouldExit())
+        {
+            lastGeneration = pool.waitForJob(lastGeneration, *this);
+
+            if (threadShouldExit())
+                break;
+
+            renderJob(lastGeneration);
+        }
+    }
+
+    // The generation whose voices are in scratch, read by the audio thread
+    // once this worker isn't rendering for that generation any more
+    AudioBuffer<float> scratch;
+    std::atomic<uint32> renderedGeneration { 0 };
+
+    // The generation this worker may be rendering a voice for, 0 if none.
+    // Set before each claim, so the audio thread can't miss a voice in
+    // progress, and cleared after it.
+    std::atomic<uint32> busyGeneration { 0 };
+
+private:
+    void renderJob(uint32 generation) noexcept
+    {
+        const AllocationTrap::ScopedRealtimeSection realtime;
+        ScopedNoDenormals noDenormals;
+
+        for (;;)
+        {
+            busyGeneration.store(generation);
+            auto* voice = pool.takeVoice(index, generation);
+
+            if (voice == nullptr)
+                break;
+
+            // Only cleared if this worker gets anything to render
+            if (renderedGeneration.load(std::memory_order_relaxed) != generation)
+            {
+                scratch.clear(0, pool.jobNumSamples);
+                renderedGeneration.store(generation, std::memory_order_relaxed);
+            }
+
+            voice->renderNextBlock(scratch, 0, pool.jobNumSamples);
+            busyGeneration.store(0, std::memory_order_release);
+        }
+
+        busyGeneration.store(0, std::memory_order_release);
+    }
+
+    VoiceRenderPool& pool;
+    const int index;
+};
+
+//==============================================================================
+VoiceRenderPool::~VoiceRenderPool()
+{
+    stopWorkers();
+}
+
+int VoiceRenderPool::limitWorkers(int numWorkers) noexcept
+{
+    return jlimit(0, jmax(0, jmin(maxWorkers, SystemStats::getNumCpus() - 1)), numWorkers);
+}
+
+bool VoiceRenderPool::isConfiguredFor(int numWorkers, int numChannels, int maxBlockSize) const noexcept
+{
+    return limitWorkers(numWorkers) == workers.size() && numChannels == scratchChannels && maxBlockSize <= scratchSize;
+}
+
+void VoiceRenderPool::configure(int numWorkers, int numChannels, int maxBlockSize)
+{
+    if (isConfiguredFor(numWorkers, numChannels, maxBlockSize))
+        return;
+
+    numWorkers = limitWorkers(numWorkers);
+
+    stopWorkers();
+
+    scratchChannels = numChannels;
+    scratchSize = maxBlockSize;
+
+    // Every helper's channels, back to back in one block
+    const size_t channelBytes = RealtimeArena::bytesFor<float>(static_cast<size_t>(maxBlockSize));
+    arena.reserve(static_cast<size_t>(numWorkers * numChannels) * channelBytes);
+
+    Array<float*> channels;
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        channels.clearQuick();
+        for (int ch = 0; ch < numChannels; ++ch)
+            channels.add(arena.allocate<float>(static_cast<size_t>(maxBlockSize)));
+
+        auto* worker = workers.add(new Worker(*this, i + 1, channels.getRawDataPointer(), numChannels, maxBlockSize));
+        worker->startRealtimeThread(Thread::RealtimeOptions{});
+    }
+}
+
+void VoiceRenderPool::stopWorkers()
+{
+    if (workers.isEmpty())
+        return;
+
+    for (auto* worker : workers)
+        worker->signalThreadShouldExit();
+
+    // Wake anything sleeping on the generation
+    exiting.store(true);
+    jobGeneration.fetch_add(1);
+    jobGeneration.notify_all();
+
+    for (auto* worker : workers)
+        worker->stopThread(1000);
+
+    workers.clear();
+    exiting.store(false);
+}
+
+//==============================================================================
+uint32 VoiceRenderPool::waitForJob(uint32 lastGeneration, const Thread& thread) const noexcept
+{
+    // Blocks arrive every few milliseconds, so spinning for a moment first
+    // usually avoids a trip through the scheduler
+    constexpr int spinIterations = 2000;
+
+    for (int spin = 0;; ++spin)
+    {
+        const uint32 generation = jobGeneration.load(std::memory_order_acquire);
+
+        if (generation != lastGeneration || exiting.load() || thread.threadShouldExit())
+            return generation;
+
+        if (spin < spinIterations)
+            continue;
+
+        jobGeneration.wait(generation, std::memory_order_acquire);
+    }
+}
+
+SynthesiserVoice* VoiceRenderPool::takeVoice(int participant, uint32 generation) noexcept
+{
+    const int participants = numParticipants.load(std::memory_order_relaxed);
+
+    // Own range first, then steal from the others
+    for (int k = 0; k < participants; ++k)
+    {
+        auto& range = ranges[(participant + k) % participants];
+        uint64 cursor = range.cursor.load();
+
+        while (generationOf(cursor) == generation && nextOf(cursor) < endOf(cursor))
+            if (range.cursor.compare_exchange_weak(cursor, cursor + 1))
+                return jobVoices[nextOf(cursor)];
+    }
+
+    return nullptr;
+}
+
+// Bounded by the one voice the helper is rendering: every unclaimed voice
+// has already been taken by the audio thread
+void VoiceRenderPool::waitWhileRendering(const Worker& worker, uint32 generation) const noexcept
+{
+    constexpr int spinIterations = 4000;
+
+    for (int spin = 0; worker.busyGeneration.load() == generation; ++spin)
+        if (spin >= spinIterations)
+            std::this_thread::yield();
+}
+
+//==============================================================================
+void VoiceRenderPool::render(SynthesiserVoice* const* voices, int numVoices,
+                             AudioBuffer<float>& output, int startSample, int numSamples) noexcept
+{
+    const int participants = jmin(workers.size() + 1, numVoices / minVoicesPerThread);
+
+    // Not worth waking anyone, or a block larger than prepareToPlay promised
+    if (participants < 2 || numSamples > scratchSize || output.getNumChannels() != scratchChannels)
+    {
+        for (int i = 0; i < numVoices; ++i)
+            voices[i]->renderNextBlock(output, startSample, numSamples);
+        return;
+    }
+
+    jassert(numVoices <= 0xffff);  // Cursors hold 16-bit indices
+
+    // 0 means "not rendering"
+    uint32 generation = jobGeneration.load(std::memory_order_relaxed) + 1;
+    if (generation == 0)
+        ++generation;
+
+    jobVoices = voices;
+    jobNumSamples = numSamples;
+    numParticipants.store(participants, std::memory_order_relaxed);
+
+    // Publishing the cursors releases the job description to whoever claims
+    for (int p = 0; p < participants; ++p)
+        ranges[p].cursor.store(makeCursor(generation, numVoices * p / participants, numVoices * (p + 1) / participants));
+
+    jobGeneration.store(generation, std::memory_order_release);
+    jobGeneration.notify_all();
+
+    // The audio thread renders straight into the output, taking over every
+    // range a helper hasn't got to
+    while (auto* voice = takeVoice(0, generation))
+        voice->renderNextBlock(output, startSample, numSamples);
+
+    for (auto* worker : workers)
+    {
+        waitWhileRendering(*worker, generation);
+
+        if (worker->renderedGeneration.load(std::memory_order_relaxed) != generation)
+            continue;
+
+        for (int ch = 0; ch < scratchChannels; ++ch)
+            output.addFrom(ch, startSample, worker->scratch, ch, 0, numSamples);
+    }
+}
@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    VoiceRenderPool.h
+    Created: 14 Oct 2026
+    Author:  PC
+
+    Parallel voice rendering across a small pool of real-time threads
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "juce.h"
+#include "RealtimeArena.h"
+
+#include <atomic>
+
+//==============================================================================
+// Spreads the voices of one render call over a few helper threads.
+//
+// The audio thread publishes the job by bumping a generation counter and
+// takes part itself, rendering straight into the output. Each participant
+// owns a contiguous range of the voice list and claims voices from it with
+// an atomic cursor tagged with the generation, so a helper that wakes late
+// can never claim from a newer job; once its own range is empty it steals
+// from the others'. Helpers render into their own scratch buffers, carved
+// from the pool's arena, which the audio thread sums at the end.
+//
+// The audio thread drains every range itself before it waits, so it only
+// ever waits for voices a helper is rendering at that moment - never for a
+// helper that joined and was preempted before it found any work. There are
+// no locks: helpers sleep on the generation (C++20 atomic wait) after
+// spinning briefly.
+//
+// With too few voices to be worth splitting the job is rendered inline.
+class VoiceRenderPool
+{
+public:
+    static constexpr int maxWorkers = 7;
+    static constexpr int minVoicesPerThread = 4;
+
+    VoiceRenderPool() = default;
+    ~VoiceRenderPool();
+
+    // Never while render may be running. numWorkers helper threads, 0 to
+    // render everything on the audio thread. Starting and stopping threads
+    // takes a while, so SamplerSynth configures a new pool and swaps it in
+    // rather than reconfiguring the one the audio thread uses.
+    void configure(int numWorkers, int numChannels, int maxBlockSize);
+    int getNumWorkers() const noexcept { return workers.size(); }
+
+    // True if configure with these settings would change nothing
+    bool isConfiguredFor(int numWorkers, int numChannels, int maxBlockSize) const noexcept;
+
+    // Audio thread: adds every voice's output to output, like
+    // Synthesiser::renderVoices
+    void render(SynthesiserVoice* const* voices, int numVoices,
+                AudioBuffer<float>& output, int startSample, int numSamples) noexcept;
+
+private:
+    class Worker;
+
+    uint32 waitForJob(uint32 lastGeneration, const Thread& thread) const noexcept;
+    SynthesiserVoice* takeVoice(int participant, uint32 generation) noexcept;
+    void waitWhileRendering(const Worker& worker, uint32 generation) const noexcept;
+    void stopWorkers();
+
+    // A range's cursor: the generation in the top 32 bits, then the end and
+    // the next voice to claim, 16 bits each. One word, so a claim checks the
+    // job and takes the voice in a single compare-and-swap.
+    static uint64 makeCursor(uint32 generation, int next, int end) noexcept
+    {
+        return (static_cast<uint64>(generation) << 32) | (static_cast<uint64>(end) << 16) | static_cast<uint64>(next);
+    }
+
+    static uint32 generationOf(uint64 cursor) noexcept { return static_cast<uint32>(cursor >> 32); }
+    static int endOf(uint64 cursor) noexcept { return static_cast<int>((cursor >> 16) & 0xffff); }
+    static int nextOf(uint64 cursor) noexcept { return static_cast<int>(cursor & 0xffff); }
+
+    struct alignas(64) Range
+    {
+        std::atomic<uint64> cursor { 0 };
+    };
+
+    static int limitWorkers(int numWorkers) noexcept;
+
+    RealtimeArena arena;  // The helpers' scratch; outlives them
+    OwnedArray<Worker> workers;
+
+    alignas(64) std::atomic<uint32> jobGeneration { 0 };  // Never 0 once a job is published
+    std::atomic<bool> exiting { false };
+
+    // Job description, written before the cursors are published, and only
+    // read by a helper once it has claimed a voice of the job
+    SynthesiserVoice* const* jobVoices = nullptr;
+    int jobNumSamples = 0;
+    std::atomic<int> numParticipants { 0 };
+    Range ranges[maxWorkers + 1];
+
+    int scratchChannels = 0;
+    int scratchSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(VoiceRenderPool)
+};